@@ -1,15 +1,15 @@
 local cjson = require("cjson")
 --print("launcher:", arg[1], arg[2])
-local main = require(arg[1])[arg[2]]
 
 local action_path = os.getenv("__OW_ACTIONS")
 local concurrency = 1
 local manifest_exists = false
+local action_manifest = nil
 if(action_path) then
     local manifest, emsg, ec = io.open(action_path .. "/action-manifest.json")
     if(manifest) then
         manifest_exists = true
-        local action_manifest = cjson.decode(manifest:read("a"))
+        action_manifest = cjson.decode(manifest:read("a"))
         if(action_manifest["__OW_NUM_CONCURRENCY"]) then
             concurrency = action_manifest["__OW_NUM_CONCURRENCY"]
         end
@@ -17,46 +17,228 @@ if(action_path) then
     end
 end
 
+-- When results are shared through memfds, the controller names the memfds holding the results of
+-- the dependencies, and the memfd that the result must be written to, instead of copying them.
+local function load_params(params)
+    if(type(params) ~= "table" or not params["__OW_RESULT"]) then
+        return params, nil
+    end
+    local shared = params["__OW_PARAMS"]
+    for key, path in pairs(params["__OW_MEMFD"]) do
+        local memfd = assert(io.open(path, "r"))
+        shared[key] = cjson.decode(memfd:read("a"))
+        memfd:close()
+    end
+    return shared, params["__OW_RESULT"]
+end
 
--- Notify the controller that we are ready for execution.
-local out = io.open("/proc/self/fd/3", "w")
-out:write("\0")
-out:flush()
+-- Only the length of a shared result is returned to the controller.
+local function store_result(path, result)
+    if(not path) then
+        return result
+    end
+    local memfd = assert(io.open(path, "w"))
+    memfd:write(result)
+    memfd:close()
+    return tostring(#result)
+end
 
--- Begin execution.
-local input = io.stdin:read()
-if(not input) then
-    if(manifest_exists) then
-        return nil
-    else
-        out:write(cjson.encode({["error"]="Action input was empty."}))
+local function launch(main, input_stream, out)
+    -- Notify the controller that we are ready for execution.
+    out:write("\0")
+    out:flush()
+
+    -- Begin execution.
+    local input = input_stream:read()
+    if(not input) then
+        if(manifest_exists) then
+            return nil
+        else
+            out:write(cjson.encode({["error"]="Action input was empty."}))
+            out:flush()
+            os.exit(false)
+        end
+    end
+    --print("launcher:", input)
+    local params, path = load_params(cjson.decode(input))
+
+    local status, res = pcall(main, params)
+    if(status) then
+        ---[[ for debugging
+        local ow_activation_id = os.getenv("__OW_ACTIVATION_ID")
+        if(ow_activation_id and manifest_exists) then
+            res["activation_id"] = ow_activation_id
+        end
+        --]]
+
+        if(res["error"] and concurrency > 1) then
+            os.exit(134)
+        else
+            out:write(store_result(path, cjson.encode(res)))
+        end
         out:flush()
-        os.exit(false)
+    elseif(concurrency == 1) then
+        out:write(store_result(path, cjson.encode({["error"]=res})))
+        out:flush()
+    else
+        os.exit(134)
     end
 end
---print("launcher:", input)
-local params = cjson.decode(input)
 
-local status, res = pcall(main, params)
-if(status) then
-    ---[[ for debugging
-    local ow_activation_id = os.getenv("__OW_ACTIVATION_ID")
-    if(ow_activation_id and manifest_exists) then
-        res["activation_id"] = ow_activation_id
+-- Persistent launchers exchange frames with a 4 byte big endian length prefix.
+local function read_frame(input_stream)
+    local header = input_stream:read(4)
+    if(not header or #header < 4) then
+        return nil
     end
-    --]]
+    return input_stream:read(string.unpack(">I4", header))
+end
 
-    if(res["error"] and concurrency > 1) then
-        os.exit(134)
-    else
-        out:write(cjson.encode(res))
+local function write_frame(out, data)
+    out:write(string.pack(">I4", #data), data)
+    out:flush()
+end
+
+-- Persistent launchers serve many activations, so the environment of the previous activation is replaced.
+local function apply_env(env, applied)
+    local stdlib = require("posix.stdlib")
+    for k in pairs(applied) do
+        if(env[k] == nil) then
+            stdlib.setenv(k, nil)
+        end
+    end
+    for k, v in pairs(env) do
+        stdlib.setenv(k, v)
     end
+    return env
+end
+
+-- Serve invocations until the controller closes the input stream.
+local function serve(main, input_stream, out)
+    out:write("\0")
     out:flush()
-elseif(concurrency == 1) then
-    out:write(cjson.encode({["error"]=res}))
+    local applied = {}
+    for input in read_frame, input_stream do
+        local frame = cjson.decode(input)
+        applied = apply_env(frame["__OW_ENV"], applied)
+        local params, path = load_params(frame["__OW_INPUT"])
+        local status, res = pcall(main, params)
+        if(status) then
+            if(res["error"] and concurrency > 1) then
+                os.exit(134)
+            end
+            write_frame(out, store_result(path, cjson.encode(res)))
+        elseif(concurrency == 1) then
+            write_frame(out, store_result(path, cjson.encode({["error"]=res})))
+        else
+            os.exit(134)
+        end
+    end
+end
+
+-- Streaming relations handle one record per line until their input is closed, and write one result per line.
+-- main is also passed an emit function, that writes a record for every value that it is called with.
+local function stream(main, input_stream, out)
+    out:write("\0")
     out:flush()
+    local function emit(record)
+        out:write(cjson.encode(record), "\n")
+        out:flush()
+    end
+    for input in input_stream:lines() do
+        local status, res = pcall(main, cjson.decode(input), emit)
+        if(status) then
+            if(res ~= nil) then
+                emit(res)
+            end
+        elseif(concurrency == 1) then
+            emit({["error"]=res})
+        else
+            os.exit(134)
+        end
+    end
+end
+
+if(arg[1] ~= "--zygote") then
+    local main = require(arg[1])[arg[2]]
+    if(arg[3] == "--persistent") then
+        serve(main, io.stdin, io.open("/proc/self/fd/3", "w"))
+    elseif(os.getenv("__OW_STREAM")) then
+        stream(main, io.stdin, io.open("/proc/self/fd/3", "w"))
+    else
+        launch(main, io.stdin, io.open("/proc/self/fd/3", "w"))
+    end
+    return
+end
+
+-- Zygote mode: preload every module in the action manifest, and fork a child for each request from the controller.
+local unistd = require("posix.unistd")
+local stdlib = require("posix.stdlib")
+local psignal = require("posix.signal")
+local pstat = require("posix.sys.stat")
+
+-- Children of the zygote move themselves into their executor cgroup before they run any action code.
+-- The controller attaches them again if this fails.
+local function attach(cgroup)
+    local pid = tostring(unistd.getpid())
+    local path = cgroup .. "/" .. pid
+    pstat.mkdir(path, 493)
+    local procs = io.open(path .. "/cgroup.procs", "w")
+    if(procs) then
+        procs:write(pid)
+        procs:close()
+    end
+end
+-- Children of the zygote are reaped automatically.
+psignal.signal(psignal.SIGCHLD, psignal.SIG_IGN)
+
+if(manifest_exists) then
+    for key, relation in pairs(action_manifest) do
+        if(key ~= "__OW_NUM_CONCURRENCY") then
+            require((relation["file"]:gsub("%.[^%.]*$", "")))
+        end
+    end
 else
-    os.exit(134)
+    require("main")
 end
 
+local out = io.open("/proc/self/fd/3", "w")
+out:write("\0")
+out:flush()
 
+for line in io.stdin:lines() do
+    local request = cjson.decode(line)
+    local pid = unistd.fork()
+    if(pid == 0) then
+        -- The child leads its own process group so that the controller can pause and resume it.
+        unistd.setpid("p", 0, 0)
+        -- Actions wait for their own children, so restore the SIGCHLD disposition that the zygote ignores.
+        psignal.signal(psignal.SIGCHLD, psignal.SIG_DFL)
+        unistd.close(0)
+        unistd.close(3)
+        if(request["cgroup"]) then
+            attach(request["cgroup"])
+        end
+        -- The FIFOs are opened before anything that can fail, so the controller sees the child exit as end of file.
+        local input_stream = io.open(request["in"], "r")
+        local child_out = io.open(request["out"], "w")
+        for k, v in pairs(request["env"]) do
+            stdlib.setenv(k, v)
+        end
+        local main = require(request["file"])[request["key"]]
+        if(request["persistent"]) then
+            serve(main, input_stream, child_out)
+        elseif(os.getenv("__OW_STREAM")) then
+            stream(main, input_stream, child_out)
+        else
+            launch(main, input_stream, child_out)
+        end
+        os.exit(true)
+    elseif(pid) then
+        out:write(tostring(pid) .. "\n")
+        out:flush()
+    else
+        out:write("-1\n")
+        out:flush()
+    end
+end
@@ -1,18 +1,148 @@
 import sys
+import os
+import signal
 import importlib
+import inspect
 import json
+import struct
 sys.path.insert(1,"/var/controller/action-runtimes/python3/functions")
 
-if __name__ == "__main__":
-    main = importlib.import_module(sys.argv[1]).main
+def load_params(params):
+    # When results are shared through memfds, the controller names the memfds holding the results of
+    # the dependencies, and the memfd that the result must be written to, instead of copying them.
+    if not (isinstance(params, dict) and "__OW_RESULT" in params):
+        return params, None
+    shared = params["__OW_PARAMS"]
+    for key, path in params["__OW_MEMFD"].items():
+        with open(path, "rb") as memfd:
+            shared[key] = json.load(memfd)
+    return shared, params["__OW_RESULT"]
+
+def store_result(path, result):
+    # Only the length of a shared result is returned to the controller.
+    if path is None:
+        return result
+    with open(path, "wb") as memfd:
+        memfd.write(result)
+    return str(len(result)).encode()
+
+def launch(main, input_stream, out):
     # Notify the Controller that the python runtime is ready for execution.
-    sys.stdout.write("\0")
-    sys.stdout.flush()
+    out.write("\0")
+    out.flush()
 
-    params = json.loads(sys.stdin.readline())
+    params, path = load_params(json.loads(input_stream.readline()))
     result = json.dumps(
         main(params)
     )
 
-    sys.stdout.write(result)
-    sys.stdout.flush()
\ No newline at end of file
+    out.write(store_result(path, result.encode()).decode())
+    out.flush()
+
+def read_frame(input_stream):
+    # Persistent launchers exchange frames with a 4 byte big endian length prefix.
+    header = input_stream.read(4)
+    if len(header) < 4:
+        return None
+    return input_stream.read(struct.unpack(">I", header)[0])
+
+def write_frame(out, data):
+    out.write(struct.pack(">I", len(data)) + data)
+    out.flush()
+
+def apply_env(env, applied):
+    # Persistent launchers serve many activations, so the environment of the previous activation is replaced.
+    for key in applied - env.keys():
+        os.environ.pop(key, None)
+    os.environ.update(env)
+    return set(env)
+
+def serve(main, input_stream, out):
+    # Serve invocations until the controller closes the input stream.
+    out.write(b"\0")
+    out.flush()
+    applied = set()
+    frame = read_frame(input_stream)
+    while frame is not None:
+        frame = json.loads(frame)
+        applied = apply_env(frame["__OW_ENV"], applied)
+        params, path = load_params(frame["__OW_INPUT"])
+        write_frame(out, store_result(path, json.dumps(main(params)).encode()))
+        frame = read_frame(input_stream)
+
+def stream(main, input_stream, out):
+    # Streaming relations handle one record per line until their input is closed, and write one result per line.
+    # A main function that is a generator writes a record for every value that it yields.
+    out.write("\0")
+    out.flush()
+    for line in input_stream:
+        result = main(json.loads(line))
+        for record in (result if inspect.isgenerator(result) else [result]):
+            out.write(json.dumps(record) + "\n")
+            out.flush()
+
+def attach(cgroup):
+    # Children of the zygote move themselves into their executor cgroup before they run any action code.
+    # The controller attaches them again if this fails.
+    path = os.path.join(cgroup, str(os.getpid()))
+    try:
+        os.makedirs(path, exist_ok=True)
+        with open(os.path.join(path, "cgroup.procs"), "w") as procs:
+            procs.write(str(os.getpid()))
+    except OSError:
+        pass
+
+def zygote():
+    # Children of the zygote are reaped automatically.
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+    action_path = os.getenv("__OW_ACTIONS")
+    manifest_path = os.path.join(action_path, "action-manifest.json") if action_path else None
+    if manifest_path and os.path.exists(manifest_path):
+        with open(manifest_path) as manifest:
+            for key, relation in json.load(manifest).items():
+                if key != "__OW_NUM_CONCURRENCY":
+                    importlib.import_module(os.path.splitext(relation["file"])[0])
+    else:
+        importlib.import_module("main")
+
+    out = os.fdopen(3, "w")
+    out.write("\0")
+    out.flush()
+
+    for line in sys.stdin:
+        request = json.loads(line)
+        pid = os.fork()
+        if pid == 0:
+            # The child leads its own process group so that the controller can pause and resume it.
+            os.setpgid(0,0)
+            # Actions wait for their own children, so restore the SIGCHLD disposition that the zygote ignores.
+            signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+            os.close(0)
+            os.close(3)
+            if request.get("cgroup"):
+                attach(request["cgroup"])
+            # The FIFOs are opened before anything that can fail, so the controller sees the child exit as end of file.
+            mode = "b" if request.get("persistent") else ""
+            child_in = open(request["in"], "r" + mode)
+            child_out = open(request["out"], "w" + mode)
+            os.environ.update(request["env"])
+            main = importlib.import_module(request["file"]).main
+            if request.get("persistent"):
+                serve(main, child_in, child_out)
+            elif os.getenv("__OW_STREAM"):
+                stream(main, child_in, child_out)
+            else:
+                launch(main, child_in, child_out)
+            os._exit(0)
+        out.write(str(pid) + "\n")
+        out.flush()
+
+if __name__ == "__main__":
+    if sys.argv[1] == "--zygote":
+        zygote()
+    elif len(sys.argv) > 3 and sys.argv[3] == "--persistent":
+        serve(importlib.import_module(sys.argv[1]).main, sys.stdin.buffer, os.fdopen(3, "wb"))
+    elif os.getenv("__OW_STREAM"):
+        stream(importlib.import_module(sys.argv[1]).main, sys.stdin, sys.stdout)
+    else:
+        launch(importlib.import_module(sys.argv[1]).main, sys.stdin, sys.stdout)
@@ -7,41 +7,118 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <cstring>
+#include <streambuf>
+#include <array>
 
 namespace http
 {
-    HttpBigNum::HttpBigNum(HttpBigNum::Hex, const std::string& hex_str) {
-        const std::size_t max_str_width = 2*sizeof(std::size_t);
-        std::vector<std::string> hex_str_partitions((hex_str.size()/max_str_width) + 1);
-        std::size_t offset = 0;
-        for(offset = 0; offset < hex_str_partitions.size()-1; ++offset){
-            // hex string partitions in here will be of full width.
-            hex_str_partitions[offset].reserve(max_str_width);
-            hex_str_partitions[offset].insert(hex_str_partitions[offset].end(), hex_str.end()-(offset+1)*max_str_width, hex_str.end()-(offset)*max_str_width);
+    namespace {
+        /* Arbitrary precision helpers, on words that are stored most significant word first. */
+        static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "HttpBigNum words must be 64 bits wide.");
+        typedef std::vector<std::size_t> Words;
+
+        Words words_of(const HttpBigNum& num){
+            return (num.overflowed()) ? num.words() : Words{num.value()};
         }
-        // Here the size is less than the full width and so the sizing must be dynamic.
-        std::ptrdiff_t len = (hex_str.end() - (offset)*max_str_width) - hex_str.begin();
-        hex_str_partitions[offset].reserve(len);
-        hex_str_partitions[offset].insert(hex_str_partitions[offset].end(), hex_str.begin(), hex_str.end()-(offset)*max_str_width);
 
-        for(auto it=hex_str_partitions.rbegin(); it != hex_str_partitions.rend(); ++it){
+        void add(Words& lhs, const Words& rhs){
+            if(lhs.size() < rhs.size()){
+                lhs.insert(lhs.begin(), rhs.size() - lhs.size(), 0);
+            }
+            std::size_t carry = 0;
+            auto it0 = lhs.rbegin();
+            for(auto it1 = rhs.rbegin(); it1 != rhs.rend(); ++it0, ++it1){
+                std::size_t sum = *it0 + *it1;
+                std::size_t next = (sum < *it1);
+                sum += carry;
+                next |= (sum < carry);
+                *it0 = sum;
+                carry = next;
+            }
+            for(; carry > 0 && it0 != lhs.rend(); ++it0){
+                carry = (++(*it0) == 0);
+            }
+            if(carry > 0){
+                lhs.insert(lhs.begin(), carry);
+            }
+            return;
+        }
+
+        // The lhs must be larger than the rhs.
+        void subtract(Words& lhs, const Words& rhs){
+            std::size_t borrow = 0;
+            auto it0 = lhs.rbegin();
+            for(auto it1 = rhs.rbegin(); it1 != rhs.rend(); ++it0, ++it1){
+                std::size_t diff = *it0 - *it1;
+                std::size_t next = (*it0 < *it1);
+                next |= (diff < borrow);
+                *it0 = diff - borrow;
+                borrow = next;
+            }
+            for(; borrow > 0 && it0 != lhs.rend(); ++it0){
+                borrow = ((*it0)-- == 0);
+            }
+            return;
+        }
+    }
+
+    HttpBigNum::HttpBigNum(std::initializer_list<std::size_t> init): value_{0} {
+        if(init.size() == 1){
+            value_ = *init.begin();
+        } else if(init.size() > 1){
+            words_.assign(init);
+            normalize();
+        }
+    }
+
+    HttpBigNum::HttpBigNum(const std::vector<std::size_t>& init): value_{0} {
+        if(init.size() == 1){
+            value_ = init.front();
+        } else if(init.size() > 1){
+            words_ = init;
+            normalize();
+        }
+    }
+
+    HttpBigNum::HttpBigNum(HttpBigNum::Hex, std::string_view hex_str): value_{0} {
+        std::from_chars_result res = std::from_chars(hex_str.data(), hex_str.data()+hex_str.size(), value_, 16);
+        if(res.ec == std::errc{}){
+            return;
+        } else if(res.ec != std::errc::result_out_of_range){
+            std::cerr << "http-requests.cpp:89:std::from_chars failed:" << std::make_error_code(std::errc(res.ec)).message() << ":value:" << hex_str << std::endl;
+            throw std::domain_error("http-requests.cpp:90:std::from_chars failed.");
+        }
+        // Numbers longer than 64 bits are converted one word at a time, starting from the most significant word.
+        const std::size_t max_str_width = 2*sizeof(std::size_t);
+        std::size_t len = hex_str.size() % max_str_width;
+        if(len == 0){
+            len = max_str_width;
+        }
+        for(std::size_t offset = 0; offset < hex_str.size(); offset += len, len = max_str_width){
             std::size_t num;
-            std::from_chars_result res = std::from_chars(it->data(), it->data()+it->size(), num, 16);
+            res = std::from_chars(hex_str.data()+offset, hex_str.data()+offset+len, num, 16);
             if(res.ec != std::errc{}){
-                std::cerr << "http-requests.cpp:31:std::from_chars failed:" << std::make_error_code(std::errc(res.ec)).message() << ":value:" << *it << std::endl;
-                throw std::domain_error("http-requests.cpp:32:std::from_chars failed.");
+                std::cerr << "http-requests.cpp:102:std::from_chars failed:" << std::make_error_code(std::errc(res.ec)).message() << ":value:" << hex_str << std::endl;
+                throw std::domain_error("http-requests.cpp:103:std::from_chars failed.");
             }
-            push_back(num);
+            words_.push_back(num);
         }
+        normalize();
     }
 
-    HttpBigNum::HttpBigNum(HttpBigNum::Dec, const std::string& dec_str): std::vector<std::size_t>{0}{
-        std::from_chars_result res;
+    HttpBigNum::HttpBigNum(HttpBigNum::Dec, std::string_view dec_str): value_{0} {
+        std::from_chars_result res = std::from_chars(dec_str.data(), dec_str.data()+dec_str.size(), value_, 10);
+        if(res.ec == std::errc{}){
+            return;
+        }
+        // Numbers longer than 64 bits are multiplied out one digit at a time.
+        value_ = 0;
         std::size_t val;
         for(std::size_t i = 0; i < dec_str.size(); ++i){
             res = std::from_chars(&(dec_str[i]),&(dec_str[i])+1, val, 10);
             if(res.ec != std::errc{}){
-                std::cerr << "http-requests.cpp:43:std::from_chars failed:" << std::make_error_code(std::errc(res.ec)).message() << std::endl;
+                std::cerr << "http-requests.cpp:121:std::from_chars failed:" << std::make_error_code(std::errc(res.ec)).message() << std::endl;
                 throw "Char conversion failed.";
             }
             HttpBigNum tmp = *this;
@@ -53,125 +130,41 @@ namespace http
         }
     }
 
-    bool HttpBigNum::operator==(const HttpBigNum& rhs){
-        if(size() != rhs.size()){
-            return false;
-        } else {
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] != rhs[i]){
-                    return false;
-                }
-            }
-            return true;
-        }
+    std::uint64_t HttpBigNum::value() const {
+        return (overflowed()) ? std::numeric_limits<std::uint64_t>::max() : value_;
     }
 
-    bool HttpBigNum::operator!=(const HttpBigNum& rhs){
-        if(size() != rhs.size()){
-            return true;
-        } else {
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] != rhs[i]){
-                    return true;
-                }
-            }
-            return false;
+    int HttpBigNum::compare(const HttpBigNum& rhs) const {
+        if(!overflowed() && !rhs.overflowed()){
+            return (value_ < rhs.value_) ? -1 : (value_ > rhs.value_);
+        } else if(!rhs.overflowed()){
+            return 1;
+        } else if(!overflowed()){
+            return -1;
+        } else if(words_.size() != rhs.words_.size()){
+            return (words_.size() < rhs.words_.size()) ? -1 : 1;
         }
-    }
-
-
-    bool HttpBigNum::operator<(const HttpBigNum& rhs){
-        if(rhs.size() > size()){
-            return true;
-        } else if (rhs.size() < size()){
-            return false;
-        } else {
-            // return lexicographic sort iff the vectors are the same
-            // length.
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] > rhs[i]){
-                    return false;
-                } else if ((*this)[i] < rhs[i]){
-                    return true;
-                } // Otherwise the numbers are equal.
+        for(std::size_t i=0; i < words_.size(); ++i){
+            if(words_[i] != rhs.words_[i]){
+                return (words_[i] < rhs.words_[i]) ? -1 : 1;
             }
-            // If everything is equal return false.
-            return false;
         }
+        return 0;
     }
 
-    bool HttpBigNum::operator<=(const HttpBigNum& rhs){
-        if(rhs.size() > size()){
-            return true;
-        } else if (rhs.size() < size()){
-            return false;
-        } else {
-            // return lexicographic sort iff the vectors are the same
-            // length.
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] > rhs[i]){
-                    return false;
-                } else if ((*this)[i] < rhs[i]){
-                    return true;
-                } // otherwise the numbers are equal.
-            }
-            // If everything is equal return true.
-            return true;
-        }
-    }
-
-    bool HttpBigNum::operator>(const HttpBigNum& rhs){
-        if(rhs.size() > size()){
-            return false;
-        } else if (rhs.size() < size()){
-            return true;
-        } else {
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] < rhs[i]){
-                    return false;
-                } else if ((*this)[i] > rhs[i]){
-                    return true;
-                }
-            }
-            return false;
-        }
-    }
-
-    bool HttpBigNum::operator>=(const HttpBigNum& rhs){
-        if(rhs.size() > size()){
-            return false;
-        } else if (rhs.size() < size()){
-            return true;
-        } else {
-            for(std::size_t i=0; i < size(); ++i){
-                if((*this)[i] < rhs[i]){
-                    return false;
-                } else if ((*this)[i] > rhs[i]){
-                    return true;
-                }
-            }
-            return true;
+    void HttpBigNum::normalize(){
+        // Find and remove the leading zeros.
+        auto end = std::find_if(words_.begin(), words_.end(), [](std::size_t word){ return word != 0; });
+        words_.erase(words_.begin(), end);
+        if(words_.size() <= 1){
+            value_ = (words_.empty()) ? 0 : words_.front();
+            words_.clear();
         }
+        return;
     }
 
     HttpBigNum& HttpBigNum::operator++(){
-        // start from the least significant bit, add 1 and handle the carry.
-        std::size_t carry = 1;
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        auto it = rbegin();
-        do{
-            if(*it == max){
-                *it = 0;
-            } else {
-                ++(*it);
-                carry = 0;
-            }
-            ++it;
-        } while(it != rend() && carry > 0);
-        if(it == rend() && carry >0){
-            insert(begin(),1);
-        }
-        return *this;
+        return (*this += 1);
     }
 
     HttpBigNum HttpBigNum::operator++(int){
@@ -181,22 +174,13 @@ namespace http
     }
 
     HttpBigNum& HttpBigNum::operator--(){
-        std::size_t carry = 1;
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        auto it = rbegin();
-        do{
-            if(carry == 1 && (*it ==0)){
-                *it = max;
-            } else {
-                *it -= carry;
-                carry = 0;
-            }
-            ++it;
-        } while (it != rend() && carry == 1);
-        if(it == rend() && front() == 0){
-            // remove leading zero.
-            erase(begin());
+        if(!overflowed()){
+            // Decrementing 0 wraps around, as it always has.
+            --value_;
+            return *this;
         }
+        subtract(words_, Words{1});
+        normalize();
         return *this;
     }
 
@@ -207,74 +191,28 @@ namespace http
     }
 
     HttpBigNum& HttpBigNum::operator+=(const HttpBigNum& rhs){
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        std::size_t carry = 0;
-        std::size_t offset = 0;
-        for(offset = 0; offset < rhs.size(); ++offset){
-            std::size_t tmp = 0;
-            auto it1 = rhs.cend() - offset -1;
-            // Check that *it1 doesn't overflow
-            if(carry > 0 && carry > max - *it1){
-                tmp = *it1 - (max - carry + 1);
-                carry = 1;
-            } else {
-                tmp = *it1 + carry;
-                carry = 0;
-            }
-            // Select the number in the correct position.
-            auto it0 = end() - offset -1;
-
-            if(offset >= size()){
-                // Handle the case where rhs is much longer than the lhs.
-                insert(begin(),tmp);
-            } else if(tmp > 0 && tmp > max - *it0){
-                *it0 = *it0 - (max - tmp + 1);
-                carry = 1;
-            } else {
-                *it0 += tmp;
-            }
-        }
-        if(carry > 0){
-            insert(begin(),carry);
+        if(!rhs.overflowed()){
+            return (*this += rhs.value_);
         }
+        Words words = words_of(*this);
+        add(words, rhs.words_);
+        words_ = std::move(words);
+        normalize();
         return *this;
     }
 
-    HttpBigNum& HttpBigNum::operator+=(const std::size_t& rhs){
-        HttpBigNum other{rhs};
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        std::size_t carry = 0;
-        std::size_t offset = 0;
-        for(offset = 0; offset < other.size(); ++offset){
-            std::size_t tmp = 0;
-            // the iterators need to be declared inside the loop
-            // since we need to be able to handle the scenario
-            // where the lhs and the rhs do not have the same lengths.
-            auto it1 = other.cend() - offset -1;
-            // Check that *it1 doesn't overflow
-            if(carry > 0 && carry > max - *it1){
-                tmp = *it1 - (max - carry + 1);
-                carry = 1;
+    HttpBigNum& HttpBigNum::operator+=(std::uint64_t rhs){
+        if(!overflowed()){
+            std::uint64_t sum = value_ + rhs;
+            if(sum < rhs){
+                // The sum carries into a second word.
+                words_ = {1, sum};
             } else {
-                tmp = *it1 + carry;
-                carry = 0;
+                value_ = sum;
             }
-            // Select the number in the correct position.
-            auto it0 = end() - offset -1;
-
-            if(offset >= size()){
-                // Handle the case where rhs is much longer than the lhs.
-                insert(begin(),tmp);
-            } else if(tmp > 0 && tmp > max - *it0){
-                *it0 = *it0 - (max - tmp + 1);
-                carry = 1;
-            } else {
-                *it0 += tmp;
-            }
-        }
-        if(carry > 0){
-            insert(begin(),carry);
+            return *this;
         }
+        add(words_, Words{rhs});
         return *this;
     }
 
@@ -283,7 +221,7 @@ namespace http
         return lhs;
     }
 
-    HttpBigNum operator+(HttpBigNum lhs, const std::size_t& rhs){
+    HttpBigNum operator+(HttpBigNum lhs, std::uint64_t rhs){
         lhs += rhs;
         return lhs;
     }
@@ -295,106 +233,27 @@ namespace http
             // to be equal to 0.
             *this = {0};
             return *this;
+        } else if(!rhs.overflowed()){
+            return (*this -= rhs.value_);
         }
-        std::size_t carry = 0;
-        std::size_t offset = 0;
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        for(offset = 0; offset < rhs.size(); ++offset){
-            // the iterators need to be declared inside the loop
-            // since we need to be able to handle the scenario
-            // where the lhs and the rhs do not have the same lengths.
-            auto it1 = rhs.cend() - offset -1;
-            auto it0 = end() - offset -1;
-            if(carry == 0){
-                if(*it1 > *it0){
-                    *it0 = max - (*it1 - *it0);
-                    carry = 1;
-                } else {
-                    *it0 = (*it0 - *it1);
-                }
-            } else {
-                if(*it1 >= *it0){
-                    *it0 = max - (*it1 - *it0);
-                } else {
-                    *it0 = (*it0 - *it1 - carry);
-                    carry = 0;
-                }
-            }
-        }
-        // subtract the last carry.
-        while(carry > 0 && offset < size()){
-            auto it0 = end() - offset - 1;
-            if(*it0 == 0){
-                *it0 = max;
-            } else {
-                *it0 -= carry;
-                carry = 0;
-            }
-            ++offset;
-        }
-
-        // Find and remove the leading zeros.
-        auto end = begin();
-        auto start = end;
-        while(*end == 0){
-            ++end;
-        }
-        erase(start,end);
+        subtract(words_, rhs.words_);
+        normalize();
         return *this;        
     }
 
-    HttpBigNum& HttpBigNum::operator-=(const std::size_t& rhs){
-        HttpBigNum tmp{rhs};
-        if(*this <= tmp){
+    HttpBigNum& HttpBigNum::operator-=(std::uint64_t rhs){
+        if(*this <= rhs){
             // For the HTTP use case:
-            // if subtraction overflows we set the number
+            // if subtraction underflows we set the number
             // to be equal to 0.
             *this = {0};
             return *this;
+        } else if(!overflowed()){
+            value_ -= rhs;
+            return *this;
         }
-        std::size_t carry = 0;
-        std::size_t offset = 0;
-        const std::size_t max = std::numeric_limits<std::size_t>::max();
-        for(offset = 0; offset < tmp.size(); ++offset){
-            // the iterators need to be declared inside the loop
-            // since we need to be able to handle the scenario
-            // where the lhs and the tmp do not have the same lengths.
-            auto it1 = tmp.cend() - offset -1;
-            auto it0 = end() - offset -1;
-            if(carry == 0){
-                if(*it1 > *it0){
-                    *it0 = max - (*it1 - *it0);
-                    carry = 1;
-                } else {
-                    *it0 = (*it0 - *it1);
-                }
-            } else {
-                if(*it1 >= *it0){
-                    *it0 = max - (*it1 - *it0);
-                } else {
-                    *it0 = (*it0 - *it1 - carry);
-                    carry = 0;
-                }
-            }
-        }
-        // subtract the last carry.
-        while(carry > 0 && offset < size()){
-            auto it0 = end() - offset - 1;
-            if(*it0 == 0){
-                *it0 = max;
-            } else {
-                *it0 -= carry;
-                carry = 0;
-            }
-            ++offset;
-        }
-        // Find the leading 0s.
-        auto end = begin();
-        auto start = end;
-        while(*end == 0){
-            ++end;
-        }
-        erase(start,end);
+        subtract(words_, Words{rhs});
+        normalize();
         return *this; 
     }
 
@@ -403,53 +262,229 @@ namespace http
         return lhs;
     }
 
-    HttpBigNum operator-(HttpBigNum lhs, const std::size_t& rhs){
+    HttpBigNum operator-(HttpBigNum lhs, std::uint64_t rhs){
         lhs -= rhs;
         return lhs;
     }
 
     std::ostream& operator<<(std::ostream& os, const HttpBigNum& rhs){
-        auto it = rhs.begin();
+        if(!rhs.overflowed()){
+            os << std::hex << rhs.value();
+            return os;
+        }
+        auto it = rhs.words().begin();
         os << std::hex << *it;
         ++it;
-        while(it != rhs.end()){
+        while(it != rhs.words().end()){
             os << std::setfill('0') << std::setw(2*sizeof(std::size_t)) << std::hex << *it;
             ++it;
         }
         return os;
     }
 
-    std::istream& operator>>(std::istream& is, HttpChunk& chunk){
-        // Get the stream locale for parsing.
-        // std::locale loc = is.getloc();
-        std::streamsize bytes_available = is.rdbuf()->in_avail();
-        char c;
-        // While there are bytes available in the input stream, keep parsing.
-        while(bytes_available > 0 && !chunk.chunk_complete){
-            c = is.rdbuf()->sbumpc();
-            --bytes_available;
+    namespace {
+        /* Parsing helpers. */
+        // std::streambuf only exposes its get area to derived classes. The pointers to members are named through a
+        // derived class, which makes it possible to parse the get area of any stream buffer in place.
+        struct GetArea: public std::streambuf
+        {
+            // Returns the unread bytes that are already in the get area, without copying them.
+            static std::string_view view(std::streambuf* sb){
+                // std::stringbuf only moves the end of the get area up to the put pointer in showmanyc().
+                (sb->*&GetArea::showmanyc)();
+                char* begin = (sb->*&GetArea::gptr)();
+                char* end = (sb->*&GetArea::egptr)();
+                if(begin == end && sb->in_avail() > 0){
+                    // The stream buffer has bytes available that haven't been moved into the get area yet.
+                    sb->sgetc();
+                    begin = (sb->*&GetArea::gptr)();
+                    end = (sb->*&GetArea::egptr)();
+                }
+                std::size_t len = std::min<std::size_t>(end - begin, std::numeric_limits<int>::max());
+                return std::string_view(begin, len);
+            }
+            static void consume(std::streambuf* sb, std::size_t n){ (sb->*&GetArea::gbump)(static_cast<int>(n)); }
+        };
+
+        // Runs a parser over the unread bytes of an input stream, until the parser stops consuming them.
+        template<typename T>
+        std::istream& extract(std::istream& is, T& msg){
+            std::streambuf* sb = is.rdbuf();
+            while(sb->in_avail() > 0){
+                std::string_view buf = GetArea::view(sb);
+                if(buf.empty()){
+                    break;
+                }
+                std::size_t consumed = parse(buf, msg);
+                GetArea::consume(sb, consumed);
+                if(consumed < buf.size()){
+                    break;
+                }
+            }
+            return is;
+        }
+
+        // Matches the std::isspace characters of the C locale.
+        inline bool is_space(char c){
+            return (c == ' ' || (c >= '\t' && c <= '\r'));
+        }
+
+        inline std::size_t find_space(std::string_view buf, std::size_t pos){
+            while(pos < buf.size() && !is_space(buf[pos])){
+                ++pos;
+            }
+            return pos;
+        }
+
+        // Returns the position one past the next newline, or npos. memchr is vectorized by the C library.
+        inline std::size_t find_line_end(std::string_view buf, std::size_t pos){
+            const void* nl = std::memchr(buf.data() + pos, '\n', buf.size() - pos);
+            return (nl == nullptr) ? std::string_view::npos : (static_cast<const char*>(nl) - buf.data()) + 1;
+        }
+
+        // Returns the token when it is complete in the buffer, otherwise it accumulates in tmp.
+        inline std::string_view token(std::string_view slice, std::string& tmp){
+            if(tmp.empty()){
+                return slice;
+            }
+            tmp.append(slice);
+            return tmp;
+        }
+
+        inline bool iequals(std::string_view lhs, std::string_view rhs){
+            return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](unsigned char a, unsigned char b){
+                return std::toupper(a) == b;
+            });
+        }
+
+        HttpHeaderField header_field(std::string_view name){
+            if(iequals(name, "CONTENT-TYPE")){
+                return HttpHeaderField::CONTENT_TYPE;
+            } else if (iequals(name, "CONTENT-LENGTH")){
+                return HttpHeaderField::CONTENT_LENGTH;
+            } else if (iequals(name, "ACCEPT")){
+                return HttpHeaderField::ACCEPT;
+            } else if (iequals(name, "HOST")){
+                return HttpHeaderField::HOST;
+            } else if (iequals(name, "TRANSFER-ENCODING")){
+                return HttpHeaderField::TRANSFER_ENCODING;
+            } else if (iequals(name, "CONNECTION")){
+                return HttpHeaderField::CONNECTION;
+            }
+            return HttpHeaderField::UNKNOWN;
+        }
+
+        HttpVerb http_verb(std::string_view verb){
+            if(verb == "GET"){
+                return HttpVerb::GET;
+            } else if (verb == "POST"){
+                return HttpVerb::POST;
+            } else if (verb == "PATCH"){
+                return HttpVerb::PATCH;
+            } else if (verb == "PUT"){
+                return HttpVerb::PUT;
+            } else if (verb == "TRACE"){
+                return HttpVerb::TRACE;
+            } else if (verb == "DELETE"){
+                return HttpVerb::DELETE;
+            } else if (verb == "CONNECT"){
+                return HttpVerb::CONNECT;
+            }
+            return HttpVerb::UNKNOWN;
+        }
+
+        HttpVersion http_version(std::string_view version){
+            if(version == "1.1"){
+                return HttpVersion::V1_1;
+            } else if (version == "1.0"){
+                return HttpVersion::V1;
+            } else if (version == "2"){
+                return HttpVersion::V2;
+            } else if (version == "3"){
+                return HttpVersion::V3;
+            } else if (version == "0.9"){
+                return HttpVersion::V0_9;
+            }
+            return HttpVersion::UNKNOWN;
+        }
+
+        HttpStatus http_status(std::string_view status){
+            if(status == "200"){
+                return HttpStatus::OK;
+            } else if (status == "204"){
+                return HttpStatus::NO_CONTENT;
+            } else if (status == "404"){
+                return HttpStatus::NOT_FOUND;
+            } else if (status == "409"){
+                return HttpStatus::CONFLICT;
+            } else if (status == "405"){
+                return HttpStatus::METHOD_NOT_ALLOWED;
+            } else if (status == "500"){
+                return HttpStatus::INTERNAL_SERVER_ERROR;
+            } else if (status == "201"){
+                return HttpStatus::CREATED;
+            } else if (status == "202"){
+                return HttpStatus::ACCEPTED;
+            }
+            return HttpStatus::INTERNAL_SERVER_ERROR;
+        }
+
+        // Seeks through the stream for the string 'HTTP/', one character at a time.
+        void find_version(std::size_t& state, char c){
+            static constexpr std::string_view prefix("HTTP/");
+            if(c == prefix[state]){
+                ++state;
+            } else {
+                state = 0;
+            }
+        }
+
+        // The number of bytes that the chunk body still expects, saturated at 64 bits.
+        std::uint64_t remaining_bytes(const HttpChunk& chunk){
+            if(chunk.chunk_size.overflowed()){
+                return std::numeric_limits<std::uint64_t>::max();
+            }
+            return chunk.chunk_size.value() - chunk.received_bytes.value();
+        }
+    }// End of Parsing helpers.
+
+    std::size_t parse(std::string_view buf, HttpChunk& chunk){
+        std::size_t pos = 0;
+        while(pos < buf.size() && !chunk.chunk_complete){
             if(!chunk.chunk_size_started){
                 // Skip all of the leading whitespace.
-                if(!std::isspace(c)){
+                while(pos < buf.size() && is_space(buf[pos])){
+                    ++pos;
+                }
+                if(pos < buf.size()){
                     chunk.chunk_size_started = true;
-                    chunk.chunk_header.push_back(c);
                 }
             } else if(!chunk.chunk_size_found){
-                if(!std::isspace(c)){
-                    chunk.chunk_header.push_back(c);
+                std::size_t end = find_space(buf, pos);
+                if(end == buf.size()){
+                    chunk.chunk_header.append(buf.substr(pos));
+                    pos = end;
                 } else {
+                    chunk.chunk_size = HttpBigNum(HttpBigNum::hex, token(buf.substr(pos, end - pos), chunk.chunk_header));
                     chunk.chunk_size_found = true;
-                    chunk.chunk_size = HttpBigNum(HttpBigNum::hex, chunk.chunk_header);
+                    pos = end + 1;
                 }
             } else if(!chunk.chunk_body_start){
                 // Skip all of the characters until the next newline characters.
-                if(c == '\n'){
+                std::size_t end = find_line_end(buf, pos);
+                if(end == std::string_view::npos){
+                    pos = buf.size();
+                } else {
                     chunk.chunk_body_start = true;
-                    chunk.received_bytes = {0};
+                    chunk.received_bytes = HttpBigNum();
+                    pos = end;
                 }
             } else if(!chunk.chunk_body_finished && chunk.received_bytes < chunk.chunk_size){
-                chunk.chunk_data.push_back(c);
-                ++(chunk.received_bytes);
+                // The body is copied out of the buffer in one piece.
+                std::size_t len = std::min<std::uint64_t>(remaining_bytes(chunk), buf.size() - pos);
+                chunk.chunk_data.append(buf.data() + pos, len);
+                chunk.received_bytes += len;
+                pos += len;
             } else {
                 // For chunked transfer, there will be another \r\n after the
                 // chunk data to delimit the beginning of the next chunk.
@@ -458,15 +493,20 @@ namespace http
                 // Not marking the chunk complete will prevent the parser from
                 // constructing and back emplacing a new chunk, and beginning
                 // the search for a new chunk header line.
-                if(c == '\n'){
+                std::size_t end = find_line_end(buf, pos);
+                if(end == std::string_view::npos){
+                    pos = buf.size();
+                } else {
                     chunk.chunk_complete = true;
+                    pos = end;
                 }
             }
-            if(bytes_available == 0){
-                bytes_available = is.rdbuf()->in_avail();
-            }
         }
-        return is;
+        return pos;
+    }
+
+    std::istream& operator>>(std::istream& is, HttpChunk& chunk){
+        return extract(is, chunk);
     }
 
     std::ostream& operator<<(std::ostream& os, const HttpChunk& chunk){
@@ -475,18 +515,13 @@ namespace http
         return os;
     }
 
-    std::istream& operator>>(std::istream& is, HttpHeader& header){
-        // Get the stream locale for parsing.
-        char cur;
-        // std::locale loc = is.getloc();
-        std::streamsize bytes_available = is.rdbuf()->in_avail();
-        // While there are bytes available in the input stream, keep parsing.
-        while(bytes_available > 0 && !header.header_complete){
-            cur = is.rdbuf()->sbumpc();
-            --bytes_available;
+    std::size_t parse(std::string_view buf, HttpHeader& header){
+        std::size_t pos = 0;
+        while(pos < buf.size() && !header.header_complete){
             if(!header.field_name_found){
                 //Seek until either a non-white space character, or a new line.
                 if(!header.not_last){
+                    char cur = buf[pos];
                     if(cur == '\n'){
                         // A new line was found without finding any
                         // non-whitespace characters. Therefore this is the last header.
@@ -494,94 +529,92 @@ namespace http
                         header.field_name_found = true;
                         header.field_name = HttpHeaderField::END_OF_HEADERS;
                         header.header_complete = true;
+                        ++pos;
                         break;
-                    } else if(!std::isspace(cur)){
+                    } else if(!is_space(cur)){
                         // a non-whitespace character was found;
                         // therefore; this is not the last header.
                         header.not_last = true;
-                        // start pushing characters onto the buffer.
-                        header.buf.push_back(cur);
+                    } else {
+                        ++pos;
                     }
                 } else {
                     // A non-whitespace character was found.
                     // This is a valid header, but we still haven't found
-                    // the header field name.
-
-                    // Push all of the subsequent non white-space and non-delimter ':'
-                    // characters onto the buffer.
-                    if(!(std::isspace(cur) || cur == ':')){
-                        header.buf.push_back(cur);
+                    // the header field name, which runs until the first white space or delimiter ':'.
+                    std::size_t end = pos;
+                    while(end < buf.size() && !(is_space(buf[end]) || buf[end] == ':')){
+                        ++end;
+                    }
+                    if(end == buf.size()){
+                        header.buf.append(buf.substr(pos));
+                        pos = end;
                     } else {
-                        // White space or the delimiter ':' has been found.
-
                         // If the delimiter ':' has been found, then mark it.
-                        if(cur == ':'){
-                            header.field_delimiter_found = true;
-                        }
                         // Else we have found white space between the delimiter
                         // and the header field name. This is technically
                         // not allowed by the new RFC, RFC 9112, as 
                         // incorrect handling of this white space has lead to security faults
                         // in the past.
-                        
-                        header.field_name_found = true;
-
-                        // Normalize the header field name to upper case values.
-                        // This way the header fields become case insensitive.
-                        std::transform(header.buf.cbegin(), header.buf.cend(), header.buf.begin(), [](unsigned char c){ return std::toupper(c); });
-                        // Set the header field name.
-                        if(header.buf == "CONTENT-TYPE"){
-                            header.field_name = HttpHeaderField::CONTENT_TYPE;
-                        } else if (header.buf == "CONTENT-LENGTH"){
-                            header.field_name = HttpHeaderField::CONTENT_LENGTH;
-                        } else if (header.buf == "ACCEPT"){
-                            header.field_name = HttpHeaderField::ACCEPT;
-                        } else if (header.buf == "HOST"){
-                            header.field_name = HttpHeaderField::HOST;
-                        } else if (header.buf == "TRANSFER-ENCODING"){
-                            header.field_name = HttpHeaderField::TRANSFER_ENCODING;
-                        } else if (header.buf == "CONNECTION") {
-                            header.field_name = HttpHeaderField::CONNECTION;
-                        } else {
-                            header.field_name = HttpHeaderField::UNKNOWN;
+                        if(buf[end] == ':'){
+                            header.field_delimiter_found = true;
                         }
+                        header.field_name_found = true;
+                        // Header field names are case insensitive.
+                        header.field_name = header_field(token(buf.substr(pos, end - pos), header.buf));
+                        pos = end + 1;
                     }
                 }
             } else {
                 // header field name has been found.
                 // First, if the header field delimiter ':' has not been found yet, we need to seek for it.
+                char cur = buf[pos];
                 if (!header.field_delimiter_found && cur == ':'){
                     // We have found the delimiter.
                     header.field_delimiter_found = true;
-                } else {
-                    // Seek for the first non-white space character.
-                    // OR a new line character, which marks the end of the header field value (i.e.; empty header field).
-                    if(cur == '\n'){
-                        // The newline character marks the end of the header field value.
-                        // Technically, there is an exception for the message/http media type that delimited line folding is allowed.
-                        // However for the purposes of my application, I am only planning on implementing the application/json media type.
-                        header.header_complete = true;
-                        break;
-                    } else if(!std::isspace(cur) && !header.field_value_started){
-                        // The first non-whitespace character marks the beginning of the field falues.
+                    ++pos;
+                } else if(cur == '\n'){
+                    // The newline character marks the end of the header field value.
+                    // Technically, there is an exception for the message/http media type that delimited line folding is allowed.
+                    // However for the purposes of my application, I am only planning on implementing the application/json media type.
+                    header.header_complete = true;
+                    ++pos;
+                    break;
+                } else if(!header.field_value_started){
+                    // The first non-whitespace character marks the beginning of the field falues.
+                    if(!is_space(cur)){
                         header.field_value_started = true;
-                        header.field_value.push_back(cur);
-                    } else if(header.field_value_started && !header.field_value_ended){
-                        // The first non-white space character has been found,
-                        // that means that all visible ASCII character + spaces + tabs 
-                        // are part of the header field value, otherwise, the field 
-                        // value has finished.
-                        if(!std::isspace(cur) || cur == ' ' || cur == '\t'){
-                            header.field_value.push_back(cur);
-                        } else {
-                            header.field_value_ended = true;
-                        }
+                    } else {
+                        ++pos;
+                    }
+                } else if(!header.field_value_ended){
+                    // The first non-white space character has been found,
+                    // that means that all visible ASCII character + spaces + tabs 
+                    // are part of the header field value, otherwise, the field 
+                    // value has finished.
+                    std::size_t end = pos;
+                    while(end < buf.size() && (!is_space(buf[end]) || buf[end] == ' ' || buf[end] == '\t') && (header.field_delimiter_found || buf[end] != ':')){
+                        ++end;
+                    }
+                    if(end == pos){
+                        header.field_value_ended = true;
+                        ++pos;
+                    } else {
+                        header.field_value.append(buf.data() + pos, end - pos);
+                        pos = end;
                     }
+                } else {
+                    // Skip to the newline character.
+                    const void* nl = std::memchr(buf.data() + pos, '\n', buf.size() - pos);
+                    pos = (nl == nullptr) ? buf.size() : static_cast<const char*>(nl) - buf.data();
                 }
             }
-            bytes_available = is.rdbuf()->in_avail();
         }
-        return is;
+        return pos;
+    }
+
+    std::istream& operator>>(std::istream& is, HttpHeader& header){
+        return extract(is, header);
     }
 
     std::ostream& operator<<(std::ostream& os, const HttpHeader& header){
@@ -612,11 +645,7 @@ namespace http
         return os;
     }
 
-    std::istream& operator>>(std::istream& is, HttpRequest& req){
-        // Get the stream locale for parsing.
-        // std::locale loc = is.getloc();
-        std::streamsize bytes_available = is.rdbuf()->in_avail();
-        char c;
+    std::size_t parse(std::string_view buf, HttpRequest& req){
         if(req.num_headers == 0 && req.num_chunks == 0 && req.verb == HttpVerb::UNKNOWN){
             // managmeent things we need to do if this is a 
             // brand new 0 initialized request.
@@ -635,14 +664,13 @@ namespace http
             req.next_header = 0;
             req.next_chunk = 0;
         }
-        // While there are bytes available in the input stream, keep parsing.
+        std::size_t pos = 0;
+        // While there are bytes available in the buffer, keep parsing.
         // It is the programmers responsibility to ensure that the 
         // invariant that headers are fully parsed when next_header == num_headers
         // and that chunks are fully parsed when next_chunk == num_chunks.
-        while(bytes_available > 0 && (req.next_header < req.num_headers || req.next_chunk < req.num_chunks || !req.http_request_line_complete)){
+        while(pos < buf.size() && (req.next_header < req.num_headers || req.next_chunk < req.num_chunks || !req.http_request_line_complete)){
             if(!req.http_request_line_complete){
-                c = is.rdbuf()->sbumpc();
-                --bytes_available;
                 // First parse the request line, which has a format of:
                 // VERB ROUTE HTTP/VERSION\r\n
                 if(!req.verb_started){
@@ -653,141 +681,85 @@ namespace http
                     // Hopefully, the white space check, in addition to the specific character check
                     // will limit the probability that a capital letter in a spurious data stream
                     // creates a memory leak in the application.
-                    if(!std::isspace(c)){
+                    char c = buf[pos];
+                    if(!is_space(c)){
                         switch(c)
                         {
                             case 'G':
-                                req.verb_started = true;
-                                req.verb_buf.push_back(c);
-                                break;
                             case 'P':
-                                req.verb_started = true;
-                                req.verb_buf.push_back(c);
-                                break;
                             case 'T':
-                                req.verb_started = true;
-                                req.verb_buf.push_back(c);
-                                break;
                             case 'D':
-                                req.verb_started = true;
-                                req.verb_buf.push_back(c);
-                                break;
                             case 'C':
                                 req.verb_started = true;
-                                req.verb_buf.push_back(c);
                                 break;
                             default:
-                                return is;
+                                return pos + 1;
                         }
+                    } else {
+                        ++pos;
                     }
                 } else if (!req.verb_finished){
-                    // append all non-white space
-                    // characters until we find the first white space character.
-                    if(!std::isspace(c)){
-                        req.verb_buf.push_back(c);
+                    // The verb runs until the first white space character.
+                    std::size_t end = find_space(buf, pos);
+                    if(end == buf.size()){
+                        req.verb_buf.append(buf.substr(pos));
+                        pos = end;
                     } else {
-                        if(req.verb_buf == "GET"){
-                            req.verb = HttpVerb::GET;
-                        } else if (req.verb_buf == "POST"){
-                            req.verb = HttpVerb::POST;
-                        } else if (req.verb_buf == "PATCH"){
-                            req.verb = HttpVerb::PATCH;
-                        } else if (req.verb_buf == "PUT"){
-                            req.verb = HttpVerb::PUT;
-                        } else if (req.verb_buf == "TRACE"){
-                            req.verb = HttpVerb::TRACE;
-                        } else if (req.verb_buf == "DELETE"){
-                            req.verb = HttpVerb::DELETE;
-                        } else if (req.verb_buf == "CONNECT"){
-                            req.verb = HttpVerb::CONNECT;
-                        } else {
-                            req.verb = HttpVerb::UNKNOWN;
+                        std::string_view verb = token(buf.substr(pos, end - pos), req.verb_buf);
+                        req.verb = http_verb(verb);
+                        if(req.verb == HttpVerb::UNKNOWN && req.verb_buf.empty()){
+                            req.verb_buf = verb;
                         }
                         req.verb_finished = true;
+                        pos = end + 1;
                     }
                 } else if (!req.route_started){
                     // Seek through white space until we find 
                     // the first non-white space character.
-                    if(!std::isspace(c)){
+                    if(!is_space(buf[pos])){
                         req.route_started = true;
-                        req.route.push_back(c);
+                    } else {
+                        ++pos;
                     }
                 } else if (!req.route_finished){
-                    if(!std::isspace(c)){
-                        req.route.push_back(c);
+                    std::size_t end = find_space(buf, pos);
+                    req.route.append(buf.data() + pos, end - pos);
+                    if(end == buf.size()){
+                        pos = end;
                     } else {
                         req.route_finished = true;
+                        pos = end + 1;
                     }
                 } else if (req.find_version_state < HttpRequest::max_find_state){
                     // Seek through white space until we find
                     // the string 'HTTP/'
-                    switch(req.find_version_state)
-                    {
-                        case 0:
-                            if(c == 'H'){
-                                req.find_version_state = 1;
-                            }
-                            break;
-                        case 1:
-                            if(c == 'T'){
-                                req.find_version_state = 2;
-                            } else {
-                                req.find_version_state = 0;
-                            }
-                            break;
-                        case 2:
-                            if(c == 'T'){
-                                req.find_version_state = 3;
-                            } else {
-                                req.find_version_state = 0;
-                            }
-                            break;
-                        case 3:
-                            if(c == 'P'){
-                                req.find_version_state = 4;
-                            } else {
-                                req.find_version_state = 0;
-                            }
-                            break;
-                        case 4:
-                            if(c == '/'){
-                                req.find_version_state = 5;
-                            } else {
-                                req.find_version_state = 0;
-                            }
-                            break;
-                    }
+                    find_version(req.find_version_state, buf[pos++]);
                 } else if (!req.version_finished){
                     // We have found the string 'HTTP/'. Now everything until the subsequent white
                     // space character is part of the version string.
-                    if(!std::isspace(c)){
-                        req.version_buf.push_back(c);
+                    std::size_t end = find_space(buf, pos);
+                    if(end == buf.size()){
+                        req.version_buf.append(buf.substr(pos));
+                        pos = end;
                     } else {
-                        if(req.version_buf == "1.1"){
-                            req.version = HttpVersion::V1_1;
-                        } else if (req.version_buf == "1.0"){
-                            req.version = HttpVersion::V1;
-                        } else if (req.version_buf == "2"){
-                            req.version = HttpVersion::V2;
-                        } else if (req.version_buf == "3"){
-                            req.version = HttpVersion::V3;
-                        } else if (req.version_buf == "0.9"){
-                            req.version = HttpVersion::V0_9;
-                        } else {
-                            req.version = HttpVersion::UNKNOWN;
-                        }
+                        req.version = http_version(token(buf.substr(pos, end - pos), req.version_buf));
                         req.version_finished = true;
+                        pos = end + 1;
                     }
                 } else {
                     // Seek to the end of the line.
-                    if(c == '\n'){
+                    std::size_t end = find_line_end(buf, pos);
+                    if(end == std::string_view::npos){
+                        pos = buf.size();
+                    } else {
                         req.http_request_line_complete = true;
+                        pos = end;
                     }
                 }
             } else if (req.next_header < req.num_headers){
                 HttpHeader& next_header = req.headers[req.next_header];
                 // Parse the next header.
-                is >> next_header;
+                pos += parse(buf.substr(pos), next_header);
                 if(next_header.header_complete){
                     // If the header is complete we need to
                     // do some request state management.
@@ -818,15 +790,15 @@ namespace http
                         next_chunk.chunk_size_found = true;
                         next_chunk.chunk_body_start = true;
                     }
-                    is >> next_chunk;
+                    pos += parse(buf.substr(pos), next_chunk);
                     if(next_chunk.chunk_size == next_chunk.received_bytes){
                         // Finish parsing.
                         req.next_chunk = req.num_chunks;
                     }
                 } else {
-                    is >> next_chunk;
+                    pos += parse(buf.substr(pos), next_chunk);
                     if(next_chunk.chunk_complete){
-                        if(next_chunk.chunk_size != HttpBigNum{0}){
+                        if(next_chunk.chunk_size != 0){
                             ++(req.num_chunks);
                             req.chunks.emplace_back();
                         }
@@ -834,169 +806,276 @@ namespace http
                     }
                 }
             }
-            bytes_available = is.rdbuf()->in_avail();
         }
-        return is;
+        return pos;
     }
 
-    std::ostream& operator<<(std::ostream& os, const HttpRequest& req){
+    std::istream& operator>>(std::istream& is, HttpRequest& req){
+        return extract(is, req);
+    }
+
+    namespace {
+        /* Serialization helpers. */
+        // Collects the segments of a gathered write. Segments in the head are recorded by their offset,
+        // because the head can reallocate while it is being rendered.
+        class Gather
+        {
+        public:
+            explicit Gather(std::string& head): head_(head) {}
+
+            Gather& operator<<(std::string_view text){
+                if(!segments_.empty() && segments_.back().data == nullptr && segments_.back().offset + segments_.back().len == head_.size()){
+                    segments_.back().len += text.size();
+                } else {
+                    segments_.push_back(Segment{nullptr, head_.size(), text.size()});
+                }
+                head_.append(text);
+                return *this;
+            }
+
+            Gather& operator<<(const HttpBigNum& num){
+                // Matches the insertion operator, with every word after the first padded to full width.
+                static constexpr std::size_t width = 2*sizeof(std::size_t);
+                std::array<char, width> digits;
+                if(!num.overflowed()){
+                    std::to_chars_result res = std::to_chars(digits.data(), digits.data() + width, num.value(), 16);
+                    return (*this << std::string_view(digits.data(), res.ptr - digits.data()));
+                }
+                auto it = num.words().begin();
+                std::to_chars_result res = std::to_chars(digits.data(), digits.data() + width, *it, 16);
+                *this << std::string_view(digits.data(), res.ptr - digits.data());
+                for(++it; it != num.words().end(); ++it){
+                    std::array<char, width> padded;
+                    padded.fill('0');
+                    res = std::to_chars(digits.data(), digits.data() + width, *it, 16);
+                    std::copy(digits.data(), res.ptr, padded.end() - (res.ptr - digits.data()));
+                    *this << std::string_view(padded.data(), width);
+                }
+                return *this;
+            }
+
+            Gather& operator<<(const HttpHeader& header){
+                std::string_view name;
+                switch(header.field_name)
+                {
+                    case HttpHeaderField::CONTENT_TYPE:
+                        name = "Content-Type: ";
+                        break;
+                    case HttpHeaderField::CONTENT_LENGTH:
+                        name = "Content-Length: ";
+                        break;
+                    case HttpHeaderField::ACCEPT:
+                        name = "Accept: ";
+                        break;
+                    case HttpHeaderField::HOST:
+                        name = "Host: ";
+                        break;
+                    case HttpHeaderField::TRANSFER_ENCODING:
+                        name = "Transfer-Encoding: ";
+                        break;
+                    case HttpHeaderField::CONNECTION:
+                        name = "Connection: ";
+                        break;
+                    case HttpHeaderField::END_OF_HEADERS:
+                        return *this << "\r\n";
+                    default:
+                        return *this;
+                }
+                return *this << name << header.field_value << "\r\n";
+            }
+
+            Gather& operator<<(const HttpChunk& chunk){
+                *this << chunk.chunk_size << "\r\n";
+                payload(chunk.chunk_data);
+                return *this << "\r\n";
+            }
+
+            // The payload is referenced in place.
+            void payload(std::string_view data){
+                if(!data.empty()){
+                    segments_.push_back(Segment{data.data(), 0, data.size()});
+                }
+            }
+
+            std::vector<std::string_view> views() const {
+                std::vector<std::string_view> views;
+                views.reserve(segments_.size());
+                for(const Segment& segment: segments_){
+                    if(segment.data == nullptr){
+                        views.emplace_back(head_.data() + segment.offset, segment.len);
+                    } else {
+                        views.emplace_back(segment.data, segment.len);
+                    }
+                }
+                return views;
+            }
+
+        private:
+            struct Segment
+            {
+                const char* data;
+                std::size_t offset;
+                std::size_t len;
+            };
+            std::string& head_;
+            std::vector<Segment> segments_;
+        };
+
+        template<typename T>
+        void gather_body(Gather& g, const T& msg){
+            auto it = std::find_if(msg.headers.begin(), msg.headers.end(), [](auto& header){
+                return header.field_name == HttpHeaderField::CONTENT_LENGTH;
+            });
+            if(it != msg.headers.end()){
+                g.payload(msg.chunks[0].chunk_data);
+            } else {
+                for(std::size_t i = msg.next_chunk; i < msg.chunks.size(); ++i){
+                    g << msg.chunks[i];
+                }
+            }
+        }
+
+        template<typename T>
+        std::ostream& insert(std::ostream& os, const T& msg){
+            std::string head;
+            for(std::string_view view: serialize(msg, head)){
+                os.write(view.data(), view.size());
+            }
+            return os;
+        }
+    }// End of Serialization helpers.
+
+    std::vector<std::string_view> serialize(const HttpRequest& req, std::string& head){
+        Gather g(head);
         if(!req.http_request_line_complete){
             switch(req.verb){
                 case HttpVerb::GET:
-                    os << "GET ";
+                    g << "GET ";
                     break;
                 case HttpVerb::POST:
-                    os << "POST ";
+                    g << "POST ";
                     break;
                 case HttpVerb::PATCH:
-                    os << "PATCH ";
+                    g << "PATCH ";
                     break;
                 case HttpVerb::PUT:
-                    os << "PUT ";
+                    g << "PUT ";
                     break;
                 case HttpVerb::TRACE:
-                    os << "TRACE ";
+                    g << "TRACE ";
                     break;
                 case HttpVerb::DELETE:
-                    os << "DELETE ";
+                    g << "DELETE ";
                     break;
                 case HttpVerb::CONNECT:
-                    os << "CONNECT ";
+                    g << "CONNECT ";
                     break;
                 default:
-                    os << req.verb_buf;
+                    g << req.verb_buf;
                     break;
             }
-            os << req.route << " HTTP/";
+            g << req.route << " HTTP/";
             switch(req.version)
             {
                 case HttpVersion::V1:
-                    os << "1.0\r\n";
+                    g << "1.0\r\n";
                     break;
                 case HttpVersion::V1_1:
-                    os << "1.1\r\n";
+                    g << "1.1\r\n";
                     break;
                 case HttpVersion::V2:
-                    os << "2\r\n";
+                    g << "2\r\n";
                     break;
                 case HttpVersion::V3:
-                    os << "3\r\n";
+                    g << "3\r\n";
                     break;
                 case HttpVersion::V0_9:
-                    os << "0.9\r\n";
+                    g << "0.9\r\n";
                     break;
                 default:
-                    os << "1.0\r\n";
+                    g << "1.0\r\n";
                     break;
             }
         }
-        std::size_t num_headers = req.headers.size();
-        for(std::size_t i = req.next_header; i < num_headers; ++i){
-            const http::HttpHeader& header = req.headers[i];
-            if(header.field_name == HttpHeaderField::END_OF_HEADERS){
-                os << "\r\n";
-            } else {
-                os << header;
-            }
+        for(std::size_t i = req.next_header; i < req.headers.size(); ++i){
+            g << req.headers[i];
         }
-        std::size_t num_chunks = req.chunks.size();
-        if(req.verb != HttpVerb::GET && req.verb != HttpVerb::DELETE && req.verb != HttpVerb::TRACE && req.next_chunk < num_chunks){
-            auto it = std::find_if(req.headers.begin(), req.headers.end(), [](auto& header){
-                return header.field_name == HttpHeaderField::CONTENT_LENGTH;
-            });
-            if(it != req.headers.end()){
-                os << req.chunks[0].chunk_data;
-            } else {
-                for(std::size_t i = req.next_chunk; i < num_chunks; ++i ){
-                    const http::HttpChunk& chunk = req.chunks[i];
-                    os << chunk;
-                }
-            }
+        if(req.verb != HttpVerb::GET && req.verb != HttpVerb::DELETE && req.verb != HttpVerb::TRACE && req.next_chunk < req.chunks.size()){
+            gather_body(g, req);
         }
-        return os;
+        return g.views();
     }
 
-    std::ostream& operator<<(std::ostream& os, const HttpResponse& res){
+    std::ostream& operator<<(std::ostream& os, const HttpRequest& req){
+        return insert(os, req);
+    }
+
+    std::vector<std::string_view> serialize(const HttpResponse& res, std::string& head){
+        Gather g(head);
         if(!res.status_line_finished){
             switch(res.version)
             {
                 case HttpVersion::V1:
-                    os << "HTTP/1.0 ";
+                    g << "HTTP/1.0 ";
                     break;
                 case HttpVersion::V1_1:
-                    os << "HTTP/1.1 ";
+                    g << "HTTP/1.1 ";
                     break;
                 case HttpVersion::V2:
-                    os << "HTTP/2 ";
+                    g << "HTTP/2 ";
                     break;
                 case HttpVersion::V3:
-                    os << "HTTP/3 ";
+                    g << "HTTP/3 ";
                     break;
                 case HttpVersion::V0_9:
-                    os << "HTTP/0.9 ";
+                    g << "HTTP/0.9 ";
                     break;
                 default:
-                    os << "HTTP/1.0";
+                    g << "HTTP/1.0";
                     break;
             }
             switch(res.status)
             {
                 case HttpStatus::OK:
-                    os << "200 OK\r\n";
+                    g << "200 OK\r\n";
                     break;
                 case HttpStatus::NOT_FOUND:
-                    os << "404 Not Found\r\n";
+                    g << "404 Not Found\r\n";
                     break;
                 case HttpStatus::CONFLICT:
-                    os << "409 Conflict\r\n";
+                    g << "409 Conflict\r\n";
                     break;
                 case HttpStatus::METHOD_NOT_ALLOWED:
-                    os << "405 Method Not Allowed\r\n";
+                    g << "405 Method Not Allowed\r\n";
                     break;
                 case HttpStatus::INTERNAL_SERVER_ERROR:
-                    os << "500 Internal Server Error\r\n";
+                    g << "500 Internal Server Error\r\n";
                     break;
                 case HttpStatus::CREATED:
-                    os << "201 Created\r\n";
+                    g << "201 Created\r\n";
                     break;
                 case HttpStatus::ACCEPTED:
-                    os << "202 Accepted\r\n";
+                    g << "202 Accepted\r\n";
                     break;
                 default:
-                    os << "500 Internal Server Error\r\n";
+                    g << "500 Internal Server Error\r\n";
                     break;
             }
         }
-        std::size_t num_headers = res.headers.size();
-        for(std::size_t i = res.next_header; i < num_headers; ++i){
-            const http::HttpHeader& header = res.headers[i];
-            if(header.field_name == HttpHeaderField::END_OF_HEADERS){
-                os << "\r\n";
-            } else {
-                os << header;
-            }
+        for(std::size_t i = res.next_header; i < res.headers.size(); ++i){
+            g << res.headers[i];
         }
-
-        std::size_t num_chunks = res.chunks.size();
-        if(res.next_chunk != num_chunks){
-            auto it = std::find_if(res.headers.begin(), res.headers.end(), [](auto& header){
-                return header.field_name == HttpHeaderField::CONTENT_LENGTH;
-            });
-            if(it != res.headers.end()){
-                os << res.chunks[0].chunk_data;
-            } else {
-                for(std::size_t i = res.next_chunk; i < num_chunks; ++i){
-                    const http::HttpChunk& chunk = res.chunks[i];
-                    os << chunk;
-                }
-            }           
+        if(res.next_chunk != res.chunks.size()){
+            gather_body(g, res);
         }
-        return os;
+        return g.views();
     }
 
-    std::istream& operator>>(std::istream& is, HttpResponse& res){
-        std::streamsize bytes_available = is.rdbuf()->in_avail();
-        char c;
+    std::ostream& operator<<(std::ostream& os, const HttpResponse& res){
+        return insert(os, res);
+    }
+
+    std::size_t parse(std::string_view buf, HttpResponse& res){
         if(res.num_headers == 0 && res.num_chunks == 0 && res.find_version_state == 0){
             // managmeent things we need to do if this is a 
             // brand new 0 initialized response.
@@ -1015,118 +1094,63 @@ namespace http
             res.next_header = 0;
             res.next_chunk = 0;
         }
-        // While there are bytes available in the input stream, keep parsing.
+        std::size_t pos = 0;
+        // While there are bytes available in the buffer, keep parsing.
         // It is the programmers responsibility to ensure that the 
         // invariant that headers are fully parsed when next_header == num_headers
         // and that chunks are fully parsed when next_chunk == num_chunks.
-        while(bytes_available > 0 && (res.next_header < res.num_headers || res.next_chunk < res.num_chunks || !res.status_line_finished)){
+        while(pos < buf.size() && (res.next_header < res.num_headers || res.next_chunk < res.num_chunks || !res.status_line_finished)){
             if(!res.status_line_finished){
                 // First parse the status line, which has a format of:
                 // HTTP/VERSION STATUS_CODE STATUS_MESSAGE\r\n
-                c = is.rdbuf()->sbumpc();
-                --bytes_available;
                 if(res.find_version_state < res.max_find_state){
                     // Search for the HTTP VERSION.
-                    switch(res.find_version_state)
-                    {
-                        case 0:
-                            if(c == 'H'){
-                                res.find_version_state = 1;
-                            }
-                            break;
-                        case 1:
-                            if(c == 'T'){
-                                res.find_version_state = 2;
-                            } else {
-                                res.find_version_state = 0;
-                            }
-                            break;
-                        case 2:
-                            if(c == 'T'){
-                                res.find_version_state = 3;
-                            } else {
-                                res.find_version_state = 0;
-                            }
-                            break;
-                        case 3:
-                            if(c == 'P'){
-                                res.find_version_state = 4;
-                            } else {
-                                res.find_version_state = 0;
-                            }
-                            break;
-                        case 4:
-                            if(c == '/'){
-                                res.find_version_state = 5;
-                            } else {
-                                res.find_version_state = 0;
-                            }
-                            break;
-                    }
+                    find_version(res.find_version_state, buf[pos++]);
                 } else if (!res.version_finished){
-                    if(!std::isspace(c)){
-                        // Append all of the subsequent non-whitespace characters into the version buffer.
-                        res.version_buf.push_back(c);
+                    // Append all of the subsequent non-whitespace characters into the version buffer.
+                    std::size_t end = find_space(buf, pos);
+                    if(end == buf.size()){
+                        res.version_buf.append(buf.substr(pos));
+                        pos = end;
                     } else {
                         // At the first whitespace character set the http version.
-                        if(res.version_buf == "0.9"){
-                            res.version = HttpVersion::V0_9;
-                        } else if (res.version_buf == "1.0"){
-                            res.version = HttpVersion::V1;
-                        } else if (res.version_buf == "1.1"){
-                            res.version = HttpVersion::V1_1;
-                        } else if (res.version_buf == "2"){
-                            res.version = HttpVersion::V2;
-                        } else if (res.version_buf == "3"){
-                            res.version = HttpVersion::V3;
-                        } else {
-                            res.version = HttpVersion::UNKNOWN;
-                        }
+                        res.version = http_version(token(buf.substr(pos, end - pos), res.version_buf));
                         res.version_finished = true;
+                        pos = end + 1;
                     }
                 } else if (!res.status_started){
-                    if(!std::isspace(c)){
-                        // Seek to the first non-whitespace character.
-                        res.status_buf.push_back(c);
+                    // Seek to the first non-whitespace character.
+                    if(!is_space(buf[pos])){
                         res.status_started = true;
+                    } else {
+                        ++pos;
                     }
                 } else if (!res.status_finished){
-                    if(!std::isspace(c)){
-                        // Append all of the subsequent non-whitespace characters
-                        // until the first whitespace character.
-                        res.status_buf.push_back(c);
+                    // Append all of the subsequent non-whitespace characters
+                    // until the first whitespace character.
+                    std::size_t end = find_space(buf, pos);
+                    if(end == buf.size()){
+                        res.status_buf.append(buf.substr(pos));
+                        pos = end;
                     } else {
-                        if(res.status_buf == "200"){
-                            res.status = HttpStatus::OK;
-                        } else if (res.status_buf == "204"){
-                            res.status = HttpStatus::NO_CONTENT;
-                        } else if (res.status_buf == "404"){
-                            res.status = HttpStatus::NOT_FOUND;
-                        } else if (res.status_buf == "409"){
-                            res.status = HttpStatus::CONFLICT;
-                        } else if (res.status_buf == "405"){
-                            res.status = HttpStatus::METHOD_NOT_ALLOWED;
-                        } else if (res.status_buf == "500"){
-                            res.status = HttpStatus::INTERNAL_SERVER_ERROR;
-                        } else if (res.status_buf == "201"){
-                            res.status = HttpStatus::CREATED;
-                        } else if (res.status_buf == "202"){
-                            res.status = HttpStatus::ACCEPTED;
-                        } else {
-                            res.status = HttpStatus::INTERNAL_SERVER_ERROR;
-                        }
+                        res.status = http_status(token(buf.substr(pos, end - pos), res.status_buf));
                         res.status_finished = true;
+                        pos = end + 1;
                     }
-                } else if (!res.status_line_finished){
-                    if(c == '\n'){
-                        // Seek to the newline character.
+                } else {
+                    // Seek to the newline character.
+                    std::size_t end = find_line_end(buf, pos);
+                    if(end == std::string_view::npos){
+                        pos = buf.size();
+                    } else {
                         res.status_line_finished = true;
+                        pos = end;
                     }
                 }
             } else if (res.next_header < res.num_headers){
                 HttpHeader& next_header = res.headers[res.next_header];
                 // Parse the next header.
-                is >> next_header;
+                pos += parse(buf.substr(pos), next_header);
                 if(next_header.header_complete){
                     // If the header is complete we need to
                     // do some request state management.
@@ -1157,15 +1181,15 @@ namespace http
                         next_chunk.chunk_size_found = true;
                         next_chunk.chunk_body_start = true;
                     }
-                    is >> next_chunk;
+                    pos += parse(buf.substr(pos), next_chunk);
                     if(next_chunk.chunk_size == next_chunk.received_bytes){
                         // Finish parsing.
                         res.next_chunk = res.num_chunks;
                     }
                 } else {
-                    is >> next_chunk;
+                    pos += parse(buf.substr(pos), next_chunk);
                     if(next_chunk.chunk_complete){
-                        if(next_chunk.chunk_size != HttpBigNum{0}){
+                        if(next_chunk.chunk_size != 0){
                             ++(res.num_chunks);
                             res.chunks.emplace_back();
                         }
@@ -1173,9 +1197,12 @@ namespace http
                     }
                 }
             }
-            bytes_available = is.rdbuf()->in_avail();
         }
-        return is;        
+        return pos;
+    }
+
+    std::istream& operator>>(std::istream& is, HttpResponse& res){
+        return extract(is, res);
     }
 
 }
\ No newline at end of file
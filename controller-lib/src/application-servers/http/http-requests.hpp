@@ -2,6 +2,8 @@
 #define OWLIB_HTTP_REQUESTS_HPP
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 namespace http{
     enum class HttpVersion
@@ -55,25 +57,41 @@ namespace http{
     };
 
     // This represents arbitrarily large Http Chunk Size numbers.
-    class HttpBigNum: public std::vector<std::size_t>
+    // Numbers that fit in 64 bits are stored inline. Arithmetic that overflows 64 bits moves the number into
+    // a vector of words, most significant word first, and numbers that shrink back into 64 bits are stored inline again.
+    class HttpBigNum
     {
     public:
         constexpr static struct Dec{} dec{};
         constexpr static struct Hex{} hex{};
 
 
-        HttpBigNum(): std::vector<std::size_t>{0} {}
-        HttpBigNum(std::initializer_list<std::size_t> init): std::vector<std::size_t>(init){}
-        HttpBigNum(const std::vector<std::size_t>& init): std::vector<std::size_t>(init){}
-        explicit HttpBigNum(Hex, const std::string& hex_str);
-        explicit HttpBigNum(Dec, const std::string& dec_str);
+        HttpBigNum(): value_{0} {}
+        HttpBigNum(std::initializer_list<std::size_t> init);
+        HttpBigNum(const std::vector<std::size_t>& init);
+        explicit HttpBigNum(Hex, std::string_view hex_str);
+        explicit HttpBigNum(Dec, std::string_view dec_str);
 
-        bool operator==(const HttpBigNum& rhs);
-        bool operator!=(const HttpBigNum& rhs);
-        bool operator<(const HttpBigNum& rhs);
-        bool operator<=(const HttpBigNum& rhs);
-        bool operator>(const HttpBigNum& rhs);
-        bool operator>=(const HttpBigNum& rhs);
+        // True if the number doesn't fit in 64 bits.
+        bool overflowed() const { return !words_.empty(); }
+        // The number, saturated at 2^64-1.
+        std::uint64_t value() const;
+        // The words of a number that has overflowed, most significant word first.
+        const std::vector<std::size_t>& words() const { return words_; }
+
+        bool operator==(const HttpBigNum& rhs) const { return compare(rhs) == 0; }
+        bool operator!=(const HttpBigNum& rhs) const { return compare(rhs) != 0; }
+        bool operator<(const HttpBigNum& rhs) const { return compare(rhs) < 0; }
+        bool operator<=(const HttpBigNum& rhs) const { return compare(rhs) <= 0; }
+        bool operator>(const HttpBigNum& rhs) const { return compare(rhs) > 0; }
+        bool operator>=(const HttpBigNum& rhs) const { return compare(rhs) >= 0; }
+
+        bool operator==(std::uint64_t rhs) const { return !overflowed() && value_ == rhs; }
+        bool operator!=(std::uint64_t rhs) const { return overflowed() || value_ != rhs; }
+        bool operator<(std::uint64_t rhs) const { return !overflowed() && value_ < rhs; }
+        bool operator<=(std::uint64_t rhs) const { return !overflowed() && value_ <= rhs; }
+        bool operator>(std::uint64_t rhs) const { return overflowed() || value_ > rhs; }
+        bool operator>=(std::uint64_t rhs) const { return overflowed() || value_ >= rhs; }
 
         HttpBigNum& operator++();
         HttpBigNum operator++(int);
@@ -81,16 +99,22 @@ namespace http{
         HttpBigNum operator--(int);
 
         HttpBigNum& operator+=(const HttpBigNum& rhs);
-        HttpBigNum& operator+=(const std::size_t& rhs);
+        HttpBigNum& operator+=(std::uint64_t rhs);
         friend HttpBigNum operator+(HttpBigNum lhs, const HttpBigNum& rhs);
-        friend HttpBigNum operator+(HttpBigNum lhs, const std::size_t& rhs);
+        friend HttpBigNum operator+(HttpBigNum lhs, std::uint64_t rhs);
 
         HttpBigNum& operator-=(const HttpBigNum& rhs);
-        HttpBigNum& operator-=(const std::size_t& rhs);
+        HttpBigNum& operator-=(std::uint64_t rhs);
         friend HttpBigNum operator-(HttpBigNum lhs, const HttpBigNum& rhs);
-        friend HttpBigNum operator-(HttpBigNum lhs, const std::size_t& rhs);
+        friend HttpBigNum operator-(HttpBigNum lhs, std::uint64_t rhs);
        
     private:
+        int compare(const HttpBigNum& rhs) const;
+        // Moves the words of the number back inline if it fits in 64 bits.
+        void normalize();
+
+        std::uint64_t value_;
+        std::vector<std::size_t> words_;
     };
     std::ostream& operator<<(std::ostream& os, const HttpBigNum& num);
 
@@ -115,6 +139,9 @@ namespace http{
     };
     // Http chunks are extracted from input streams.
     std::istream& operator>>(std::istream& is, HttpChunk& chunk);
+    // Http messages can also be parsed in place from a receive buffer. Each parse consumes as many bytes as it can,
+    // and returns the number of bytes consumed. Parsing resumes from the message state on the next buffer.
+    std::size_t parse(std::string_view buf, HttpChunk& chunk);
     std::ostream& operator<<(std::ostream& os, const HttpChunk& chunk);
     
     struct HttpHeader
@@ -132,6 +159,7 @@ namespace http{
         bool not_last;
     };
     std::istream& operator>>(std::istream& is, HttpHeader& header);
+    std::size_t parse(std::string_view buf, HttpHeader& header);
     std::ostream& operator<<(std::ostream& os, const HttpHeader& header);
 
     // This is an HTTP1.1 Request Structure.
@@ -198,7 +226,11 @@ namespace http{
         bool http_request_line_complete;
     };
     std::istream& operator>>(std::istream& is, HttpRequest& req);
+    std::size_t parse(std::string_view buf, HttpRequest& req);
     std::ostream& operator<<(std::ostream& os, const HttpRequest& req);
+    // Http messages are serialized for gathered writes. The start line, headers, and chunk framing are appended to head.
+    // The returned views point into head and into the chunk data of the message, so they are only valid while neither changes.
+    std::vector<std::string_view> serialize(const HttpRequest& req, std::string& head);
 
     struct HttpResponse
     {
@@ -249,7 +281,9 @@ namespace http{
         bool not_chunked_transfer;     
     };
     std::ostream& operator<<(std::ostream& os, const HttpResponse& res);
+    std::vector<std::string_view> serialize(const HttpResponse& res, std::string& head);
     std::istream& operator>>(std::istream& is, HttpResponse& res);
+    std::size_t parse(std::string_view buf, HttpResponse& res);
 
 }
 #endif
\ No newline at end of file
@@ -1,12 +1,49 @@
 #include "http-session.hpp"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
 
 #ifdef DEBUG
 #include <sys/wait.h>
 #endif
 
 namespace http{
+    namespace {
+        // A gathered write owns the message that it sends, and the head buffer that the message is serialized into,
+        // until the write completes.
+        template<typename T>
+        struct WriteBuffer
+        {
+            T msg;
+            std::string head;
+            std::vector<boost::asio::const_buffer> bufs;
+
+            void gather(){
+                for(std::string_view view: serialize(msg, head)){
+                    bufs.emplace_back(view.data(), view.size());
+                }
+            }
+        };
+
+        // The chunk data that is still to be written is moved out of the session's message, and the rest of the message is
+        // copied, so that the session keeps the state of the message without sharing the payload with the write.
+        template<typename T>
+        std::shared_ptr<WriteBuffer<T> > detach(T& msg){
+            std::vector<std::string> data;
+            data.reserve(msg.chunks.size() - std::min(msg.next_chunk, msg.chunks.size()));
+            for(std::size_t i = msg.next_chunk; i < msg.chunks.size(); ++i){
+                data.push_back(std::move(msg.chunks[i].chunk_data));
+            }
+            std::shared_ptr<WriteBuffer<T> > wb = std::make_shared<WriteBuffer<T> >();
+            wb->msg = msg;
+            for(std::size_t i = 0; i < data.size(); ++i){
+                wb->msg.chunks[msg.next_chunk + i].chunk_data = std::move(data[i]);
+            }
+            wb->gather();
+            return wb;
+        }
+    }
+
     void HttpSession::read()
     {
         acquire_lock();
@@ -33,14 +70,12 @@ namespace http{
         struct timespec ts;
         #endif
 
-        std::stringstream ss;
         acquire_lock();
         HttpResponse& res = std::get<HttpResponse>(*this);
-        ss << res;
-        std::string data_buf(ss.str());
+        std::shared_ptr<WriteBuffer<HttpResponse> > wb = detach(res);
 
         #ifdef DEBUG
-        clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "http-session.cpp:32:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":HTTP_RESPONSE_DATA:" << data_buf << std::endl;
+        clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "http-session.cpp:78:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":HTTP_RESPONSE_DATA:" << wb->msg << std::endl;
         #endif
 
         res.status_line_finished = true;
@@ -49,8 +84,8 @@ namespace http{
 
         auto self = shared_from_this();
         t_session_->async_write(
-            boost::asio::const_buffer(data_buf.data(), data_buf.size()),
-            [&,fn,self](const std::error_code& ec){
+            wb->bufs,
+            [&,fn,self,wb](const std::error_code& ec){
                 fn(ec);
             }
         );
@@ -59,13 +94,14 @@ namespace http{
 
     void HttpSession::write(const HttpReqRes& req_res, const std::function<void(const std::error_code& ec)>& fn)
     {
-        std::stringstream ss;
-        ss << std::get<HttpResponse>(req_res);
-        std::string data_buf(ss.str());
-
+        std::shared_ptr<WriteBuffer<HttpResponse> > wb = std::make_shared<WriteBuffer<HttpResponse> >();
+        wb->msg = std::get<HttpResponse>(req_res);
+        wb->gather();
         t_session_->async_write(
-            boost::asio::const_buffer(data_buf.data(), data_buf.size()),
-            fn
+            wb->bufs,
+            [fn, wb](const std::error_code& ec){
+                fn(ec);
+            }
         );
     }
 
@@ -102,7 +138,6 @@ namespace http{
 
     void HttpClientSession::write(const std::function<void(const std::error_code& ec)>& fn)
     {
-        std::stringstream ss;
         acquire_lock();
         HttpRequest& req = std::get<HttpRequest>(*this);
         // HttpRequest log_req = req;
@@ -110,16 +145,15 @@ namespace http{
         // log_req.next_header = 0;
         // log_req.next_chunk = 0;
         // std::cerr << "http-session.cpp:95:log_req=" << log_req << ",req_next_header=" << req.next_header << ",req_next_chunk=" << req.next_chunk << std::endl;
-        ss << req;
+        std::shared_ptr<WriteBuffer<HttpRequest> > wb = detach(req);
         req.http_request_line_complete = true;
         req.next_header = req.headers.size();
         req.next_chunk = req.chunks.size();
-        std::string data_buf(ss.str());
         
         auto self = shared_from_this();
         t_session_->async_write(
-            boost::asio::const_buffer(data_buf.data(), data_buf.size()),
-            [&, fn, self](const std::error_code& ec){
+            wb->bufs,
+            [&, fn, self, wb](const std::error_code& ec){
                 fn(ec);
             }
         );
@@ -128,13 +162,14 @@ namespace http{
     
     void HttpClientSession::write(const HttpReqRes& req_res, const std::function<void(const std::error_code& ec)>& fn)
     {
-        std::stringstream ss;
-        ss << std::get<HttpRequest>(req_res);
-        std::string data_buf(ss.str());
-
+        std::shared_ptr<WriteBuffer<HttpRequest> > wb = std::make_shared<WriteBuffer<HttpRequest> >();
+        wb->msg = std::get<HttpRequest>(req_res);
+        wb->gather();
         t_session_->async_write(
-            boost::asio::const_buffer(data_buf.data(), data_buf.size()),
-            fn
+            wb->bufs,
+            [fn, wb](const std::error_code& ec){
+                fn(ec);
+            }
         );
     }
 
@@ -5,15 +5,61 @@
 namespace app_server{
     // The application server is a container for managing
     // application sessions.
+    // Sessions are added with push_back, which records the slot of the session in the server and binds the session
+    // to its transport session. Sessions can then be found from their transport session, and removed, without a search.
     template<class... Types>
     class Server: public std::vector<std::shared_ptr<Session<Types...> > >, public std::enable_shared_from_this<Server<Types...> >
     {
     public:
-        Server(): std::vector<std::shared_ptr<Session<Types...> > >() {}
+        typedef std::vector<std::shared_ptr<Session<Types...> > > sessions;
+
+        Server(): sessions() {}
         void acquire(){ mtx_.lock(); return; }
         void release(){ mtx_.unlock(); return; }
+
+        void push_back(const std::shared_ptr<Session<Types...> >& session){
+            session->slot_ = this->size();
+            sessions::push_back(session);
+            if(session->transport()){
+                session->transport()->bind(this, session);
+            }
+            return;
+        }
+
+        // Removes the session by moving the last session into its slot.
+        void rm(const std::shared_ptr<Session<Types...> >& session){
+            acquire();
+            std::size_t slot = session->slot_;
+            if(contains(session)){
+                if(slot != this->size() - 1){
+                    std::swap((*this)[slot], this->back());
+                    (*this)[slot]->slot_ = slot;
+                }
+                this->pop_back();
+            }
+            release();
+            return;
+        }
+
+        // Returns the session of this server that presents the transport session, or nullptr.
+        std::shared_ptr<Session<Types...> > find(const std::shared_ptr<server::Session>& t_session){
+            if(!t_session || t_session->app_server() != this){
+                return nullptr;
+            }
+            std::shared_ptr<Session<Types...> > session = std::static_pointer_cast<Session<Types...> >(t_session->app_session());
+            acquire();
+            if(session && !contains(session)){
+                session.reset();
+            }
+            release();
+            return session;
+        }
+
         virtual ~Server() = default;
     private:
+        bool contains(const std::shared_ptr<Session<Types...> >& session){
+            return (session->slot_ < this->size() && (*this)[session->slot_] == session);
+        }
         std::mutex mtx_;
     };
 }//namespace app_server
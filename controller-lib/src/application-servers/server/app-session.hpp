@@ -29,17 +29,12 @@ namespace app_server{
         Session(Server<Types...>& server): server_(server) {}
         Session(Server<Types...>& server, const std::shared_ptr<server::Session>& t_session_ptr): t_session_(t_session_ptr), server_(server) {}
         void erase(){
-            server_.acquire();
             try{
-                auto it = std::find(server_.begin(), server_.end(), this->shared_from_this());
-                if(it != server_.end()){
-                    server_.erase(it);
-                }
+                server_.rm(this->shared_from_this());
             } catch(std::bad_weak_ptr& e){
-                std::cerr << "app-session.hpp:36:shared_from_this() failed:" << e.what() << std::endl;
+                std::cerr << "app-session.hpp:35:shared_from_this() failed:" << e.what() << std::endl;
                 throw e;
             }
-            server_.release();
             return;
         }
 
@@ -66,7 +61,10 @@ namespace app_server{
         void release_lock(){ mtx_.unlock(); return;}
 
     private:
+        friend class Server<Types...>;
         Server<Types...>& server_;
+        // The index of the session in its server. It is only valid while the session is in the server.
+        std::size_t slot_ = 0;
         std::mutex mtx_;
     };
 }//namespace app_server
@@ -1,5 +1,6 @@
 #include "../tests/uuid/uuid-tests.hpp"
 #include "../tests/transport-servers/unix-server/server-tests.hpp"
+#include "../tests/transport-servers/server/chain-stream-tests.hpp"
 #include "../tests/application-servers/http/http-requests-tests.hpp"
 #include "../tests/application-servers/http/http-server-tests.hpp"
 #include "../tests/transport-servers/sctp-server/sctp-server-tests.hpp"
@@ -241,6 +242,99 @@ int main(int argc, char* argv[]){
     //         ++test_num;
     //     }
     // }
+    {
+        // Chain stream tests.
+        using namespace tests;
+        std::size_t test_num = 1;
+        {
+            ChainStreamTest test_borrow(ChainStreamTest::test_borrow);
+            if(test_borrow){
+                std::cout << "Chain stream test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Chain stream test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+        {
+            ChainStreamTest test_append(ChainStreamTest::test_append);
+            if(test_append){
+                std::cout << "Chain stream test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Chain stream test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+        {
+            ChainStreamTest test_extract_request(ChainStreamTest::test_extract_request);
+            if(test_extract_request){
+                std::cout << "Chain stream test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Chain stream test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    {
+        // Http request parsing tests.
+        using namespace tests;
+        std::size_t test_num = 1;
+        {
+            HttpRequestsTests test_parse_buffer(HttpRequestsTests::test_parse_buffer);
+            if(test_parse_buffer){
+                std::cout << "Http request test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Http request test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    {
+        // Http server session lookup tests.
+        using namespace tests;
+        std::size_t test_num = 1;
+        {
+            HttpServerTests test_find_session(HttpServerTests::test_find_session);
+            if(test_find_session){
+                std::cout << "Http server test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Http server test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    {
+        // UNIX socket adoption tests.
+        using namespace tests;
+        boost::asio::io_context ioc;
+        std::filesystem::path p("/run/controller/controller.sock");
+        std::size_t test_num = 1;
+        boost::asio::local::stream_protocol::endpoint endpoint(p.string());
+        {
+            UnixServerTest test_adopt_unix(UnixServerTest::test_adopt_unix, ioc, endpoint);
+            if(test_adopt_unix){
+                std::cout << "Unix server test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "Unix server test " << test_num << " failed." << std::endl;
+            }
+            std::filesystem::remove(p);
+            ioc.restart();
+            ++test_num;
+        }
+    }
+    {
+        // Http chunk parsing benchmarks.
+        using namespace tests;
+        std::size_t test_num = 1;
+        for(std::size_t chunk_size: {22, 1024}){
+            HttpRequestsTests bench_parse_chunks(HttpRequestsTests::bench_parse_chunks, chunk_size);
+            if(bench_parse_chunks){
+                std::cout << "Http request benchmark " << test_num << " passed:chunk size=" << chunk_size << ":" << bench_parse_chunks.ns_per_chunk() << "ns/chunk" << std::endl;
+            } else {
+                std::cerr << "Http request benchmark " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
     {
         std::size_t test_num = 1;
         {
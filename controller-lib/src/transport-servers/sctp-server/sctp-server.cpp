@@ -111,9 +111,7 @@ namespace sctp_transport{
     }
 
     void SctpServer::stop(){
-        acquire();
         clear();
-        release();
     }
 
     void SctpServer::async_connect(server::Remote rmt, std::function<void(const boost::system::error_code&, const std::shared_ptr<server::Session>&)> fn){
@@ -186,7 +184,7 @@ namespace sctp_transport{
                                                 }
                                                 session->set(paddrinfo.spinfo_assoc_id);
                                                 acquire();
-                                                push_back(session);
+                                                push_back_session(session);
                                                 release();
                                                 fn(error, session);
                                                 erase_pending_connect(session);
@@ -253,7 +251,7 @@ namespace sctp_transport{
                     next_stream_num_
                 };
                 session = std::make_shared<sctp_transport::SctpSession>(*this, stream, socket_);
-                push_back(session);
+                push_back_session(session);
             }
             release();
             fn(err, session);
@@ -347,7 +345,7 @@ namespace sctp_transport{
                                         /* This is a pending connection */
                                         const std::shared_ptr<SctpSession>& sctp_session = std::static_pointer_cast<SctpSession>(it->session);
                                         sctp_session->set(association);
-                                        push_back(sctp_session);
+                                        push_back_session(sctp_session);
                                         it->cb(error, sctp_session);
                                         pending_connects_.erase(it);
                                         it = std::find_if(pending_connects_.begin(), pending_connects_.end(), [&](auto& pending_connection){
@@ -386,9 +384,9 @@ namespace sctp_transport{
                                     return assoc == association;
                                 });
                                 while(session_it != end()){
-                                    auto& sp = *session_it;
+                                    auto sp = *session_it;
                                     sp->cancel();
-                                    erase(session_it);
+                                    erase_session(sp);
                                     session_it = std::find_if(begin(), end(), [&](auto& sp){
                                         auto assoc = std::static_pointer_cast<SctpSession>(sp)->get_assoc();
                                         return assoc == association;
@@ -420,9 +418,9 @@ namespace sctp_transport{
                                     return assoc == association;
                                 });
                                 while(session_it != end()){
-                                    auto& sp = *session_it;
+                                    auto sp = *session_it;
                                     sp->cancel();
-                                    erase(session_it);
+                                    erase_session(sp);
                                     session_it = std::find_if(begin(), end(), [&](auto& sp){
                                         auto assoc = std::static_pointer_cast<SctpSession>(sp)->get_assoc();
                                         return assoc == association;
@@ -458,9 +456,9 @@ namespace sctp_transport{
                                     return assoc == association;
                                 });
                                 while(session_it != end()){
-                                    auto& sp = *session_it;
+                                    auto sp = *session_it;
                                     sp->cancel();
-                                    erase(session_it);
+                                    erase_session(sp);
                                     session_it = std::find_if(begin(), end(), [&](auto& sp){
                                         auto assoc = std::static_pointer_cast<SctpSession>(sp)->get_assoc();
                                         return assoc == association;
@@ -529,7 +527,7 @@ namespace sctp_transport{
                 if(it == end()){
                     // Create a new session.
                     sctp_session = std::make_shared<sctp_transport::SctpSession>(*this, stream_id, socket_);
-                    push_back(sctp_session);
+                    push_back_session(sctp_session);
                     // Accept and return a new context (similar to the berkeley sockets accept call.)
                 } else {
                     sctp_session = std::static_pointer_cast<sctp_transport::SctpSession>(*it);
@@ -1,16 +1,40 @@
 #include "sctp-session.hpp"
 #include <iostream>
+#include <climits>
+#include <algorithm>
 
 namespace sctp_transport{
+    namespace {
+        std::string to_string(const std::vector<boost::asio::const_buffer>& bufs){
+            std::string value;
+            for(const boost::asio::const_buffer& buf: bufs){
+                value.append(static_cast<const char*>(buf.data()), buf.size());
+            }
+            return value;
+        }
+    }
+
     void SctpSession::async_read(std::function<void(boost::system::error_code ec, std::size_t length)>){
         return;
         // read_fn_ = std::move(fn);
     }
 
     void SctpSession::async_write(const boost::asio::const_buffer& write_buffer, const std::function<void(const std::error_code& ec)>& fn) {
-        auto self = shared_from_this();
+        // The write buffer is copied, and the copy is held until the write completes.
         std::shared_ptr<std::vector<char> > write_data_ptr = std::make_shared<std::vector<char> >(write_buffer.size());
         std::memcpy(write_data_ptr->data(), write_buffer.data(), write_buffer.size());
+        std::vector<boost::asio::const_buffer> write_buffers{boost::asio::const_buffer(write_data_ptr->data(), write_data_ptr->size())};
+        async_write(
+            write_buffers,
+            [write_data_ptr, fn](const std::error_code& ec){
+                fn(ec);
+            }
+        );
+    }
+
+    void SctpSession::async_write(const std::vector<boost::asio::const_buffer>& write_buffers, const std::function<void(const std::error_code& ec)>& fn) {
+        auto self = shared_from_this();
+        std::shared_ptr<std::vector<boost::asio::const_buffer> > write_data_ptr = std::make_shared<std::vector<boost::asio::const_buffer> >(write_buffers);
         socket_.async_wait(
             transport::protocols::sctp::socket::wait_type::wait_write,
             boost::asio::bind_cancellation_slot(
@@ -27,7 +51,7 @@ namespace sctp_transport{
         );
     }
 
-    void SctpSession::write_(std::shared_ptr<std::vector<char> > write_data, const std::function<void(const std::error_code& ec)> fn, const boost::system::error_code& ec){
+    void SctpSession::write_(std::shared_ptr<std::vector<boost::asio::const_buffer> > write_data, const std::function<void(const std::error_code& ec)> fn, const boost::system::error_code& ec){
         if(!ec){
             using namespace transport::protocols;
             static constexpr std::size_t MAX_BUF_SZ = 131071; // 128KB         
@@ -76,14 +100,12 @@ namespace sctp_transport{
                 case SCTP_COOKIE_WAIT:
                 {
                     // std::cerr << "sctp-session.cpp:54:SCTP_COOKIE_WAIT" << std::endl;
-                    boost::asio::const_buffer buf(write_data->data(), write_data->size());
-                    return async_write(buf, fn);
+                    return async_write(*write_data, fn);
                 }
                 case SCTP_COOKIE_ECHOED:
                 {
                     // std::cerr << "sctp-session.cpp:64:SCTP_COOKIE_ECHOED" << std::endl;
-                    boost::asio::const_buffer buf(write_data->data(), write_data->size());
-                    return async_write(buf, fn);               
+                    return async_write(*write_data, fn);
                 }
                 case SCTP_ESTABLISHED:
                     break;
@@ -141,16 +163,31 @@ namespace sctp_transport{
             cmsg->cmsg_type = SCTP_SNDINFO;
             cmsg->cmsg_len = CMSG_LEN(sizeof(sndinfo));
             std::memcpy(CMSG_DATA(cmsg), &sndinfo, sizeof(sndinfo));
-            std::size_t remaining_bytes = write_data->size();
-            int len = 0;
+            std::size_t remaining_bytes = 0;
+            for(const boost::asio::const_buffer& buf: *write_data){
+                remaining_bytes += buf.size();
+            }
+            // Each message gathers up to MAX_BUF_SZ bytes from the write buffers,
+            // starting at offset bytes into the buffer at next.
+            std::vector<sctp::iov> msgbufs;
+            auto next = write_data->begin();
+            std::size_t offset = 0;
+            ssize_t len = 0;
             if(remaining_bytes > 0){
                 do{
-                    sctp::iov msgbuf = {
-                        write_data->data() + (write_data->size() - remaining_bytes),
-                        (remaining_bytes > MAX_BUF_SZ) ? MAX_BUF_SZ : remaining_bytes
-                    };
-                    msg.msg_iov = &msgbuf;
-                    msg.msg_iovlen = 1;
+                    msgbufs.clear();
+                    std::size_t msglen = 0;
+                    std::size_t buf_offset = offset;
+                    for(auto it = next; it != write_data->end() && msglen < MAX_BUF_SZ && msgbufs.size() < static_cast<std::size_t>(IOV_MAX); ++it){
+                        std::size_t buflen = std::min(it->size() - buf_offset, MAX_BUF_SZ - msglen);
+                        if(buflen > 0){
+                            msgbufs.push_back(sctp::iov{const_cast<char*>(static_cast<const char*>(it->data())) + buf_offset, buflen});
+                            msglen += buflen;
+                        }
+                        buf_offset = 0;
+                    }
+                    msg.msg_iov = msgbufs.data();
+                    msg.msg_iovlen = msgbufs.size();
                     len = sendmsg(socket_.native_handle(), &msg, MSG_NOSIGNAL);
                     if(len == -1){
                         switch(errno)
@@ -177,7 +214,7 @@ namespace sctp_transport{
                             case EINVAL:
                             {
                                 std::cerr << "sctp-session.cpp:180:sendmsg failed with code EINVAL:"
-                                    << "Message:" << std::string(write_data->begin(), write_data->end()) 
+                                    << "Message:" << to_string(*write_data)
                                     << ":Assoc ID:" << id_.assoc
                                     << ":Stream ID:" << id_.sid
                                     << std::endl;
@@ -205,6 +242,13 @@ namespace sctp_transport{
                         }
                     }
                     remaining_bytes -= len;
+                    // Advance past the bytes that were sent.
+                    std::size_t sent = len + offset;
+                    while(next != write_data->end() && sent >= next->size() && remaining_bytes > 0){
+                        sent -= next->size();
+                        ++next;
+                    }
+                    offset = sent;
                 } while(remaining_bytes > 0);
             }
             std::error_code err;
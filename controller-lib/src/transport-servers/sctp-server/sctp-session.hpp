@@ -16,6 +16,7 @@ namespace sctp_transport{
         void read(const boost::system::error_code& ec, const std::string& received_data);
         void async_read(std::function<void(boost::system::error_code ec, std::size_t length)>) override;
         void async_write(const boost::asio::const_buffer&, const std::function<void(const std::error_code& ec)>&) override;
+        void async_write(const std::vector<boost::asio::const_buffer>&, const std::function<void(const std::error_code& ec)>&) override;
         void close() override;
 
         void set(const transport::protocols::sctp::assoc_t& assoc_id ) { acquire(); id_.assoc = assoc_id; release(); return; }
@@ -31,7 +32,7 @@ namespace sctp_transport{
         bool operator!=(const transport::protocols::sctp::stream_t& stream);
     private:
         std::function<void(boost::system::error_code ec, std::size_t length)> read_fn_;
-        void write_(std::shared_ptr<std::vector<char> >, const std::function<void(const std::error_code& ec)>, const boost::system::error_code& ec);
+        void write_(std::shared_ptr<std::vector<boost::asio::const_buffer> >, const std::function<void(const std::error_code& ec)>, const boost::system::error_code& ec);
 
         boost::system::error_code read_ec_;
         std::size_t read_len_;
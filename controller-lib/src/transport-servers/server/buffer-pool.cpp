@@ -0,0 +1,44 @@
+#include "buffer-pool.hpp"
+
+namespace server
+{
+    BufferPool::State& BufferPool::state(){
+        static State* state = new State();
+        return *state;
+    }
+
+    BufferPool::Handle BufferPool::borrow(){
+        State& s = state();
+        std::unique_lock<std::mutex> lk(s.mtx);
+        if(s.free.empty()){
+            // The slab is default initialized, so its pages aren't touched until buffers are read into.
+            s.slabs.emplace_back(new ReceiveBuffer[SLAB_LENGTH]);
+            ReceiveBuffer* slab = s.slabs.back().get();
+            for(std::size_t i = SLAB_LENGTH; i > 0; --i){
+                s.free.push_back(slab + (i - 1));
+            }
+        }
+        ReceiveBuffer* buf = s.free.back();
+        s.free.pop_back();
+        return Handle(buf);
+    }
+
+    void BufferPool::release(ReceiveBuffer* buf){
+        State& s = state();
+        std::unique_lock<std::mutex> lk(s.mtx);
+        s.free.push_back(buf);
+        return;
+    }
+
+    std::size_t BufferPool::allocated(){
+        State& s = state();
+        std::unique_lock<std::mutex> lk(s.mtx);
+        return s.slabs.size()*SLAB_LENGTH;
+    }
+
+    std::size_t BufferPool::available(){
+        State& s = state();
+        std::unique_lock<std::mutex> lk(s.mtx);
+        return s.free.size();
+    }
+}
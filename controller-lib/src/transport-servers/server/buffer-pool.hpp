@@ -0,0 +1,45 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#define SERVER_SESSION_MAX_BUFLEN 65535
+
+namespace server
+{
+    typedef std::array<char, SERVER_SESSION_MAX_BUFLEN> ReceiveBuffer;
+
+    // The buffer pool lends receive buffers to sessions.
+    // Buffers are allocated in slabs, and are returned to a free list
+    // instead of being freed, so sessions only hold a receive buffer while 
+    // they are reading from the transport, or while the buffer holds bytes 
+    // that haven't been parsed yet.
+    class BufferPool
+    {
+    public:
+        struct Release
+        {
+            void operator()(ReceiveBuffer* buf) const { BufferPool::release(buf); }
+        };
+        typedef std::unique_ptr<ReceiveBuffer, Release> Handle;
+
+        static Handle borrow();
+        // The number of buffers allocated, and the number that are in the free list.
+        static std::size_t allocated();
+        static std::size_t available();
+
+    private:
+        static constexpr std::size_t SLAB_LENGTH = 8;
+        struct State
+        {
+            std::mutex mtx;
+            std::vector<std::unique_ptr<ReceiveBuffer[]> > slabs;
+            std::vector<ReceiveBuffer*> free;
+        };
+        // The pool state is never destroyed, so buffers can be returned after static destructors have run.
+        static State& state();
+        static void release(ReceiveBuffer* buf);
+    };
+}
+#endif
@@ -0,0 +1,106 @@
+#include "chain-stream.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace server
+{
+    void ChainBuf::append(BufferPool::Handle&& buf, std::size_t len){
+        if(len == 0){
+            return;
+        }
+        if(!segments_.empty() && len <= SERVER_SESSION_MAX_BUFLEN/16 && segments_.back().len + len <= SERVER_SESSION_MAX_BUFLEN){
+            xsputn(buf->data(), len);
+            return;
+        }
+        segments_.push_back(Segment{std::move(buf), len});
+        if(segments_.size() == 1){
+            char* data = segments_.front().buf->data();
+            setg(data, data, data + len);
+        }
+        return;
+    }
+
+    std::string ChainBuf::str() const {
+        std::string s(gptr(), egptr());
+        for(std::size_t i = 1; i < segments_.size(); ++i){
+            s.append(segments_[i].buf->data(), segments_[i].len);
+        }
+        return s;
+    }
+
+    void ChainBuf::clear(){
+        segments_.clear();
+        setg(nullptr, nullptr, nullptr);
+        return;
+    }
+
+    void ChainBuf::reclaim(){
+        // Return the receive buffers that have been read to the pool.
+        while(!segments_.empty() && gptr() == egptr()){
+            segments_.pop_front();
+            if(segments_.empty()){
+                setg(nullptr, nullptr, nullptr);
+            } else {
+                char* data = segments_.front().buf->data();
+                setg(data, data, data + segments_.front().len);
+            }
+        }
+        return;
+    }
+
+    ChainBuf::int_type ChainBuf::underflow(){
+        reclaim();
+        if(segments_.empty()){
+            return traits_type::eof();
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize ChainBuf::showmanyc(){
+        reclaim();
+        std::streamsize avail = egptr() - gptr();
+        for(std::size_t i = 1; i < segments_.size(); ++i){
+            avail += segments_[i].len;
+        }
+        return (avail > 0) ? avail : -1;
+    }
+
+    ChainBuf::int_type ChainBuf::overflow(int_type c){
+        if(traits_type::eq_int_type(c, traits_type::eof())){
+            return traits_type::not_eof(c);
+        }
+        char ch = traits_type::to_char_type(c);
+        xsputn(&ch, 1);
+        return c;
+    }
+
+    std::streamsize ChainBuf::xsputn(const char* s, std::streamsize n){
+        std::streamsize written = 0;
+        while(written < n){
+            if(segments_.empty() || segments_.back().len == SERVER_SESSION_MAX_BUFLEN){
+                segments_.push_back(Segment{BufferPool::borrow(), 0});
+                if(segments_.size() == 1){
+                    char* data = segments_.front().buf->data();
+                    setg(data, data, data);
+                }
+            }
+            Segment& tail = segments_.back();
+            std::size_t len = std::min<std::size_t>(n - written, SERVER_SESSION_MAX_BUFLEN - tail.len);
+            std::memcpy(tail.buf->data() + tail.len, s + written, len);
+            tail.len += len;
+            written += len;
+            if(segments_.size() == 1){
+                // Extend the get area over the bytes that were written into the first receive buffer.
+                setg(eback(), gptr(), tail.buf->data() + tail.len);
+            }
+        }
+        return written;
+    }
+
+    void ChainStream::str(const std::string& s){
+        buf_.clear();
+        std::iostream::clear();
+        write(s.data(), s.size());
+        return;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CHAIN_STREAM_HPP
+#define CHAIN_STREAM_HPP
+#include <deque>
+#include <istream>
+#include <string>
+#include "buffer-pool.hpp"
+
+namespace server
+{
+    // The chain buffer is a stream buffer over a chain of pooled receive buffers.
+    // The get area is the unread part of the first receive buffer in the chain, 
+    // and receive buffers are returned to the pool as soon as they have been read.
+    class ChainBuf: public std::streambuf
+    {
+    public:
+        ChainBuf() = default;
+        ChainBuf(const ChainBuf&) = delete;
+        ChainBuf& operator=(const ChainBuf&) = delete;
+
+        // Appends the first len bytes of a receive buffer to the chain without copying them.
+        // Short reads are copied into the space at the end of the chain instead, 
+        // so that small messages don't each hold a whole receive buffer.
+        void append(BufferPool::Handle&& buf, std::size_t len);
+        // Returns the unread bytes.
+        std::string str() const;
+        void clear();
+
+    protected:
+        int_type underflow() override;
+        std::streamsize showmanyc() override;
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+    private:
+        struct Segment
+        {
+            BufferPool::Handle buf;
+            std::size_t len;
+        };
+        std::deque<Segment> segments_;
+        void reclaim();
+    };
+
+    // The chain stream is a drop in replacement for the std::stringstream that sessions 
+    // used to buffer their input.
+    class ChainStream: public std::iostream
+    {
+    public:
+        ChainStream(): std::iostream(&buf_) {}
+
+        void append(BufferPool::Handle&& buf, std::size_t len) { buf_.append(std::move(buf), len); }
+        std::string str() const { return buf_.str(); }
+        void str(const std::string& s);
+
+    private:
+        ChainBuf buf_;
+    };
+}
+#endif
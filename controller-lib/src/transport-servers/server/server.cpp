@@ -8,23 +8,49 @@ namespace server{
         return;
     }
 
+    void Server::push_back(const std::shared_ptr<Session>& session){
+        acquire();
+        push_back_session(session);
+        release();
+        return;
+    }
+
     void Server::rm(const std::shared_ptr<Session>& session){
         acquire();
-        auto it = std::find(cbegin(), cend(), session);
-        if(it != cend()){
-            erase(it);
-        }
+        erase_session(session);
         release();
         return;
     }
 
-    bool Server::has(const std::shared_ptr<Session>& session){
-        bool is_present = false;
+    void Server::clear(){
         acquire();
-        auto it = std::find(cbegin(), cend(), session);
-        if(it != cend()){
-            is_present = true;
+        sessions::clear();
+        release();
+        return;
+    }
+
+    void Server::push_back_session(const std::shared_ptr<Session>& session){
+        session->slot_ = size();
+        sessions::push_back(session);
+        return;
+    }
+
+    void Server::erase_session(const std::shared_ptr<Session>& session){
+        std::size_t slot = session->slot_;
+        if(slot < size() && (*this)[slot] == session){
+            if(slot != size() - 1){
+                std::swap((*this)[slot], back());
+                (*this)[slot]->slot_ = slot;
+            }
+            pop_back();
         }
+        return;
+    }
+
+    bool Server::has(const std::shared_ptr<Session>& session){
+        acquire();
+        std::size_t slot = session->slot_;
+        bool is_present = (slot < size() && (*this)[slot] == session);
         release();
         return is_present;
     }
@@ -42,14 +42,27 @@ namespace server
     // each unique stream as a Session.
     // Servers track the number of unique sessions, and maintain
     // the lifetime of sessions.
-    class Server: public std::vector<std::shared_ptr<Session> >, public std::enable_shared_from_this<Server>
+    // Sessions are added with push_back, which records the slot of the session in the server, so that
+    // rm and has don't search. rm moves the last session into the slot that it frees. The session table
+    // is privately inherited so that sessions can't be inserted or erased around the slots.
+    class Server: private std::vector<std::shared_ptr<Session> >, public std::enable_shared_from_this<Server>
     {
+        typedef std::vector<std::shared_ptr<Session> > sessions;
     public:
+        using sessions::begin;
+        using sessions::end;
+        using sessions::size;
+        using sessions::empty;
+        using sessions::front;
+        using sessions::back;
+
         // Server constructors accept an asio io_context.
         Server(boost::asio::io_context& ioc): ioc_(ioc){}
         void run();
+        void push_back(const std::shared_ptr<Session>& session);
         void rm(const std::shared_ptr<Session>&);
         bool has(const std::shared_ptr<Session>&);
+        void clear();
 
         // Servers must implement a connect interface that returns a client 
         // session.
@@ -60,6 +73,10 @@ namespace server
     protected:
         void acquire(){ mtx_.lock(); return; }
         void release(){ mtx_.unlock(); return; }
+        // push_back and rm for callers that already hold the lock.
+        void push_back_session(const std::shared_ptr<Session>& session);
+        void erase_session(const std::shared_ptr<Session>& session);
+        using sessions::operator[];
         boost::asio::io_context& ioc_;
     private:
         std::mutex mtx_;
@@ -3,7 +3,9 @@
 #include <system_error>
 #include <boost/asio.hpp>
 #include <functional>
-#define SERVER_SESSION_MAX_BUFLEN 65535
+#include <vector>
+#include "buffer-pool.hpp"
+#include "chain-stream.hpp"
 
 // Transport layer is dependent on boost/asio.
 namespace server
@@ -22,12 +24,21 @@ namespace server
     {
     public:
         // const static std::size_t max_buflen = 65536;
-        Session(Server& server): server_(server), stream_(std::ios_base::in | std::ios_base::out | std::ios_base::app){}
-        std::array<char, SERVER_SESSION_MAX_BUFLEN>& buf() { return buf_; }
+        Session(Server& server): server_(server) {}
+        // The receive buffer is borrowed from the buffer pool while the session is reading.
+        ReceiveBuffer& buf() { if(!buf_){ buf_ = BufferPool::borrow(); } return *buf_; }
+        void release_buf() { buf_.reset(); }
         boost::asio::const_buffer& read_buf() { return data_; }
-        std::stringstream& acquire_stream(){ mtx_.lock(); return stream_; }
+        ChainStream& acquire_stream(){ mtx_.lock(); return stream_; }
         void release_stream(){ mtx_.unlock(); }
+        // Moves the first len bytes of the receive buffer onto the end of the stream.
+        void commit_buf(std::size_t len){ mtx_.lock(); stream_.append(std::move(buf_), len); mtx_.unlock(); }
         bool is_in_server();
+        // Application sessions bind themselves to the transport session that they present, so that the application
+        // session of a transport session can be found without searching the application server.
+        void bind(const void* app_server, const std::weak_ptr<void>& app_session){ app_server_ = app_server; app_session_ = app_session; }
+        const void* app_server() const { return app_server_; }
+        std::shared_ptr<void> app_session() const { return app_session_.lock(); }
         void cancel() { 
             stop_signal_.emit(boost::asio::cancellation_type::total);
         }
@@ -35,6 +46,9 @@ namespace server
 
         virtual void async_read(std::function<void(boost::system::error_code ec, std::size_t length)> fn) =0;
         virtual void async_write(const boost::asio::const_buffer& write_buffer, const std::function<void(const std::error_code& ec)>& fn) =0;
+        // Gathered writes send the buffers in order without copying them.
+        // The buffers must stay valid until fn is called.
+        virtual void async_write(const std::vector<boost::asio::const_buffer>& write_buffers, const std::function<void(const std::error_code& ec)>& fn) =0;
         virtual void close() =0;
 
         bool operator==(const Session& other) { return this == &other; }
@@ -47,10 +61,15 @@ namespace server
         void release() { mtx_.unlock(); return; }
 
     private:
+        friend class Server;
         server::Server& server_;
+        // The index of the session in its server. It is only valid while the session is in the server.
+        std::size_t slot_ = 0;
+        const void* app_server_ = nullptr;
+        std::weak_ptr<void> app_session_;
         boost::asio::const_buffer data_;
-        std::array<char, SERVER_SESSION_MAX_BUFLEN> buf_;
-        std::stringstream stream_;
+        BufferPool::Handle buf_;
+        ChainStream stream_;
         std::mutex mtx_;
     };
 }
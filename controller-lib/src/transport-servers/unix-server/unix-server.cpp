@@ -1,25 +1,49 @@
 #include "unix-server.hpp"
 #include <filesystem>
+#include <unistd.h>
 
 #ifdef DEBUG
 #include <sys/wait.h>
 #endif
 
 namespace UnixServer{
+    namespace {
+        std::string to_string(const std::vector<boost::asio::const_buffer>& bufs){
+            std::string value;
+            for(const boost::asio::const_buffer& buf: bufs){
+                value.append(static_cast<const char*>(buf.data()), buf.size());
+            }
+            return value;
+        }
+    }
+
     void unix_session::async_read(std::function<void(boost::system::error_code ec, std::size_t length)> fn){
-        socket_.async_read_some(
-            boost::asio::buffer(buf().data(), SERVER_SESSION_MAX_BUFLEN),
+        // Wait for the socket to become readable before borrowing a receive buffer,
+        // so that idle sessions don't hold one.
+        socket_.async_wait(
+            boost::asio::local::stream_protocol::socket::wait_type::wait_read,
             boost::asio::bind_cancellation_slot(
                 stop_signal_.slot(),
-                [&,fn](boost::system::error_code ec, std::size_t length){
+                [&,fn](boost::system::error_code ec){
+                    std::size_t length = 0;
+                    if(!ec){
+                        length = socket_.read_some(boost::asio::buffer(buf().data(), buf().size()), ec);
+                        if(ec == boost::asio::error::would_block){
+                            release_buf();
+                            async_read(fn);
+                            return;
+                        }
+                    }
                     fn(ec, length);
+                    // Return the receive buffer to the pool, unless the callback has committed it to the stream.
+                    release_buf();
                     if(!ec){
                         async_read(fn);
                     } else {
                         if(ec == boost::asio::error::misc_errors::eof){
                             return;
                         } else {
-                            std::cerr << "unix-server.cpp:18:async_read_some error:" << ec.message() << std::endl;
+                            std::cerr << "unix-server.cpp:46:async_read_some error:" << ec.message() << std::endl;
                             async_read(fn);
                         }
                     }
@@ -30,23 +54,41 @@ namespace UnixServer{
     }
 
     void unix_session::async_write(const boost::asio::const_buffer& write_buffer, const std::function<void(const std::error_code& ec)>& fn){
+        // The write buffer is copied, and the copy is held until the write completes.
+        std::shared_ptr<std::vector<char> > write_data_ptr = std::make_shared<std::vector<char> >(write_buffer.size());
+        std::memcpy(write_data_ptr->data(), write_buffer.data(), write_data_ptr->size());
+        std::vector<boost::asio::const_buffer> write_buffers{boost::asio::const_buffer(write_data_ptr->data(), write_data_ptr->size())};
+        async_write(
+            write_buffers,
+            [write_data_ptr, fn](const std::error_code& ec){
+                fn(ec);
+            }
+        );
+    }
+
+    void unix_session::async_write(const std::vector<boost::asio::const_buffer>& write_buffers, const std::function<void(const std::error_code& ec)>& fn){
         #ifdef DEBUG
         struct timespec ts = {0,0};
         #endif
-        std::shared_ptr<std::vector<char> > write_data_ptr = std::make_shared<std::vector<char> >(write_buffer.size());
-        std::memcpy(write_data_ptr->data(), write_buffer.data(), write_data_ptr->size());
-        boost::asio::const_buffer buf(write_data_ptr->data(), write_data_ptr->size());
+        std::shared_ptr<std::vector<boost::asio::const_buffer> > bufs = std::make_shared<std::vector<boost::asio::const_buffer> >(write_buffers);
         auto self = shared_from_this();
         socket_.async_write_some(
-            buf,
-            [&, buf, write_data_ptr, fn, self](const boost::system::error_code& ec, std::size_t bytes_transferred){
+            *bufs,
+            [&, bufs, fn, self](const boost::system::error_code& ec, std::size_t bytes_transferred){
                 if (!ec){
                     #ifdef DEBUG
-                    clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "unix-server.cpp:39:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":WRITE_UNIX_SOCKET_DATA:" << std::string((const char*)buf.data(), buf.size()) << std::endl;
+                    clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "unix-server.cpp:80:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":WRITE_UNIX_SOCKET_DATA:" << to_string(*bufs) << std::endl;
                     #endif
-                    std::size_t remaining_bytes = write_data_ptr->size() - bytes_transferred;
-                    if ( remaining_bytes > 0 ){
-                        async_write(buf + bytes_transferred, fn);
+                    // Drop the buffers that were written completely, and advance into the buffer that was written partially.
+                    auto it = bufs->begin();
+                    while(it != bufs->end() && bytes_transferred >= it->size()){
+                        bytes_transferred -= it->size();
+                        ++it;
+                    }
+                    bufs->erase(bufs->begin(), it);
+                    if ( !bufs->empty() ){
+                        bufs->front() += bytes_transferred;
+                        async_write(*bufs, fn);
                     } else {
                         // Once the write is complete execute the completion
                         // handler.
@@ -54,23 +96,23 @@ namespace UnixServer{
                         fn(err);
                     }
                 } else if (ec == boost::asio::error::would_block){
-                    async_write(buf,fn);
+                    async_write(*bufs,fn);
                 } else if (ec == boost::asio::error::broken_pipe){
                     /* I'm not sure that this is recoverable since it is likely caused by an NGINX gateway timeout.*/
                     throw boost::asio::error::broken_pipe;
                 } else {
-                    std::error_code err(ec.value(), std::system_category());
+                    std::string value = to_string(*bufs);
                     struct timespec ts = {};
                     int status = clock_gettime(CLOCK_REALTIME, &ts);
                     if(status == -1){
-                        std::cerr << "unix-server.cpp:41:clock_gettime error:" << std::make_error_code(std::errc(errno)).message() << std::endl;
-                        std::cerr << "unix-server.cpp:42:unix socket write error:" << ec.message() << \
-                            ":value=" << std::string(write_data_ptr->begin(), write_data_ptr->end()) << \
-                            ",len=" << write_data_ptr->size() << std::endl;
+                        std::cerr << "unix-server.cpp:108:clock_gettime error:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        std::cerr << "unix-server.cpp:109:unix socket write error:" << ec.message() << \
+                            ":value=" << value << \
+                            ",len=" << value.size() << std::endl;
                     } else {
-                        std::cerr << "unix-server.cpp:44:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":unix socket write error:" << ec.message() \
-                            << ":value=" << std::string(write_data_ptr->begin(), write_data_ptr->end()) \
-                            << ",len=" << write_data_ptr->size() << std::endl;
+                        std::cerr << "unix-server.cpp:113:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":unix socket write error:" << ec.message() \
+                            << ":value=" << value \
+                            << ",len=" << value.size() << std::endl;
                     }
                 }
             }
@@ -91,15 +133,28 @@ namespace UnixServer{
     unix_server::unix_server(boost::asio::io_context& ioc)
       : server::Server(ioc),
         endpoint_("/run/controller/controller.sock"),
-        acceptor_(ioc, endpoint_)
+        acceptor_(ioc, endpoint_),
+        listening_{true}
     {}
 
     unix_server::unix_server(boost::asio::io_context& ioc, const boost::asio::local::stream_protocol::endpoint& endpoint)
       : server::Server(ioc),
         endpoint_(endpoint),
-        acceptor_(ioc, endpoint)
+        acceptor_(ioc, endpoint),
+        listening_{true}
     {}
 
+    unix_server::unix_server(boost::asio::io_context& ioc, const boost::asio::local::stream_protocol::endpoint& endpoint, bool listen)
+      : server::Server(ioc),
+        endpoint_(endpoint),
+        acceptor_(ioc),
+        listening_{listen}
+    {
+        if(listening_){
+            acceptor_ = boost::asio::local::stream_protocol::acceptor(ioc, endpoint_);
+        }
+    }
+
     void unix_server::async_connect(server::Remote rmt, std::function<void(const boost::system::error_code&, const std::shared_ptr<server::Session>&)> fn) {
         boost::asio::local::stream_protocol::socket sock(ioc_,boost::asio::local::stream_protocol());
         const char* path = rmt.unix_addr.address.sun_path;
@@ -127,9 +182,38 @@ namespace UnixServer{
         });
     }
 
+    void unix_server::accept_native(std::function<void(const boost::system::error_code& ec, int fd)> fn){
+        acceptor_.async_accept([&, fn](const boost::system::error_code& ec, boost::asio::local::stream_protocol::socket socket){
+            if(!ec){
+                boost::system::error_code err;
+                int fd = socket.release(err);
+                fn(err, fd);
+                accept_native(fn);
+            } else {
+                std::cerr << ec.message() << std::endl;
+            }
+        });
+    }
+
+    std::shared_ptr<unix_session> unix_server::adopt(int fd){
+        boost::asio::local::stream_protocol::socket socket(ioc_);
+        boost::system::error_code ec;
+        socket.assign(boost::asio::local::stream_protocol(), fd, ec);
+        if(ec){
+            std::cerr << "unix-server.cpp:162:assigning the adopted socket failed with:" << ec.message() << std::endl;
+            close(fd);
+            return std::shared_ptr<unix_session>();
+        }
+        std::shared_ptr<unix_session> session = std::make_shared<unix_session>(std::move(socket), *this);
+        push_back(session);
+        return session;
+    }
+
     unix_server::~unix_server(){
         clear();
-        std::filesystem::path p(endpoint_.path());
-        std::filesystem::remove(p);
+        if(listening_){
+            std::filesystem::path p(endpoint_.path());
+            std::filesystem::remove(p);
+        }
     }
 }// Unix Server Namespace
\ No newline at end of file
@@ -27,6 +27,7 @@ namespace UnixServer{
         }
         void async_read(std::function<void(boost::system::error_code ec, std::size_t length)> fn) override;
         void async_write(const boost::asio::const_buffer& write_buffer, const std::function<void(const std::error_code& ec)>& fn) override;
+        void async_write(const std::vector<boost::asio::const_buffer>& write_buffers, const std::function<void(const std::error_code& ec)>& fn) override;
         void close() override;
 
         void async_connect(const boost::asio::local::stream_protocol::endpoint&, std::function<void(const boost::system::error_code&)>);
@@ -57,16 +58,23 @@ namespace UnixServer{
     public:
         unix_server(boost::asio::io_context& ioc);
         unix_server(boost::asio::io_context& ioc, const boost::asio::local::stream_protocol::endpoint& endpoint);
+        // Servers that are constructed with listen=false don't bind the endpoint, and only serve adopted connections.
+        unix_server(boost::asio::io_context& ioc, const boost::asio::local::stream_protocol::endpoint& endpoint, bool listen);
 
         void async_connect(server::Remote addr, std::function<void(const boost::system::error_code&, const std::shared_ptr<server::Session>&)> fn) override;
 
         void accept(std::function<void(const boost::system::error_code& ec, std::shared_ptr<UnixServer::unix_session> session)> fn);
+        // Accepts connections without creating sessions for them, so that they can be handed to another server.
+        void accept_native(std::function<void(const boost::system::error_code& ec, int fd)> fn);
+        // Creates a session on this server's io_context for a connected socket that was accepted elsewhere.
+        std::shared_ptr<UnixServer::unix_session> adopt(int fd);
         void stop() { acceptor_.close(); return; }
         ~unix_server();
             
     private:
         boost::asio::local::stream_protocol::endpoint endpoint_;
         boost::asio::local::stream_protocol::acceptor acceptor_;
+        bool listening_;
     };
 }//Namespace UnixServer
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <charconv>
 #include <sstream>
 #include <limits>
+#include <algorithm>
+#include <chrono>
 namespace tests
 {
     HttpRequestsTests::HttpRequestsTests(HttpRequestsTests::ReadChunk)
@@ -204,7 +206,7 @@ namespace tests
             return;
         }
 
-        // check unary subtraction.
+        // check unary subtraction. {1,1} is 2^64+1, so subtracting 9 leaves 2^64-8.
         num1 = {1,1};
         tmp = {1,2};
         num1 -= tmp;
@@ -216,13 +218,13 @@ namespace tests
         num1 = {1,1};
         tmp = {9};
         num1 -= tmp;
-        num2 = {max-8};
+        num2 = {max-7};
         if(num1 != num2){
             return;
         }
 
         num1 = {1,1};
-        num2 = {max-8};
+        num2 = {max-7};
         num1 -= 9;
         if(num1 != num2){
             return;
@@ -237,7 +239,7 @@ namespace tests
         }
 
         tmp = {9};
-        num2 = {max-8};
+        num2 = {max-7};
         if( (num1 - tmp) != num2){
             return;
         }
@@ -275,6 +277,30 @@ namespace tests
         if(num_from_hex4 != num2){
             return;
         }
+
+        // check that numbers move out of and back into 64 bits.
+        num1 = {max};
+        num1 += 1;
+        num2 = {1,0};
+        if(num1 != num2 || !num1.overflowed()){
+            return;
+        }
+
+        num1 -= 1;
+        if(num1 != max || num1.overflowed()){
+            return;
+        }
+
+        num1 = {0, 0, 25};
+        if(num1 != 25 || num1.overflowed()){
+            return;
+        }
+
+        hexstr = std::string("00000000000000000000FFFFFFFFFFFFFFFF");
+        http::HttpBigNum num_from_hex5(http::HttpBigNum::hex, hexstr);
+        if(num_from_hex5 != max || num_from_hex5.overflowed()){
+            return;
+        }
         passed_ = true;
     }
 
@@ -746,4 +772,90 @@ namespace tests
         }
         passed_ = true;
     }
-}
\ No newline at end of file
+
+    HttpRequestsTests::HttpRequestsTests(ParseBuffer)
+      : passed_{false}
+    {
+        // A chunked request with a body that is larger than a single receive buffer.
+        std::string body(70000, 'x');
+        std::stringstream ss;
+        ss << "POST /run HTTP/1.1\r\n"
+           << "Content-Type: application/json\r\n"
+           << "Transfer-Encoding: chunked\r\n"
+           << "\r\n"
+           << std::hex << body.size() << "\r\n"
+           << body << "\r\n"
+           << "3\r\nabc\r\n"
+           << "0\r\n\r\n";
+        std::string buf = ss.str();
+        http::HttpRequest req{};
+        // Parse the request in place, from fixed size slices of the buffer.
+        const std::size_t slice = 4096;
+        std::size_t pos = 0;
+        while(pos < buf.size()){
+            std::string_view view(buf.data() + pos, std::min(slice, buf.size() - pos));
+            std::size_t consumed = http::parse(view, req);
+            if(consumed != view.size()){
+                return;
+            }
+            pos += consumed;
+        }
+        if(req.verb != http::HttpVerb::POST){
+            return;
+        } else if (req.route != "/run"){
+            return;
+        } else if (req.version != http::HttpVersion::V1_1){
+            return;
+        } else if (req.headers[1].field_name != http::HttpHeaderField::TRANSFER_ENCODING){
+            return;
+        } else if (req.next_chunk != req.num_chunks || req.num_chunks != 3){
+            return;
+        } else if (req.chunks[0].chunk_size != http::HttpBigNum{body.size()} || req.chunks[0].chunk_data != body){
+            return;
+        } else if (req.chunks[1].chunk_data != "abc"){
+            return;
+        } else if (req.chunks[2].chunk_size != http::HttpBigNum{0}){
+            return;
+        }
+        passed_ = true;
+    }
+
+    HttpRequestsTests::HttpRequestsTests(BenchParseChunks, std::size_t chunk_size)
+      : passed_{false},
+        req_{},
+        chunk_{}
+    {
+        // Chunk sizes are parsed into an HttpBigNum for every chunk.
+        std::string body(chunk_size, 'x');
+        std::stringstream size;
+        size << std::hex << chunk_size << "\r\n";
+        std::string buf;
+        buf.reserve(NUM_BENCH_CHUNKS * (size.str().size() + chunk_size + 2));
+        for(std::size_t i = 0; i < NUM_BENCH_CHUNKS; ++i){
+            buf.append(size.str());
+            buf.append(body);
+            buf.append("\r\n");
+        }
+        double best = std::numeric_limits<double>::max();
+        for(std::size_t run = 0; run < NUM_BENCH_RUNS; ++run){
+            std::string_view view(buf);
+            std::size_t parsed = 0;
+            auto start = std::chrono::steady_clock::now();
+            while(!view.empty()){
+                http::HttpChunk chunk = {};
+                std::size_t consumed = http::parse(view, chunk);
+                if(consumed == 0 || chunk.chunk_size != http::HttpBigNum{chunk_size}){
+                    return;
+                }
+                parsed += chunk.chunk_data.size();
+                view.remove_prefix(consumed);
+            }
+            best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()/NUM_BENCH_CHUNKS);
+            if(parsed != NUM_BENCH_CHUNKS * chunk_size){
+                return;
+            }
+        }
+        ns_per_chunk_ = best;
+        passed_ = true;
+    }
+}
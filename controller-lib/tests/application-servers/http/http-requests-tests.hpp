@@ -15,6 +15,8 @@ namespace tests
         constexpr static struct ResponseStreamExtraction{} test_response_stream_extraction{};
         constexpr static struct RequestStreamInsertion{} test_request_stream_insertion{};
         constexpr static struct ResponseStreamInsertion{} test_response_stream_insertion{};
+        constexpr static struct ParseBuffer{} test_parse_buffer{};
+        constexpr static struct BenchParseChunks{} bench_parse_chunks{};
 
 
         explicit HttpRequestsTests(ReadChunk);
@@ -26,10 +28,17 @@ namespace tests
         explicit HttpRequestsTests(ResponseStreamExtraction);
         explicit HttpRequestsTests(RequestStreamInsertion);
         explicit HttpRequestsTests(ResponseStreamInsertion);
+        explicit HttpRequestsTests(ParseBuffer);
+        // Parses NUM_BENCH_CHUNKS back to back chunks with bodies of chunk_size bytes, and keeps the best of NUM_BENCH_RUNS runs.
+        explicit HttpRequestsTests(BenchParseChunks, std::size_t chunk_size);
 
+        double ns_per_chunk() const { return ns_per_chunk_; }
         operator bool(){ return passed_; }
     private:
+        static constexpr std::size_t NUM_BENCH_CHUNKS = 100000;
+        static constexpr std::size_t NUM_BENCH_RUNS = 7;
         bool passed_;
+        double ns_per_chunk_{0};
         http::HttpRequest req_;
         http::HttpChunk chunk_;
     };
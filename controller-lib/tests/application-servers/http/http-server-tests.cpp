@@ -228,4 +228,37 @@ namespace tests{
         us.run();
     }
 
+    HttpServerTests::HttpServerTests(FindSession)
+      : passed_{false}
+    {
+        boost::asio::io_context ioc;
+        UnixServer::unix_server us(ioc);
+        http::HttpServer hs;
+        http::HttpServer hcs;
+        std::vector<std::shared_ptr<http::HttpSession> > sessions;
+        for(int i = 0; i < 3; ++i){
+            us.push_back(std::make_shared<UnixServer::unix_session>(ioc, us));
+            sessions.push_back(std::make_shared<http::HttpSession>(hs, us.back()));
+            hs.push_back(sessions.back());
+        }
+        for(auto& session: sessions){
+            if(hs.find(session->transport()) != session || hcs.find(session->transport())){
+                return;
+            }
+        }
+
+        // Erasing the first session moves the last session into its slot.
+        std::shared_ptr<server::Session> t_session = sessions.front()->transport();
+        sessions.front()->erase();
+        t_session->erase();
+        if(hs.size() != 2 || us.size() != 2 || hs.find(t_session) || t_session->is_in_server()){
+            return;
+        }
+        for(std::size_t i = 1; i < sessions.size(); ++i){
+            if(hs.find(sessions[i]->transport()) != sessions[i] || !sessions[i]->transport()->is_in_server()){
+                return;
+            }
+        }
+        passed_ = true;
+    }
 }// namespace tests.
\ No newline at end of file
@@ -14,12 +14,14 @@ namespace tests
         constexpr static struct ConstructUnixBoundSession{} test_construct_unix_bound_session{};
         constexpr static struct UnixBoundReadWrite{} test_unix_bound_read_write{};
         constexpr static struct UnixBoundClientWrite{} test_unix_client_write{};
+        constexpr static struct FindSession{} test_find_session{};
 
         explicit HttpServerTests(ConstructServer);
         explicit HttpServerTests(ConstructSession);
         explicit HttpServerTests(ConstructUnixBoundSession);
         explicit HttpServerTests(UnixBoundReadWrite);
         explicit HttpServerTests(UnixBoundClientWrite);
+        explicit HttpServerTests(FindSession);
 
         operator bool(){ return passed_; }
     private:
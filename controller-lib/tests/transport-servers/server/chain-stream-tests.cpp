@@ -0,0 +1,91 @@
+#include "chain-stream-tests.hpp"
+#include "../../../src/application-servers/http/http-requests.hpp"
+#include <cstring>
+
+namespace tests{
+    ChainStreamTest::ChainStreamTest(TestBorrow)
+      : passed_{false},
+        stream_{}
+    {
+        // Returned buffers are recycled instead of being freed.
+        server::ReceiveBuffer* first = nullptr;
+        {
+            server::BufferPool::Handle buf = server::BufferPool::borrow();
+            first = buf.get();
+        }
+        std::size_t available = server::BufferPool::available();
+        server::BufferPool::Handle buf = server::BufferPool::borrow();
+        if(buf.get() != first){
+            return;
+        } else if (server::BufferPool::available() != available - 1){
+            return;
+        }
+        passed_ = true;
+    }
+
+    ChainStreamTest::ChainStreamTest(TestAppend)
+      : passed_{false},
+        stream_{}
+    {
+        // A large read is chained without copying, and a short read is copied into the end of the chain.
+        const std::size_t len = 60000;
+        server::BufferPool::Handle large = server::BufferPool::borrow();
+        std::memset(large->data(), 'a', len);
+        stream_.append(std::move(large), len);
+        if(large){
+            return;
+        }
+        server::BufferPool::Handle small = server::BufferPool::borrow();
+        std::memcpy(small->data(), "bcd", 3);
+        stream_.append(std::move(small), 3);
+        if(!small){
+            return;
+        }
+        stream_ << "efg";
+        std::string expected = std::string(len, 'a') + "bcdefg";
+        if(stream_.str() != expected){
+            return;
+        }
+        std::string received(expected.size(), '\0');
+        stream_.read(received.data(), received.size());
+        if(received != expected){
+            return;
+        } else if (stream_.rdbuf()->in_avail() > 0){
+            return;
+        }
+        stream_.str("hij");
+        if(stream_.str() != "hij"){
+            return;
+        }
+        passed_ = true;
+    }
+
+    ChainStreamTest::ChainStreamTest(TestExtractRequest)
+      : passed_{false},
+        stream_{}
+    {
+        // Requests are parsed from the receive buffers that they were read into.
+        std::string body(100000, 'x');
+        std::string data = "POST /run HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        http::HttpRequest req{};
+        std::size_t pos = 0;
+        while(pos < data.size()){
+            server::BufferPool::Handle buf = server::BufferPool::borrow();
+            std::size_t len = std::min(buf->size(), data.size() - pos);
+            std::memcpy(buf->data(), data.data() + pos, len);
+            stream_.append(std::move(buf), len);
+            pos += len;
+            stream_ >> req;
+        }
+        if(req.verb != http::HttpVerb::POST){
+            return;
+        } else if (req.route != "/run"){
+            return;
+        } else if (req.next_chunk != req.num_chunks){
+            return;
+        } else if (req.chunks[0].chunk_data != body){
+            return;
+        }
+        passed_ = true;
+    }
+}
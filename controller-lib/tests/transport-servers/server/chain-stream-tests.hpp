@@ -0,0 +1,23 @@
+#ifndef CHAIN_STREAM_TESTS_HPP
+#define CHAIN_STREAM_TESTS_HPP
+#include "../../../src/transport-servers/server/chain-stream.hpp"
+
+namespace tests{
+    class ChainStreamTest
+    {
+    public:
+        constexpr static struct TestBorrow{} test_borrow{};
+        constexpr static struct TestAppend{} test_append{};
+        constexpr static struct TestExtractRequest{} test_extract_request{};
+
+        explicit ChainStreamTest(TestBorrow);
+        explicit ChainStreamTest(TestAppend);
+        explicit ChainStreamTest(TestExtractRequest);
+
+        operator bool(){ return passed_; }
+    private:
+        bool passed_;
+        server::ChainStream stream_;
+    };
+}
+#endif
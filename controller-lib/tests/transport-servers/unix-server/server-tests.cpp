@@ -152,4 +152,27 @@ namespace tests{
         );
         ioc.run();
     }
+
+    UnixServerTest::UnixServerTest(TestAdoptUnix, boost::asio::io_context& ioc, const boost::asio::local::stream_protocol::endpoint& endpoint)
+      : passed_{false},
+        server_(ioc, endpoint)
+    {
+        // The adopting server shares the endpoint, but doesn't bind it.
+        UnixServer::unix_server shard(ioc, endpoint, false);
+        server_.accept_native(
+            [&](const boost::system::error_code& ec, int fd){
+                if(!ec){
+                    std::shared_ptr<UnixServer::unix_session> session = shard.adopt(fd);
+                    if(session && server_.empty() && !shard.empty()){
+                        passed_ = true;
+                    }
+                }
+                server_.stop();
+            }
+        );
+        boost::asio::local::stream_protocol::socket client(ioc);
+        client.async_connect(endpoint, [&](const boost::system::error_code&){});
+        ioc.run();
+        shard.clear();
+    }
 }
\ No newline at end of file
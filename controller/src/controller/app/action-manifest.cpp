@@ -2,12 +2,166 @@
 #include <boost/json.hpp>
 #include "action-relation.hpp"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <sys/inotify.h>
+#include <unistd.h>
 
 namespace controller{
 namespace app{
+    /* ActionManifest Static Members */
+    std::mutex ActionManifest::template_mtx_;
+    std::shared_ptr<const ManifestTemplate> ActionManifest::template_;
+    int ActionManifest::inotify_fd_ = -1;
+
+    std::shared_ptr<const ManifestTemplate> ActionManifest::load(){
+        std::unique_lock<std::mutex> lk(template_mtx_);
+        if(inotify_fd_ != -1){
+            // Drain the watch, any change to __OW_ACTIONS invalidates the template.
+            alignas(struct inotify_event) char buf[4096];
+            for(;;){
+                ssize_t len = read(inotify_fd_, buf, sizeof(buf));
+                if(len > 0){
+                    template_.reset();
+                    continue;
+                }
+                if(len == -1 && errno == EINTR){
+                    continue;
+                }
+                if(len == -1 && errno != EAGAIN){
+                    std::cerr << "action-manifest.cpp:32:read(inotify_fd_) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+                }
+                break;
+            }
+        }
+        if(!template_){
+            watch();
+            template_ = build();
+        }
+        return template_;
+    }
+
+    void ActionManifest::invalidate(){
+        std::unique_lock<std::mutex> lk(template_mtx_);
+        template_.reset();
+        return;
+    }
+
+    void ActionManifest::watch(){
+        // The watch is added before the manifest is read, so that a change made while the template is being built isn't missed.
+        const char* __OW_ACTIONS = getenv("__OW_ACTIONS");
+        if(__OW_ACTIONS == nullptr){
+            return;
+        }
+        if(inotify_fd_ == -1){
+            inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if(inotify_fd_ == -1){
+                // Without a watch the template is only invalidated by /init.
+                std::cerr << "action-manifest.cpp:61:inotify_init1() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                return;
+            }
+        }
+        // Adding a watch to a directory that is already watched returns the existing watch descriptor.
+        if(inotify_add_watch(inotify_fd_, __OW_ACTIONS, IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF) == -1){
+            switch(errno)
+            {
+                case ENOENT:
+                    // __OW_ACTIONS is created by /init, which invalidates the template.
+                    break;
+                default:
+                    std::cerr << "action-manifest.cpp:73:inotify_add_watch() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    break;
+            }
+        }
+        return;
+    }
+
+    std::shared_ptr<const ManifestTemplate> ActionManifest::build(){
+        const char* __OW_ACTIONS = getenv("__OW_ACTIONS");
+        if ( __OW_ACTIONS == nullptr ){
+            std::cerr << "action-manifest.cpp:83:__OW_ACTIONS envvar not defined." << std::endl;
+            throw "this shouldn't happen.";
+        }
+        ActionManifest compiled;
+        std::filesystem::path action_path(__OW_ACTIONS);
+        std::filesystem::path manifest_path(action_path / "action-manifest.json");
+        if (std::filesystem::exists(manifest_path)){
+            std::fstream f(manifest_path, std::ios_base::in);
+            boost::json::error_code ec;
+            boost::json::value tmp = boost::json::parse(f,ec);
+            if (ec){
+                std::cerr << "action-manifest.cpp:94:" << ec.message() << std::endl;
+                throw "boost json parse failed.";
+            }
+            boost::json::object manifest;
+            try{
+                manifest = tmp.as_object();
+            }catch(std::system_error& e){
+                std::cerr << "action-manifest.cpp:101:tmp is not an object:" << boost::json::serialize(tmp) << std::endl;
+                throw e;
+            }
+            // If the manifest is empty throw an exception.
+            if(manifest.empty()){
+                std::cerr << "The action-manifest.json file can not be empty." << std::endl;
+                throw "action-manifest.json can't be empty.";
+            }
+            /* If the action manifest contains an __OW_NUM_CONCURRENCY key, set the manifest concurrency to that value, otherwise set it to 1.*/
+            // Subsequently erase the __OW_NUM_CONCURRENCY KEY from the ingested manifest to ensure that the subsequent logic continues to work.
+            if(manifest.contains("__OW_NUM_CONCURRENCY")){
+                if(manifest["__OW_NUM_CONCURRENCY"].is_int64()){
+                    compiled.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_int64();
+                } else if (manifest["__OW_NUM_CONCURRENCY"].is_uint64()){
+                    compiled.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_uint64();
+                } else {
+                    std::cerr << "Manifest __OW_NUM_CONCURRENCY is too large, or is not an integer." << std::endl;
+                    compiled.concurrency() = 1;
+                }
+                manifest.erase("__OW_NUM_CONCURRENCY");
+            } else {
+                compiled.concurrency() = 1;
+            }
+            // Emplace every key, the relations are inserted using a recursive tree traversal method.
+            for(auto& kvp: manifest){
+                compiled.emplace(std::string(kvp.key()), manifest);
+            }
+            // Reverse lexicographically sort the manifest.
+            std::sort(compiled.begin(), compiled.end(), [&](const std::shared_ptr<Relation>& a, const std::shared_ptr<Relation>& b){
+                return a->depth() > b->depth();
+            });
+        } else {
+            const char* __OW_ACTION_EXT = getenv("__OW_ACTION_EXT");
+            if ( __OW_ACTION_EXT == nullptr ){
+                std::cerr << "action-manifest.cpp:135:__OW_ACTION_EXT envvar is not defined." << std::endl;
+                throw "Environment variable __OW_ACTION_EXT is not defined!";
+            }
+            // By default the file is called "main" + __OW_ACTION_EXT.
+            // e.g. "main.lua", or "main.py", or "main.js".
+            std::string filename("main");
+            filename.append(".");
+            filename.append(__OW_ACTION_EXT);
+            std::filesystem::path fn_path(action_path / filename);
+
+            const char* __OW_ACTION_ENTRY_POINT = getenv("__OW_ACTION_ENTRY_POINT");
+            std::string entrypoint;
+            if ( __OW_ACTION_ENTRY_POINT == nullptr ){
+                // By default, the entry point is called main.
+                entrypoint = std::string("main");
+            } else {
+                entrypoint = std::string(__OW_ACTION_ENTRY_POINT);
+            }
+            // By default, the entry point has no dependencies.
+            compiled.push_back( std::make_shared<Relation>(std::move(entrypoint), std::move(fn_path), std::vector<std::shared_ptr<Relation> >()));
+        }
+        return compiled.make_template();
+    }
+    // End of ActionManifest Static Members
+
     ActionManifest::ActionManifest()
       : concurrency_{1},
-        index_()
+        index_(),
+        remaining_{0},
+        remaining_levels_{0}
     {}
 
     void ActionManifest::emplace(const std::string& key, const boost::json::object& manifest){
@@ -51,6 +205,10 @@ namespace app{
             path /= fname;
             
             std::shared_ptr<Relation> rel = std::make_shared<Relation>(key, path, dependencies);
+            const boost::json::object& jrel = manifest.at(key).as_object();
+            if(jrel.contains("stream") && jrel.at("stream").is_bool()){
+                rel->stream() = jrel.at("stream").get_bool();
+            }
             index_.push_back(std::move(rel));
             return;
         } else {
@@ -60,71 +218,261 @@ namespace app{
         }
     }
 
-    std::shared_ptr<Relation> ActionManifest::next(const std::string& key, const std::size_t& idx){
-        // Return the next task that needs to be completed in the list of dependences for 
-        // "key".
-
-        //Defensive programming, first check to see that there are still relations that need to finish executing.
-        auto tmp = std::find_if(index_.begin(), index_.end(), [&](auto& rel){
-            std::string value = rel->acquire_value();
-            rel->release_value();
-            if( value.empty() || value == "null" ){
-                return true;
+    std::shared_ptr<ManifestTemplate> ActionManifest::make_template(){
+        const std::size_t size = index_.size();
+        std::shared_ptr<ManifestTemplate> dag = std::make_shared<ManifestTemplate>();
+        dag->concurrency = concurrency_;
+        dag->keys.reserve(size);
+        dag->paths.reserve(size);
+        dag->streams.reserve(size);
+        dag->positions.reserve(size);
+        for(std::size_t i = 0; i < size; ++i){
+            dag->keys.push_back(index_[i]->key());
+            dag->paths.push_back(index_[i]->path());
+            dag->streams.push_back(index_[i]->stream());
+            dag->positions.emplace(index_[i]->key(), i);
+        }
+        std::vector<std::size_t> depths;
+        depths.reserve(size);
+        for(auto& relation: index_){
+            depths.push_back(relation->depth());
+        }
+        std::sort(depths.begin(), depths.end());
+        depths.erase(std::unique(depths.begin(), depths.end()), depths.end());
+        dag->levels.reserve(size);
+        for(auto& relation: index_){
+            dag->levels.push_back(std::lower_bound(depths.begin(), depths.end(), relation->depth()) - depths.begin());
+        }
+        dag->num_levels = depths.size();
+        dag->dependencies.assign(size, std::vector<std::size_t>());
+        dag->dependents.assign(size, std::vector<std::size_t>());
+        dag->pipelined.assign(size, false);
+        for(std::size_t i = 0; i < size; ++i){
+            auto& relation = index_[i];
+            for(auto& dependency: *relation){
+                auto it = dag->positions.find(dependency->key());
+                if(it == dag->positions.end()){
+                    std::cerr << "action-manifest.cpp:242:Dependency " << dependency->key() << " of " << relation->key() << " is not in the index!" << std::endl;
+                    throw "Dependency not in index!";
+                }
+                dag->dependencies[i].push_back(it->second);
+                dag->dependents[it->second].push_back(i);
+            }
+            dag->pipelined[i] = (relation->stream() && relation->size() == 1 && (*relation)[0]->stream());
+        }
+        // The index is sorted by depth, so the heights of all dependents are known before the height of their dependency.
+        dag->heights.assign(size, 1);
+        for(std::size_t i = 0; i < size; ++i){
+            for(auto dependent: dag->dependents[i]){
+                dag->heights[i] = std::max(dag->heights[i], dag->heights[dependent] + 1);
+            }
+        }
+        return dag;
+    }
+
+    void ActionManifest::instantiate(const std::shared_ptr<const ManifestTemplate>& manifest){
+        const std::size_t size = manifest->keys.size();
+        concurrency_ = manifest->concurrency;
+        index_.assign(size, nullptr);
+        // The index is sorted by depth, so every dependency is instantiated before its dependents when iterating in reverse.
+        for(std::size_t i = size; i-- > 0;){
+            std::vector<std::shared_ptr<Relation> > dependencies;
+            dependencies.reserve(manifest->dependencies[i].size());
+            for(auto dependency: manifest->dependencies[i]){
+                dependencies.push_back(index_[dependency]);
+            }
+            index_[i] = std::make_shared<Relation>(manifest->keys[i], manifest->paths[i], dependencies);
+            index_[i]->stream() = manifest->streams[i];
+        }
+        dag_ = manifest;
+        prepare();
+        return;
+    }
+
+    void ActionManifest::compile(){
+        dag_ = make_template();
+        prepare();
+        return;
+    }
+
+    void ActionManifest::prepare(){
+        const std::size_t size = index_.size();
+        for(std::size_t i = 0; i < size; ++i){
+            index_[i]->attach(this, i);
+        }
+        pending_ = std::make_unique<std::atomic<std::size_t>[]>(size);
+        streaming_ = std::make_unique<std::atomic<bool>[]>(size);
+        std::unique_lock<std::mutex> lk(mtx_);
+        successors_.resize(size);
+        reported_.assign(size, false);
+        incomplete_.assign(dag_->num_levels, 0);
+        std::size_t remaining = 0;
+        std::size_t remaining_levels = 0;
+        for(std::size_t i = 0; i < size; ++i){
+            auto& relation = index_[i];
+            std::size_t pending = 0;
+            for(auto dependency: dag_->dependencies[i]){
+                if(!index_[dependency]->complete()){
+                    ++pending;
+                }
+            }
+            pending_[i].store(pending, std::memory_order::memory_order_relaxed);
+            reported_[i] = relation->complete();
+            // Complete relations point at the next position, incomplete relations are the roots of the union-find.
+            if(relation->complete()){
+                successors_[i] = (i + 1) % size;
             } else {
-                return false;
+                successors_[i] = i;
+                ++remaining;
+                if(incomplete_[dag_->levels[i]]++ == 0){
+                    ++remaining_levels;
+                }
             }
-        });
-        if (tmp == index_.end()){
-            // if there are no more relations to complete, return a default constructed relation.
-            return std::make_shared<Relation>();
         }
+        remaining_.store(remaining, std::memory_order::memory_order_relaxed);
+        remaining_levels_.store(remaining_levels, std::memory_order::memory_order_relaxed);
+        return;
+    }
 
-        // Search for "key" in index.
-        auto it = std::find_if(index_.begin(), index_.end(),[&](auto& rel){
-            return rel->key() == key;
-        });
-        // If key isn't in index. Throw an exception, this shouldn't be possible.
-        if (it == index_.end() ){
-            std::cerr << "action-manifest.cpp:79:Key not in index!" << std::endl;
-            throw "Key not in index!";
+    std::size_t ActionManifest::position(const std::string& key) const {
+        auto it = dag_->positions.find(key);
+        return (it == dag_->positions.end()) ? index_.size() : it->second;
+    }
+
+    void ActionManifest::update(std::size_t pos, bool complete){
+        if(!pending_){
+            // The manifest hasn't been compiled yet, compile() counts the completed relations.
+            return;
+        }
+        const std::size_t size = index_.size();
+        std::unique_lock<std::mutex> lk(mtx_);
+        for(auto dependent: dag_->dependents[pos]){
+            if(dag_->pipelined[dependent] && streaming_[pos].load(std::memory_order::memory_order_relaxed)){
+                // Pipelined dependents were released when the relation started streaming.
+                continue;
+            }
+            if(complete){
+                pending_[dependent].fetch_sub(1, std::memory_order::memory_order_relaxed);
+            } else {
+                pending_[dependent].fetch_add(1, std::memory_order::memory_order_relaxed);
+            }
+        }
+        reported_[pos] = complete;
+        if(complete){
+            remaining_.fetch_sub(1, std::memory_order::memory_order_relaxed);
+            if(--incomplete_[dag_->levels[pos]] == 0){
+                remaining_levels_.fetch_sub(1, std::memory_order::memory_order_relaxed);
+            }
+            successors_[pos] = (pos + 1) % size;
+        } else {
+            // Relations can't be split back out of the union-find, so the index is rebuilt.
+            remaining_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            if(incomplete_[dag_->levels[pos]]++ == 0){
+                remaining_levels_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            }
+            for(std::size_t i = 0; i < size; ++i){
+                successors_[i] = (index_[i]->complete()) ? (i + 1) % size : i;
+            }
+        }
+        return;
+    }
+
+    void ActionManifest::stream(std::size_t pos){
+        if(!pending_){
+            return;
+        }
+        std::unique_lock<std::mutex> lk(mtx_);
+        if(streaming_[pos].exchange(true, std::memory_order::memory_order_relaxed) || reported_[pos]){
+            // The dependents have already been released.
+            return;
         }
+        for(auto dependent: dag_->dependents[pos]){
+            if(dag_->pipelined[dependent]){
+                pending_[dependent].fetch_sub(1, std::memory_order::memory_order_relaxed);
+            }
+        }
+        return;
+    }
+
+    bool ActionManifest::satisfied(std::size_t dependency, std::size_t dependent){
+        return index_[dependency]->complete() || (dag_->pipelined[dependent] && streaming_[dependency].load(std::memory_order::memory_order_relaxed));
+    }
+
+    std::size_t ActionManifest::find_incomplete(std::size_t pos){
+        // Returns the first incomplete relation at or after pos (mod the index size), or the index size if there isn't one.
+        const std::size_t size = index_.size();
+        std::size_t root = pos;
+        std::size_t steps = 0;
+        for(; steps < 2*size; ++steps){
+            if(successors_[root] == root){
+                if(!index_[root]->complete()){
+                    break;
+                }
+                // The relation has completed, but hasn't been reported to the manifest yet.
+                root = (root + 1) % size;
+            } else {
+                root = successors_[root];
+            }
+        }
+        if(steps == 2*size){
+            return size;
+        }
+        // Path compression.
+        while(pos != root && successors_[pos] != pos){
+            std::size_t next = successors_[pos];
+            successors_[pos] = root;
+            pos = next;
+        }
+        return root;
+    }
+
+    std::shared_ptr<Relation> ActionManifest::next(const std::string& key, const std::size_t& idx){
+        return next(position(key), idx);
+    }
 
-        // First check to see if the relation at key has already been completed.
-        std::string& value = (*it)->acquire_value();
-        (*it)->release_value();
-        if( !(value.empty())){
-            // If the relation has already been completed, then recursively call next with 
-            // the next relation modulo the index size.
-            std::ptrdiff_t i = it - index_.begin();
-            std::string k(index_[(++i)%index_.size()]->key());
-            return next(k, idx);
-        }
-        // Otherwise the relation still needs to complete.
-
-        // Iterate through all of the dependencies starting at
-        // the index: idx (mod dependencies.size()).
-        std::size_t num_deps = (*it)->size();
-        if (num_deps == 0){
-            // The first recursive base case.
-            // The number of dependencies the current relation has is 0.
-            // Therefore we can just directly return the relation.
-            return std::shared_ptr<Relation>(*it);
-        }
-        std::size_t start = idx % num_deps;
-        for (std::size_t offset=0; offset < num_deps; ++offset){
-            std::size_t select = (start + offset)%num_deps;
-            // If the dependency value is empty that means the dependency
-            // has not finished computing yet. Call next recursively.
-            if( (**it)[select]->acquire_value().empty() ){
-                (**it)[select]->release_value();
-                std::string dep_key((**it)[select]->key());
-                return next(dep_key, idx);
-            }
-            (**it)[select]->release_value();
-        }
-        // The second recursive base case.
-        // All of the dependencies have computed values. Therefore the next thing to do is compute the current relation.
-        return std::shared_ptr<Relation>(*it);
+    std::shared_ptr<Relation> ActionManifest::next(std::size_t pos, std::size_t idx){
+        // Return the next task that needs to be completed in the list of dependences for
+        // the relation at pos.
+        if(pos >= index_.size()){
+            std::cerr << "action-manifest.cpp:174:Key not in index!" << std::endl;
+            throw "Key not in index!";
+        }
+        if(!pending_){
+            std::cerr << "action-manifest.cpp:178:The manifest has not been compiled!" << std::endl;
+            throw "The manifest has not been compiled!";
+        }
+        // Find the first relation at or after pos that still needs to complete.
+        std::unique_lock<std::mutex> lk(mtx_);
+        if(remaining_.load(std::memory_order::memory_order_relaxed) == 0){
+            // if there are no more relations to complete, return a default constructed relation.
+            return std::make_shared<Relation>();
+        }
+        std::size_t current = find_incomplete(pos);
+        lk.unlock();
+        if(current == index_.size()){
+            return std::make_shared<Relation>();
+        }
+        // Descend through the incomplete dependencies, starting at the dependency idx (mod dependencies.size()),
+        // until we reach a relation whose dependencies have all computed values.
+        while(pending_[current].load(std::memory_order::memory_order_relaxed) > 0){
+            const auto& dependencies = dag_->dependencies[current];
+            const std::size_t num_deps = dependencies.size();
+            const std::size_t start = idx % num_deps;
+            bool found = false;
+            for(std::size_t offset = 0; offset < num_deps; ++offset){
+                std::size_t select = dependencies[(start + offset) % num_deps];
+                if(!satisfied(select, current)){
+                    current = select;
+                    found = true;
+                    break;
+                }
+            }
+            if(!found){
+                // The remaining dependencies completed concurrently.
+                break;
+            }
+        }
+        return index_[current];
     }
 
     std::vector<std::shared_ptr<Relation> >::iterator ActionManifest::begin() { return index_.begin(); }
@@ -3,6 +3,10 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
 
 /* Forward Declarations */
 namespace boost{
@@ -21,12 +25,58 @@ namespace http{
 
 namespace controller{
 namespace app{
+    /* An action manifest compiled into an immutable template. */
+    // The template holds everything that is shared by the execution contexts of an action, in the final (depth sorted)
+    // order of the relations. Each context instantiates fresh relations from it, and keeps its own scheduling state
+    // in flat arrays indexed by position.
+    struct ManifestTemplate
+    {
+        std::size_t concurrency{1};
+        std::vector<std::string> keys;
+        std::vector<std::filesystem::path> paths;
+        std::vector<bool> streams;
+        std::unordered_map<std::string, std::size_t> positions;
+        std::vector<std::vector<std::size_t> > dependencies;
+        std::vector<std::vector<std::size_t> > dependents;
+        std::vector<bool> pipelined;
+        // Relations at the same depth can run in parallel, so every position is mapped to the level of its depth.
+        std::vector<std::size_t> levels;
+        std::size_t num_levels{0};
+        // The length of the longest chain of relations that depend on each position, including the relation itself.
+        std::vector<std::size_t> heights;
+    };
+
     class ActionManifest
     {
     public:
+        /* The manifest in __OW_ACTIONS is only read and compiled once. */
+        // The cached template is rebuilt after the action is initialized, or when an inotify watch on
+        // __OW_ACTIONS reports that the directory has changed.
+        static std::shared_ptr<const ManifestTemplate> load();
+        static void invalidate();
+
         ActionManifest();
+        // Replaces the relations with fresh relations instantiated from the template, and compiles the manifest.
+        void instantiate(const std::shared_ptr<const ManifestTemplate>& manifest);
         void emplace(const std::string& key, const boost::json::object& manifest);
         std::shared_ptr<Relation> next(const std::string& key, const std::size_t& idx);
+        std::shared_ptr<Relation> next(std::size_t pos, std::size_t idx);
+
+        /* The manifest is compiled into an integer indexed DAG once all of the relations are in their final order. */
+        // Each relation keeps a counter of its incomplete dependencies, and the manifest keeps a union-find index
+        // from every position to the next incomplete relation, so next() never compares keys or copies values.
+        void compile();
+        std::size_t position(const std::string& key) const;
+        void update(std::size_t pos, bool complete);
+        // The length of the remaining critical path, estimated as the number of levels that still have incomplete
+        // relations. It is counted by compile() and kept up to date by update(), so no relation is locked to read it.
+        std::size_t remaining_levels() const { return remaining_levels_.load(std::memory_order::memory_order_relaxed); }
+        std::size_t height(std::size_t pos) const { return dag_->heights[pos]; }
+
+        /* Relations flagged with "stream": true in the manifest are pipelined. */
+        // A streaming relation whose only dependency is also a streaming relation is ready as soon as its dependency
+        // has started producing records, instead of waiting for the dependency to complete.
+        void stream(std::size_t pos);
         std::size_t& concurrency(){ return concurrency_; }
         const std::vector<std::shared_ptr<Relation> >& index(){ return index_; }
 
@@ -47,8 +97,33 @@ namespace app{
 
         std::vector<std::shared_ptr<Relation> >::size_type size(){ return index_.size(); }
     private:
+        static std::shared_ptr<const ManifestTemplate> build();
+        static void watch();
+        static std::mutex template_mtx_;
+        static std::shared_ptr<const ManifestTemplate> template_;
+        static int inotify_fd_;
+
+        std::shared_ptr<ManifestTemplate> make_template();
+        void prepare();
+        std::size_t find_incomplete(std::size_t pos);
+        bool satisfied(std::size_t dependency, std::size_t dependent);
+
         std::size_t concurrency_;
         std::vector<std::shared_ptr<Relation> > index_;
+
+        // Compiled DAG, shared with the other contexts instantiated from the same template.
+        std::shared_ptr<const ManifestTemplate> dag_;
+        // Per context scheduling state.
+        std::unique_ptr<std::atomic<std::size_t>[]> pending_;
+        std::atomic<std::size_t> remaining_;
+        std::mutex mtx_;
+        std::vector<std::size_t> successors_;
+        // Incomplete relations in each level.
+        std::vector<std::size_t> incomplete_;
+        std::atomic<std::size_t> remaining_levels_;
+        // Pipelined relations.
+        std::unique_ptr<std::atomic<bool>[]> streaming_;
+        std::vector<bool> reported_;
     };
 }//namespace app
 }//namespace controller
@@ -1,7 +1,19 @@
 #include "action-relation.hpp"
+#include "action-manifest.hpp"
+#include "shared-results.hpp"
+#include <iostream>
+#include <algorithm>
+#include <system_error>
+#include <cstdint>
+#include <unistd.h>
 
 namespace controller{
 namespace app{
+    RelationResult::~RelationResult()
+    {
+        SharedResults::close(memfd);
+    }
+
     Relation::Relation()
       : kvp_(),
         dependencies_(),
@@ -42,6 +54,11 @@ namespace app{
         depth_{1},
         path_(path)
     {
+        complete_.store(!kvp_.second.empty(), std::memory_order::memory_order_relaxed);
+        if(!publish()){
+            std::cerr << "action-relation.cpp:55:JSON parsing failed:value:" << kvp_.second << std::endl;
+            throw "what?";
+        }
         for ( auto dependency: dependencies_ ){
             if ( dependency->depth() >= depth_ ){
                 depth_ = dependency->depth() + 1;
@@ -55,11 +72,140 @@ namespace app{
         depth_{1},
         path_(path)
     {
+        complete_.store(!kvp_.second.empty(), std::memory_order::memory_order_relaxed);
+        if(!publish()){
+            std::cerr << "action-relation.cpp:73:JSON parsing failed:value:" << kvp_.second << std::endl;
+            throw "what?";
+        }
         for ( auto dependency: dependencies_ ){
             if ( dependency->depth() >= depth_ ){
                 depth_ = dependency->depth() + 1;
             }
         }
     }
+
+    bool Relation::publish(int memfd)
+    {
+        const std::string& value = kvp_.second;
+        const RelationResult* published = result_.load(std::memory_order::memory_order_relaxed);
+        if((published == nullptr) ? value.empty() : (published->serialized == value)){
+            SharedResults::close(memfd);
+            return true;
+        }
+        if(value.empty()){
+            SharedResults::close(memfd);
+            result_.store(nullptr, std::memory_order::memory_order_release);
+            return true;
+        }
+        auto result = std::make_unique<RelationResult>();
+        result->memfd = memfd;
+        boost::json::error_code ec;
+        result->value = boost::json::parse(value, ec);
+        if(ec){
+            return false;
+        }
+        result->serialized = value;
+        result_.store(result.get(), std::memory_order::memory_order_release);
+        results_.push_back(std::move(result));
+        return true;
+    }
+
+    void Relation::release_value()
+    {
+        release_value(-1);
+        return;
+    }
+
+    void Relation::release_value(int memfd)
+    {
+        // Only the thread holding the value lock can change completion, so transitions are reported exactly once.
+        bool complete = !kvp_.second.empty();
+        bool was_complete = complete_.exchange(complete, std::memory_order::memory_order_relaxed);
+        if(!publish(memfd)){
+            std::string value = kvp_.second;
+            mtx_.unlock();
+            std::cerr << "action-relation.cpp:123:JSON parsing failed:value:" << value << std::endl;
+            throw "what?";
+        }
+        mtx_.unlock();
+        if(manifest_ != nullptr && complete != was_complete){
+            manifest_->update(position_, complete);
+        }
+        if(stream_ && complete){
+            notify_records();
+        }
+        return;
+    }
+
+    void Relation::open_records()
+    {
+        if(manifest_ != nullptr){
+            manifest_->stream(position_);
+        }
+        return;
+    }
+
+    void Relation::append_records(std::string_view lines)
+    {
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        records_.append(lines);
+        lk.unlock();
+        notify_records();
+        return;
+    }
+
+    void Relation::close_records()
+    {
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        records_closed_ = true;
+        lk.unlock();
+        notify_records();
+        return;
+    }
+
+    bool Relation::read_records(std::size_t& offset, std::string& lines)
+    {
+        // Appends the records after offset to lines, and returns true once every record has been read.
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        if(offset < records_.size()){
+            lines.append(records_, offset, std::string::npos);
+            offset = records_.size();
+        }
+        return records_closed_;
+    }
+
+    void Relation::watch_records(int efd)
+    {
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        records_watchers_.push_back(efd);
+        return;
+    }
+
+    void Relation::unwatch_records(int efd)
+    {
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        records_watchers_.erase(std::remove(records_watchers_.begin(), records_watchers_.end(), efd), records_watchers_.end());
+        return;
+    }
+
+    void Relation::notify_records()
+    {
+        // The watchers are signalled while the lock is held, so that an eventfd is never written after it has been unwatched.
+        std::unique_lock<std::mutex> lk(records_mtx_);
+        std::uint64_t notice = 1;
+        for(int efd: records_watchers_){
+            while(write(efd, &notice, sizeof(notice)) == -1){
+                if(errno == EINTR){
+                    continue;
+                } else if(errno != EAGAIN){
+                    std::cerr << "action-relation.cpp:201:write(efd) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+                }
+                // The counter is saturated, so the watcher is already going to wake up.
+                break;
+            }
+        }
+        return;
+    }
 }//namespace app
 }//namespace controller
\ No newline at end of file
@@ -3,9 +3,35 @@
 #include <filesystem>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <boost/json.hpp>
 
+/* Forward Declarations */
 namespace controller{
 namespace app{
+    class ActionManifest;
+}
+}
+
+namespace controller{
+namespace app{
+    /* An immutable relation result. */
+    // The value is parsed once when the result is stored, and the original JSON text is kept alongside it
+    // so that it can be spliced into outgoing messages without being serialized again.
+    struct RelationResult
+    {
+        RelationResult() = default;
+        RelationResult(const RelationResult&) = delete;
+        RelationResult& operator=(const RelationResult&) = delete;
+        ~RelationResult();
+        boost::json::value value;
+        std::string serialized;
+        // A sealed memfd holding the serialized value, or -1 if the value was not passed through shared memory.
+        int memfd{-1};
+    };
+
     class Relation
     {
     public:
@@ -18,10 +44,36 @@ namespace app{
 
         const std::string& key() const { return kvp_.first; }
         std::string& acquire_value() { mtx_.lock(); return kvp_.second; }
-        void release_value() { mtx_.unlock(); }
+        void release_value();
+        // Releases the value lock, and hands a sealed memfd that holds the new value to the published result.
+        void release_value(int memfd);
         std::size_t depth() const { return depth_; }
+
+        // A relation is complete once it has a value. Completion is tracked without taking the value lock,
+        // and is reported to the manifest that the relation has been attached to.
+        bool complete() const { return complete_.load(std::memory_order::memory_order_relaxed); }
+        void attach(ActionManifest* manifest, std::size_t position) { manifest_ = manifest; position_ = position; }
+        std::size_t position() const { return position_; }
+
+        // The parsed result is published when the value changes, and can be read without taking the value lock.
+        // The result is nullptr until the relation has a value.
+        const RelationResult* result() const { return result_.load(std::memory_order::memory_order_acquire); }
+
         const std::filesystem::path& path() const { return path_; }
 
+        /* Streaming relations produce JSON lines records. */
+        // The records are published as they arrive so that a streaming dependent can consume them before the relation
+        // completes. The value of a streaming relation is the JSON array of all of its records.
+        bool& stream() { return stream_; }
+        void open_records();
+        void append_records(std::string_view lines);
+        void close_records();
+        bool read_records(std::size_t& offset, std::string& lines);
+        // Eventfds that are signalled whenever records are published, or the relation completes, so that a streaming
+        // dependent can wait for its dependency without a timer.
+        void watch_records(int efd);
+        void unwatch_records(int efd);
+
         // Reexport the std::vector interface.
         std::vector<std::shared_ptr<Relation> >::iterator begin() { return dependencies_.begin(); }
         std::vector<std::shared_ptr<Relation> >::iterator end() { return dependencies_.end(); }
@@ -35,11 +87,25 @@ namespace app{
         std::shared_ptr<Relation>& operator[]( std::vector<std::shared_ptr<Relation> >::size_type pos ){ return dependencies_[pos]; }
         std::size_t size(){ return dependencies_.size(); }
     private:
+        bool publish(int memfd = -1);
+        void notify_records();
         std::pair<std::string, std::string> kvp_;
         std::vector<std::shared_ptr<Relation> > dependencies_;
         std::size_t depth_;
         std::filesystem::path path_;
         std::mutex mtx_;
+        std::atomic<bool> complete_{false};
+        ActionManifest* manifest_{nullptr};
+        std::size_t position_{0};
+        // Published results are kept until the relation is destroyed, so that readers never need the lock.
+        std::atomic<const RelationResult*> result_{nullptr};
+        std::vector<std::unique_ptr<const RelationResult> > results_;
+        // Streamed records.
+        bool stream_{false};
+        std::mutex records_mtx_;
+        std::string records_;
+        bool records_closed_{false};
+        std::vector<int> records_watchers_;
     };
 }//namespace app
 }//namesapce controller
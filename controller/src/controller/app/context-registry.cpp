@@ -0,0 +1,195 @@
+#include "context-registry.hpp"
+#include "execution-context.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include <application-servers/http/http-session.hpp>
+
+namespace controller{
+namespace app{
+    /* Context Registry Static Members */
+    std::mutex ContextRegistry::signals_mtx_;
+    std::unordered_map<const ExecutionContext*, ContextRegistry*> ContextRegistry::owners_;
+    std::unordered_map<UUID::Uuid, ContextRegistry*, UuidHash> ContextRegistry::index_;
+
+    const ContextRegistry* ContextRegistry::owner(const UUID::Uuid& uuid)
+    {
+        std::unique_lock<std::mutex> lk(signals_mtx_);
+        auto it = index_.find(uuid);
+        return (it == index_.end()) ? nullptr : it->second;
+    }
+
+    void ContextRegistry::signal(const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        std::unique_lock<std::mutex> lk(signals_mtx_);
+        auto it = owners_.find(ctx_ptr.get());
+        if(it != owners_.end()){
+            it->second->signals_.push_back(ctx_ptr);
+        }
+        return;
+    }
+
+    const UUID::Uuid& ContextRegistry::uuid_of(const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        return ctx_ptr->execution_context_id();
+    }
+    // End of Context Registry Static Members
+
+    bool ContextRegistry::empty() const
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        return contexts_.empty();
+    }
+
+    std::size_t ContextRegistry::size() const
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        return contexts_.size();
+    }
+
+    std::shared_ptr<ExecutionContext> ContextRegistry::find(const UUID::Uuid& uuid) const
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto it = contexts_.find(uuid);
+        return (it == contexts_.end()) ? std::shared_ptr<ExecutionContext>() : it->second;
+    }
+
+    std::shared_ptr<ExecutionContext> ContextRegistry::find(const std::shared_ptr<http::HttpSession>& session) const
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto it = server_sessions_.find(session.get());
+        return (it == server_sessions_.end()) ? std::shared_ptr<ExecutionContext>() : it->second;
+    }
+
+    std::shared_ptr<ExecutionContext> ContextRegistry::find(const std::shared_ptr<http::HttpClientSession>& session) const
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto it = client_sessions_.find(session.get());
+        return (it == client_sessions_.end()) ? std::shared_ptr<ExecutionContext>() : it->second;
+    }
+
+    bool ContextRegistry::insert(const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        // The index and the registry are updated together, so that a context is never registered by two shards.
+        std::unique_lock<std::mutex> slk(signals_mtx_);
+        auto [it, inserted] = index_.emplace(ctx_ptr->execution_context_id(), this);
+        if(!inserted && it->second != this){
+            return false;
+        }
+        owners_[ctx_ptr.get()] = this;
+        std::unique_lock<std::mutex> lk(mtx_);
+        contexts_[ctx_ptr->execution_context_id()] = ctx_ptr;
+        return true;
+    }
+
+    void ContextRegistry::erase(const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        std::unique_lock<std::mutex> slk(signals_mtx_);
+        std::unique_lock<std::mutex> lk(mtx_);
+        for(auto& session: ctx_ptr->peer_server_sessions()){
+            server_sessions_.erase(session.get());
+        }
+        for(auto& session: ctx_ptr->peer_client_sessions()){
+            client_sessions_.erase(session.get());
+        }
+        auto it = contexts_.find(ctx_ptr->execution_context_id());
+        if(it != contexts_.end() && it->second == ctx_ptr){
+            contexts_.erase(it);
+            auto owner = owners_.find(ctx_ptr.get());
+            if(owner != owners_.end() && owner->second == this){
+                owners_.erase(owner);
+            }
+            auto idx = index_.find(ctx_ptr->execution_context_id());
+            if(idx != index_.end() && idx->second == this){
+                index_.erase(idx);
+            }
+        }
+        return;
+    }
+
+    void ContextRegistry::bind(const std::shared_ptr<http::HttpSession>& session, const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        ctx_ptr->peer_server_sessions().push_back(session);
+        server_sessions_[session.get()] = ctx_ptr;
+        return;
+    }
+
+    void ContextRegistry::bind(const std::shared_ptr<http::HttpClientSession>& session, const std::shared_ptr<ExecutionContext>& ctx_ptr)
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        ctx_ptr->peer_client_sessions().push_back(session);
+        client_sessions_[session.get()] = ctx_ptr;
+        return;
+    }
+
+    void ContextRegistry::unbind(const std::shared_ptr<http::HttpSession>& session)
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto it = server_sessions_.find(session.get());
+        if(it == server_sessions_.end()){
+            return;
+        }
+        auto& sessions = it->second->peer_server_sessions();
+        // Sessions are usually unbound from the back of the list.
+        auto tmp = std::find(sessions.rbegin(), sessions.rend(), session);
+        if(tmp != sessions.rend()){
+            sessions.erase(std::next(tmp).base());
+        }
+        server_sessions_.erase(it);
+        return;
+    }
+
+    void ContextRegistry::unbind(const std::shared_ptr<http::HttpClientSession>& session)
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        auto it = client_sessions_.find(session.get());
+        if(it == client_sessions_.end()){
+            return;
+        }
+        auto& sessions = it->second->peer_client_sessions();
+        // Sessions are usually unbound from the back of the list.
+        auto tmp = std::find(sessions.rbegin(), sessions.rend(), session);
+        if(tmp != sessions.rend()){
+            sessions.erase(std::next(tmp).base());
+        }
+        client_sessions_.erase(it);
+        return;
+    }
+
+    ContextRegistry::~ContextRegistry()
+    {
+        std::unique_lock<std::mutex> lk(signals_mtx_);
+        for(auto it = owners_.begin(); it != owners_.end();){
+            if(it->second == this){
+                it = owners_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for(auto it = index_.begin(); it != index_.end();){
+            if(it->second == this){
+                it = index_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<ExecutionContext> > ContextRegistry::signaled()
+    {
+        std::vector<std::shared_ptr<ExecutionContext> > tmp;
+        std::unique_lock<std::mutex> lk(signals_mtx_);
+        tmp.swap(signals_);
+        lk.unlock();
+        std::unordered_set<const ExecutionContext*> visited;
+        std::vector<std::shared_ptr<ExecutionContext> > ctx_ptrs;
+        ctx_ptrs.reserve(tmp.size());
+        for(auto& ctx_ptr: tmp){
+            if(visited.insert(ctx_ptr.get()).second && contains(ctx_ptr)){
+                ctx_ptrs.push_back(std::move(ctx_ptr));
+            }
+        }
+        return ctx_ptrs;
+    }
+}//namespace app
+}//namespace controller
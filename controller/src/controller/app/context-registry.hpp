@@ -0,0 +1,89 @@
+#ifndef CONTEXT_REGISTRY_HPP
+#define CONTEXT_REGISTRY_HPP
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+#include <uuid/uuid.hpp>
+
+/* Forward Declarations */
+namespace controller{
+namespace app{
+    class ExecutionContext;
+}
+}
+namespace http{
+    class HttpSession;
+    class HttpClientSession;
+}
+
+namespace controller{
+namespace app{
+    /* Version 4 UUIDs are almost entirely random, so their first and last 8 bytes are already good hashes. */
+    struct UuidHash
+    {
+        std::size_t operator()(const UUID::Uuid& uuid) const {
+            std::uint64_t lo, hi;
+            std::memcpy(&lo, uuid.bytes, sizeof(lo));
+            std::memcpy(&hi, uuid.bytes + sizeof(lo), sizeof(hi));
+            return static_cast<std::size_t>(lo ^ hi);
+        }
+    };
+
+    /* The execution contexts of the controller, indexed by execution context id and by peer session. */
+    // Peer sessions are bound to a context through the registry so that the session indexes are kept in step with the
+    // peer session lists of the context. Sessions can be bound from the io threads, so the indexes are locked.
+    // Threads that raise CTL_IO_SCHED_END_EVENT also signal their context, and the controller only visits the
+    // signaled contexts instead of scanning every context for stopped threads. When the controller is sharded,
+    // every shard has its own registry and signals are queued on the registry that the context was inserted into.
+    // Requests for a context can reach any shard, so execution context ids are also indexed across the process, and
+    // requests are routed on the shard that owns the context.
+    class ContextRegistry
+    {
+    public:
+        ContextRegistry() = default;
+        ContextRegistry(const ContextRegistry&) = delete;
+        ContextRegistry& operator=(const ContextRegistry&) = delete;
+        ~ContextRegistry();
+
+        std::shared_ptr<ExecutionContext> find(const UUID::Uuid& uuid) const;
+        std::shared_ptr<ExecutionContext> find(const std::shared_ptr<http::HttpSession>& session) const;
+        std::shared_ptr<ExecutionContext> find(const std::shared_ptr<http::HttpClientSession>& session) const;
+        bool contains(const std::shared_ptr<ExecutionContext>& ctx_ptr) const { return (find(uuid_of(ctx_ptr)) == ctx_ptr); }
+        // Returns false without inserting the context if another registry holds a context with the same id.
+        bool insert(const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        void erase(const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        bool empty() const;
+        std::size_t size() const;
+
+        // Appends the session to the peer sessions of the context, and indexes it.
+        void bind(const std::shared_ptr<http::HttpSession>& session, const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        void bind(const std::shared_ptr<http::HttpClientSession>& session, const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        // Removes the session from the peer sessions of its context.
+        void unbind(const std::shared_ptr<http::HttpSession>& session);
+        void unbind(const std::shared_ptr<http::HttpClientSession>& session);
+
+        // The registry that holds the context with this id, or nullptr. Registries live as long as the process.
+        static const ContextRegistry* owner(const UUID::Uuid& uuid);
+        // Executor threads and the executor reactor signal contexts without holding a reference to the registry.
+        static void signal(const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        // Drains the signaled contexts that are still registered, without duplicates.
+        std::vector<std::shared_ptr<ExecutionContext> > signaled();
+    private:
+        static const UUID::Uuid& uuid_of(const std::shared_ptr<ExecutionContext>& ctx_ptr);
+        // The owning registry of every registered context and context id, and the pending signals of every registry.
+        static std::mutex signals_mtx_;
+        static std::unordered_map<const ExecutionContext*, ContextRegistry*> owners_;
+        static std::unordered_map<UUID::Uuid, ContextRegistry*, UuidHash> index_;
+
+        std::vector<std::shared_ptr<ExecutionContext> > signals_;
+
+        mutable std::mutex mtx_;
+        std::unordered_map<UUID::Uuid, std::shared_ptr<ExecutionContext>, UuidHash> contexts_;
+        std::unordered_map<const http::HttpSession*, std::shared_ptr<ExecutionContext> > server_sessions_;
+        std::unordered_map<const http::HttpClientSession*, std::shared_ptr<ExecutionContext> > client_sessions_;
+    };
+}//namespace app
+}//namespace controller
+#endif
@@ -2,6 +2,10 @@
 #include "../controller-events.hpp"
 #include <application-servers/http/http-session.hpp>
 #include "execution-context.hpp"
+#include "zygote.hpp"
+#include "process-reaper.hpp"
+#include "executor-reactor.hpp"
+#include "executor-cgroup.hpp"
 #include "action-relation.hpp"
 #include "../resources/resources.hpp"
 #include <charconv>
@@ -10,79 +14,6 @@
 
 #define CONTROLLER_APP_COMMON_HTTP_HEADERS {http::HttpHeaderField::CONTENT_TYPE, "application/json", "", false, false, false, false, false, false},{http::HttpHeaderField::CONNECTION, "close", "", false, false, false, false, false, false},{http::HttpHeaderField::END_OF_HEADERS, "", "", false, false, false, false, false, false}
 
-static std::string_view find_next_json_object(const std::string& data, std::size_t& pos){
-    std::string_view obj;
-    // Count the number of unclosed braces.
-    std::size_t brace_count = 0;
-    // Count the number of opened square brackets '['.
-    int bracket_count = 0;
-    // Track the start and end positions of 
-    // the top level javascript object.
-    std::size_t next_opening_brace = 0;
-    std::size_t next_closing_brace = 0;
-    for(; pos < data.size(); ++pos){
-        const char& c = data[pos];
-        switch(c)
-        {
-            case '}':
-            {
-                // track the last found closing brace as we go through the loop.
-                if(brace_count == 0){
-                    // ignore spurious closing braces.
-                    continue;
-                }
-                --brace_count;
-                if(brace_count == 0){
-                    next_closing_brace = pos;
-                    ++pos;
-                    goto exit_loop;
-                }
-                break;
-            }
-            case '{':
-            {
-                if(brace_count == 0){
-                    next_opening_brace = pos;
-                }
-                ++brace_count;
-                break;
-            }
-            case ',':
-            {
-                if(next_closing_brace > next_opening_brace){
-                    // Once we find a trailing top level comma, then we know that we have reached the end of 
-                    // a javascript object.
-                    ++pos;
-                    goto exit_loop;
-                }
-                break;
-            }
-            case ']':
-            {
-                --bracket_count;
-                if(next_closing_brace >= next_opening_brace && brace_count == 0 && bracket_count <= 0){
-                    /* Function is complete. Terminate the execution context */
-                    obj = std::string_view(&c, 1);
-                    ++pos;
-                    return obj;
-                }
-                break;
-            }
-            case '[':
-            {
-                ++bracket_count;
-                break;
-            }
-        }
-    }
-    exit_loop: ;
-    if(next_closing_brace > next_opening_brace){
-        std::size_t sz = next_closing_brace - next_opening_brace + 1;
-        obj = std::string_view(&data[next_opening_brace], sz);
-    }
-    return obj;
-}
-
 static std::string rtostr(const server::Remote& raddr){
     std::array<char,5> pbuf;
     std::string port;
@@ -357,6 +288,23 @@ static void make_api_requests(const std::shared_ptr<controller::app::ExecutionCo
     return;
 }
 
+static std::chrono::time_point<std::chrono::steady_clock> activation_deadline(const std::map<std::string, std::string>& env)
+{
+    // __OW_DEADLINE is the activation deadline in milliseconds since the unix epoch.
+    auto it = env.find("__OW_DEADLINE");
+    if(it == env.end()){
+        return std::chrono::time_point<std::chrono::steady_clock>::max();
+    }
+    std::int64_t deadline_ms = 0;
+    const std::string& value = it->second;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), deadline_ms);
+    if(ec != std::errc() || deadline_ms <= 0){
+        return std::chrono::time_point<std::chrono::steady_clock>::max();
+    }
+    auto remaining = std::chrono::system_clock::time_point(std::chrono::milliseconds(deadline_ms)) - std::chrono::system_clock::now();
+    return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining);
+}
+
 static void initialize_executor(
     controller::app::ThreadControls& thread_control, 
     std::shared_ptr<controller::io::MessageBox> mbox_ptr, 
@@ -366,14 +314,25 @@ static void initialize_executor(
     std::ptrdiff_t offset
 )
 {
+    if(controller::app::ExecutorCgroup::enabled()){
+        // Relations at the head of longer chains of dependent relations get a larger share of the CPU.
+        std::size_t height = ctx_ptr->manifest().height(thread_control.relation->position());
+        thread_control.cpu_weight = controller::app::ExecutorCgroup::DEFAULT_CPU_WEIGHT * height;
+    }
     // Fork exec the executor subprocess.
     if(thread_control.thread_continue()){
         if(thread_control.is_stopped()){
             thread_control.cleanup();
+            controller::app::ContextRegistry::signal(ctx_ptr);
             mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
             mbox_ptr->sched_signal_cv_ptr->notify_one();
             return;
         }
+        if(controller::app::ExecutorReactor::enabled()){
+            // The reactor drives the launcher from here on, without a dedicated executor thread.
+            controller::app::ExecutorReactor::add(ctx_ptr, (idx + offset) % manifest_size, mbox_ptr);
+            return;
+        }
         std::condition_variable sync;
         std::atomic<bool> sflag;
         sflag.store(false, std::memory_order::memory_order_relaxed);
@@ -388,6 +347,7 @@ static void initialize_executor(
                         sync.notify_one();
                         if(thread_control.is_stopped()){
                             thread_control.cleanup();
+                            controller::app::ContextRegistry::signal(ctx_ptr);
                             mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
                             mbox_ptr->sched_signal_cv_ptr->notify_one();
                             return;
@@ -397,6 +357,7 @@ static void initialize_executor(
                             thread_control.wait();
                             if(thread_control.is_stopped()){
                                 thread_control.cleanup();
+                                controller::app::ContextRegistry::signal(ctx_ptr);
                                 mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
                                 mbox_ptr->sched_signal_cv_ptr->notify_one();
                                 return;
@@ -406,12 +367,14 @@ static void initialize_executor(
                             while(thread_control.thread_continue()){
                                 if(thread_control.is_stopped()){
                                     thread_control.cleanup();
+                                    controller::app::ContextRegistry::signal(ctx_ptr);
                                     mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
                                     mbox_ptr->sched_signal_cv_ptr->notify_one();
                                     return;
                                 }
                             }
                             thread_control.signal().fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+                            controller::app::ContextRegistry::signal(ctx_ptr);
                             mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
                             mbox_ptr->sched_signal_cv_ptr->notify_one();
                             return;
@@ -451,13 +414,12 @@ static void reschedule_actions(
 {
     std::size_t manifest_size = manifest.size();
     auto execution_idxs = thread.stop_thread();
+    controller::app::ContextRegistry::signal(ctxp);
     mbox->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
     mbox->sched_signal_cv_ptr->notify_one();
     for(auto& i: execution_idxs){
         // Get the starting relation.
-        auto& relation = manifest[i % manifest_size];
-        std::string start_key(relation->key());
-        std::shared_ptr<controller::app::Relation> start = manifest.next(start_key, i);
+        std::shared_ptr<controller::app::Relation> start = manifest.next(i % manifest_size, i);
         if(start->key().empty()){
             // // If the start key is empty, that means that all tasks in the schedule are complete.
             // // First set any missing values in the schedule to null to prevent any more updates.
@@ -478,9 +440,7 @@ static void reschedule_actions(
             return;
         } else {
             // Find the index in the manifest of the starting relation.
-            auto start_it = std::find_if(manifest.begin(), manifest.end(), [&](auto& rel){
-                return rel->key() == start->key();
-            });
+            auto start_it = manifest.begin() + manifest.position(start->key());
             if(start_it == manifest.end()){
                 std::cerr << "controller-app.cpp:460:Relation doesn't exist in the manifest???" << std::endl;
                 throw "what?";
@@ -657,14 +617,23 @@ namespace libcurl{
 
 namespace controller{
 namespace app{
+    /* Controller Static Members */
+    std::atomic<bool> Controller::initialized_{false};
+    std::mutex Controller::shards_mtx_;
+    std::vector<Controller*> Controller::shards_;
+    // End of Controller Static Members
+
     Controller::Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc)
       : controller_mbox_ptr_(mbox_ptr),
-        initialized_{false},
         curl_mhnd_ptr_(std::make_shared<libcurl::CurlMultiHandle>()),
         io_mbox_ptr_(std::make_shared<controller::io::MessageBox>()),
         io_(io_mbox_ptr_, "/run/controller/controller.sock", ioc, &num_running_multi_handles_, curl_mhnd_ptr_),
         ioc_(ioc)
     {
+        ProcessReaper::init(ioc_);
+        ExecutorCgroup::init();
+        // A launcher pool that is not persistent fails at startup, rather than on the first activation.
+        LauncherPool::enabled();
         try{
             std::thread application(
                 &Controller::start, this
@@ -677,14 +646,23 @@ namespace app{
         }
     }
 
-    Controller::Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc, const std::filesystem::path& upath, std::uint16_t sport)
+    Controller::Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc, const std::filesystem::path& upath, std::uint16_t sport, std::size_t shard)
       : controller_mbox_ptr_(mbox_ptr),
-        initialized_{false},
         curl_mhnd_ptr_(std::make_shared<libcurl::CurlMultiHandle>()),
         io_mbox_ptr_(std::make_shared<controller::io::MessageBox>()),
-        io_(io_mbox_ptr_, upath.string(), ioc, sport, &num_running_multi_handles_, curl_mhnd_ptr_),
+        io_(io_mbox_ptr_, upath.string(), ioc, sport, &num_running_multi_handles_, curl_mhnd_ptr_, shard),
         ioc_(ioc)
     {
+        if(shard == 0){
+            // Executors are reaped, and the executor cgroups are managed, for the whole process.
+            ProcessReaper::init(ioc_);
+            ExecutorCgroup::init();
+            // A launcher pool that is not persistent fails at startup, rather than on the first activation.
+            LauncherPool::enabled();
+        }
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        shards_.push_back(this);
+        lk.unlock();
         try{
             std::thread application(
                 &Controller::start, this
@@ -725,22 +703,17 @@ namespace app{
             #endif
 
             server_session = std::shared_ptr<server::Session>();
-            lk.lock();
-            if(io_.mq_is_empty()){
+            // The loop only parks on the scheduler condition variable when there is nothing to do.
+            if(io_.mq_is_empty() && !(io_signalp->load(std::memory_order::memory_order_relaxed) & ~CTL_TERMINATE_EVENT)){
+                lk.lock();
                 io_cvp->wait_for(lk, std::chrono::milliseconds(10000), [&]{ 
                     return (!io_.mq_is_empty() || (io_signalp->load(std::memory_order::memory_order_relaxed) & ~CTL_TERMINATE_EVENT)); 
                 });
+                lk.unlock();
             }
             thread_local_signal = io_signalp->load(std::memory_order::memory_order_relaxed);
             io_signalp->fetch_and(~(thread_local_signal & ~CTL_TERMINATE_EVENT), std::memory_order::memory_order_relaxed);
-            if(!io_.mq_is_empty()){
-                auto msg = io_.mq_pull();
-                if(msg){
-                    server_session = msg->session;
-                }
-                io_cvp->notify_one();
-            }                 
-            lk.unlock();
+            io_.mq_pull(server_session);
             if(thread_local_signal & CTL_TERMINATE_EVENT){
                 if(hs_.empty() && ctx_ptrs.empty() && hcs_.empty()){
                     destruct_.store(true, std::memory_order::memory_order_relaxed);
@@ -755,15 +728,14 @@ namespace app{
             if(server_session){
                 // clock_gettime(CLOCK_MONOTONIC, &troute[0]);
                 std::shared_ptr<http::HttpSession> http_session_ptr;
-                auto http_client = std::find_if(hcs_.begin(), hcs_.end(), [&](auto& hc){
-                    return *hc == server_session;
-                });
-                if(http_client != hcs_.end()){
+                // Transport sessions point back to the http session that they are bound to.
+                auto http_client = hcs_.find(server_session);
+                if(http_client){
                     #ifdef DEBUG
                     clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "controller-app.cpp:754:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":ROUTE_HTTP_CLIENT_RESPONSE:" << std::endl; 
                     #endif 
                     /* if it is in the http client server list, then we treat this as an incoming response to a client session. */
-                    std::shared_ptr<http::HttpClientSession> http_client_ptr = std::static_pointer_cast<http::HttpClientSession>(*http_client);
+                    std::shared_ptr<http::HttpClientSession> http_client_ptr = std::static_pointer_cast<http::HttpClientSession>(http_client);
                     try{
                         http_client_ptr->read();
                         route_response(http_client_ptr);
@@ -774,10 +746,8 @@ namespace app{
                     }
                 } else {
                     /* Otherwise by default any read request must be a server session. */
-                    auto http_session_it = std::find_if(hs_.begin(), hs_.end(), [&](auto& ptr){
-                        return *ptr == server_session;
-                    });
-                    if( http_session_it == hs_.end() ){
+                    auto http_session = hs_.find(server_session);
+                    if(!http_session){
                         http_session_ptr = std::make_shared<http::HttpSession>(hs_, server_session);
                         http_session_ptr->read();
                         if(std::get<http::HttpRequest>(*http_session_ptr).verb_started){
@@ -789,7 +759,7 @@ namespace app{
                         }
                     } else {
                         // For our application all session pointers are http session pointers.
-                        http_session_ptr = std::static_pointer_cast<http::HttpSession>(*http_session_it);
+                        http_session_ptr = std::static_pointer_cast<http::HttpSession>(http_session);
                         // We are not supporting HTTP/1.1 pipelining. So if a client request http chunk is received AFTER the 
                         // server response has been completed, but BEFORE the server response has been received by the client, then
                         // we simply drop the client request http chunk.
@@ -798,7 +768,7 @@ namespace app{
                         auto it = std::find_if(server_res.headers.begin(), server_res.headers.end(), [&](auto& header){
                             return (header.field_name == http::HttpHeaderField::CONTENT_LENGTH);
                         });
-                        if((it != server_res.headers.end()) || (server_res.chunks.size() > 0 && server_res.chunks.back().chunk_size != http::HttpBigNum{0})){
+                        if((it != server_res.headers.end()) || (server_res.chunks.size() > 0 && server_res.chunks.back().chunk_size != 0)){
                             #ifdef DEBUG
                             clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "controller-app.cpp:784:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":ROUTE_HTTP_CLIENT_REQUEST:" << std::endl;
                             #endif
@@ -815,16 +785,24 @@ namespace app{
                 clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "controller-app.cpp:794:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":SCHED_ENTER:" << std::endl;
                 #endif
                 // Some administration.
-                while(waitpid(-1, nullptr, WNOHANG) > 0){}
+                if(ProcessReaper::polling()){
+                    // Executors are reaped on the io_context when pidfds are available.
+                    pid_t pid = 0;
+                    while((pid = waitpid(-1, nullptr, WNOHANG)) > 0){
+                        ExecutorCgroup::release(pid);
+                    }
+                    ProcessReaper::poll();
+                }
+                // Only the contexts that have been signaled since the last event can have stopped threads.
+                std::vector<std::shared_ptr<ExecutionContext> > signaled = ctx_ptrs.signaled();
                 // Find stopped contexts:
-                auto stopped = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto& ctxp){
-                    return (ctxp->is_stopped());
-                });
-                while(stopped != ctx_ptrs.end()){
+                for(auto& ctxp: signaled){
+                    if(!ctxp->is_stopped()){
+                        continue;
+                    }
                     #ifdef DEBUG
                     clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "controller-app.cpp:802:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":PROCESS_STOPPED_CTXS:" << std::endl;
                     #endif
-                    auto& ctxp = *stopped;
                     std::string data;
                     // Find threads that still have pending scheduling indices so haven't been handled.
                     std::size_t i = 0;
@@ -833,23 +811,14 @@ namespace app{
                             thread.pop_idxs();
                         }
                         auto& finished = ctxp->manifest()[i];
-                        std::string f_key(finished->key());
-                        std::string f_val(finished->acquire_value());
-                        finished->release_value();
-                        if(!f_val.empty() && f_val != "null"){
-                            boost::json::object jo;
-                            boost::json::error_code ec;
-                            boost::json::value jv = boost::json::parse(f_val, ec);
-                            if(ec){
-                                std::cerr << "controller-app.cpp:825:JSON parsing failed:" << ec.message() << ":value:" << f_val << std::endl;
-                                throw "This shouldn't happend.";
-                            }
-                            jo.emplace(f_key, jv);
-                            boost::json::object jf_val;
-                            jf_val.emplace("result", jo);
-                            data.append(",");
-                            std::string jsonf_val(boost::json::serialize(jf_val));
-                            data.append(jsonf_val);
+                        const RelationResult* result = finished->result();
+                        if(result != nullptr && !result->value.is_null()){
+                            // The state update is {"result":{key:value}}, the value is spliced in without reserializing it.
+                            data.append(",{\"result\":{");
+                            data.append(boost::json::serialize(boost::json::value(finished->key())));
+                            data.append(":");
+                            data.append(result->serialized);
+                            data.append("}}");
                         }
                         ++i;
                     }
@@ -869,6 +838,16 @@ namespace app{
                                 const auto& env = ctxp->env();
                                 std::string id = env.at("__OW_ACTIVATION_ID");
                                 std::cout << "controller-app.cpp:819:activation_id=" << id << ":run duration=" << duration.count() << "ms" << std::endl;
+                                if(!ProcessReaper::polling()){
+                                    std::cout << "controller-app.cpp:880:executors reaped=" << ProcessReaper::reaped() << ":signaled=" << ProcessReaper::signaled() << ":cpu time=" << ProcessReaper::cpu_time().count() << "us" << std::endl;
+                                }
+                                if(LauncherPool::enabled()){
+                                    std::cout << "controller-app.cpp:883:launcher pool hits=" << LauncherPool::hits() << ":misses=" << LauncherPool::misses() << std::endl;
+                                }
+                                std::cout << "controller-app.cpp:921:message queue depth=" << io_.mq().depth() << ":max depth=" << io_.mq().max_depth() << ":mean wait=" << std::chrono::duration_cast<std::chrono::microseconds>(io_.mq().mean_wait()).count() << "us:full waits=" << io_.mq().full_waits() << ":full wait time=" << std::chrono::duration_cast<std::chrono::microseconds>(io_.mq().full_wait_time()).count() << "us" << std::endl;
+                                if(ThreadControls::sched_policy() != SchedPolicy::ROUND_ROBIN){
+                                    std::cout << "controller-app.cpp:925:deadlines met=" << ThreadControls::deadline_hits() << ":missed=" << ThreadControls::deadline_misses() << ":relation time=" << std::chrono::duration_cast<std::chrono::microseconds>(ThreadControls::relation_time()).count() << "us" << std::endl;
+                                }
                                 #endif
                                 next_session->close();
                             }
@@ -890,7 +869,7 @@ namespace app{
                         next_session->write([&,next_session](const std::error_code&){
                             next_session->close();
                         });
-                        ctxp->peer_server_sessions().pop_back();
+                        ctx_ptrs.unbind(next_session);
                     }
                     while(ctxp->peer_client_sessions().size() > 0){
                         std::shared_ptr<http::HttpClientSession> next_session = ctxp->peer_client_sessions().back();
@@ -907,28 +886,27 @@ namespace app{
                             }
                             return;
                         });
-                        ctxp->peer_client_sessions().pop_back();
+                        ctx_ptrs.unbind(next_session);
                     }
-                    ctx_ptrs.erase(stopped); // This invalidates the iterator in the loop, so we have to perform the original search again.
-                    // Find a context that has a stopped thread.
-                    stopped = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto& ctxp){
-                        return (ctxp->is_stopped());
-                    });
+                    ctx_ptrs.erase(ctxp);
                     // clock_gettime(CLOCK_REALTIME, &ts);
                     // std::cout << "controller-app.cpp:296:stopped context processing finished:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
                 }
                 // Find contexts that have stopped threads but are not stopped.
-                auto updated = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](std::shared_ptr<ExecutionContext>& ctx_ptr){
-                    auto tmp = std::find_if(ctx_ptr->thread_controls().begin(), ctx_ptr->thread_controls().end(), [&](ThreadControls& thread){
+                for(auto& ctxp: signaled){
+                    if(!ctx_ptrs.contains(ctxp)){
+                        // The context was stopped.
+                        continue;
+                    }
+                    auto stopped_thread = std::find_if(ctxp->thread_controls().begin(), ctxp->thread_controls().end(), [&](ThreadControls& thread){
                         return thread.is_stopped() && thread.has_pending_idxs();
                     });
-                    return (tmp == ctx_ptr->thread_controls().end())? false : true;
-                });
-                while(updated != ctx_ptrs.end()){
+                    if(stopped_thread == ctxp->thread_controls().end()){
+                        continue;
+                    }
                     #ifdef DEBUG
                     clock_gettime(CLOCK_REALTIME, &ts); std::cerr << "controller-app.cpp:903:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":PROCESS_UPDATED_CTXS:" << std::endl;
                     #endif
-                    auto& ctxp = *updated;
                     // Check to see if the context is stopped.
                     // std::string __OW_ACTIVATION_ID = (*it)->env()["__OW_ACTIVATION_ID"];
                     // if(!__OW_ACTIVATION_ID.empty()){
@@ -940,9 +918,6 @@ namespace app{
                     // std::cout << "controller-app.cpp:316:stopped thread processing started:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
 
                     // Evaluate which thread to execute next and notify it.
-                    auto stopped_thread = std::find_if(ctxp->thread_controls().begin(), ctxp->thread_controls().end(), [&](auto& thread){
-                        return thread.is_stopped() && thread.has_pending_idxs();
-                    });
                     // invalidate the thread.
                     std::vector<std::size_t> execution_context_idxs = stopped_thread->pop_idxs();
                     std::ptrdiff_t idx = stopped_thread - ctxp->thread_controls().begin();
@@ -951,23 +926,14 @@ namespace app{
                     // It's only worth constructing the state update values if there are peers to update.
                     if( (ctxp->peer_client_sessions().size() + ctxp->peer_server_sessions().size()) > 0 ){
                         std::shared_ptr<Relation>& finished = ctxp->manifest()[idx];
-                        std::string f_key(finished->key());
-                        std::string f_val(finished->acquire_value());
-                        finished->release_value();
-                        if(!f_val.empty() && !(f_val == "null")){
-                            boost::json::object jo;
-                            boost::json::error_code ec;
-                            boost::json::value jv = boost::json::parse(f_val, ec);
-                            if(ec){
-                                std::cerr << "controller-app.cpp:910:JSON parsing failed:" << ec.message() << ":value:" << f_val << std::endl;
-                                throw "This shouldn't happen.";
-                            }
-                            jo.emplace(f_key, jv);
-                            boost::json::object jf_val;
-                            jf_val.emplace("result", jo);
-                            std::string data(",");
-                            std::string jsonf_val = boost::json::serialize(jf_val);
-                            data.append(jsonf_val);
+                        const RelationResult* result = finished->result();
+                        if(result != nullptr && !result->value.is_null()){
+                            // The state update is {"result":{key:value}}, the value is spliced in without reserializing it.
+                            std::string data(",{\"result\":{");
+                            data.append(boost::json::serialize(boost::json::value(finished->key())));
+                            data.append(":");
+                            data.append(result->serialized);
+                            data.append("}}");
                             for(auto& peer_session: ctxp->peer_client_sessions()){
                                 /* Update peers */
                                 http::HttpReqRes rr = peer_session->get();
@@ -1002,26 +968,23 @@ namespace app{
                             }
                         }
                     }    
-                    // Get the key of the action at this index+1 (mod thread_controls.size())
-                    std::string key(ctxp->manifest()[(++idx)%(ctxp->thread_controls().size())]->key());
+                    // Get the position of the action at this index+1 (mod thread_controls.size())
+                    std::size_t pos = (++idx)%(ctxp->thread_controls().size());
                     for (auto& idx: execution_context_idxs){
-                        // Get the next relation to execute from the dependencies of the relation at this key.
-                        std::shared_ptr<Relation> next = ctxp->manifest().next(key, idx);
+                        // Get the next relation to execute from the dependencies of the relation at this position.
+                        std::shared_ptr<Relation> next = ctxp->manifest().next(pos, idx);
                         // Retrieve the index of this relation in the manifest.
-                        auto next_it = std::find_if(ctxp->manifest().begin(), ctxp->manifest().end(), [&](auto& rel){
-                            return rel->key() == next->key();
-                        });
-                        std::ptrdiff_t next_idx = next_it - ctxp->manifest().begin();
+                        std::ptrdiff_t next_idx = ctxp->manifest().position(next->key());
                         //Start the thread at this index.
                         ctxp->thread_controls()[next_idx].notify(idx);
                     }
-                    // Search through remaining contexts.
-                    updated = std::find_if(++updated, ctx_ptrs.end(), [&](auto& ctx_ptr){
-                        auto tmp = std::find_if(ctx_ptr->thread_controls().begin(), ctx_ptr->thread_controls().end(), [&](auto& thread){
-                            return thread.is_stopped() && thread.has_pending_idxs();
-                        });
-                        return (tmp == ctx_ptr->thread_controls().end())? false : true;
+                    // A context hands over one stopped thread per event, the others are visited on the next event.
+                    auto tmp = std::find_if(ctxp->thread_controls().begin(), ctxp->thread_controls().end(), [&](auto& thread){
+                        return thread.is_stopped() && thread.has_pending_idxs();
                     });
+                    if(tmp != ctxp->thread_controls().end()){
+                        ContextRegistry::signal(ctxp);
+                    }
                 }
             }
             #ifdef DEBUG
@@ -1031,6 +994,31 @@ namespace app{
         return;
     }
 
+    JsonSplitter& Controller::json_splitter(const std::shared_ptr<const void>& session){
+        auto it = json_splitters_.find(session.get());
+        if(it != json_splitters_.end()){
+            std::weak_ptr<const void>& owner = it->second.first;
+            if(!owner.owner_before(session) && !session.owner_before(owner)){
+                return it->second.second;
+            }
+            // The address belongs to a new session.
+            it->second = {session, JsonSplitter()};
+            return it->second.second;
+        }
+        if(json_splitters_.size() >= json_splitters_sweep_){
+            // Sessions that closed in the middle of a body leave their splitters behind.
+            for(auto jt = json_splitters_.begin(); jt != json_splitters_.end();){
+                if(jt->second.first.expired()){
+                    jt = json_splitters_.erase(jt);
+                } else {
+                    ++jt;
+                }
+            }
+            json_splitters_sweep_ = std::max(json_splitters_sweep_, 2*json_splitters_.size());
+        }
+        return json_splitters_.emplace(session.get(), std::make_pair(std::weak_ptr<const void>(session), JsonSplitter())).first->second.second;
+    }
+
     void Controller::route_response(std::shared_ptr<http::HttpClientSession>& session){
         // struct timespec ts = {};
         // clock_gettime(CLOCK_REALTIME, &ts);
@@ -1050,29 +1038,23 @@ namespace app{
                 // clock_gettime(CLOCK_REALTIME, &ts);
                 // std::cout << "controller-app.cpp:410:chunk processing started:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
 
-                std::size_t next_comma = 0;
                 const http::HttpChunk& chunk = res.chunks[res.pos];
                 const http::HttpBigNum& chunk_size = chunk.chunk_size;
-                if(chunk_size == http::HttpBigNum{0}){
+                if(chunk_size == 0){
                     // A 0 length chunk indiciates the end of a session.
+                    erase_json_splitter(session);
                     session->close();
                     return;
                 }
-                while(http::HttpBigNum{next_comma} < chunk_size){
-                    std::string_view json_obj_str = find_next_json_object(chunk.chunk_data, next_comma);
-                    if(json_obj_str.empty()){
-                        std::cerr << "controller-app.cpp:874:json_obj_str is empty" << std::endl;
-                        continue;
-                    } else if (json_obj_str.front() == ']'){
+                JsonSplitter& splitter = json_splitter(session);
+                splitter.feed(chunk.chunk_data);
+                for(std::string_view json_obj_str = splitter.next(); !json_obj_str.empty(); json_obj_str = splitter.next()){
+                    if (json_obj_str.front() == ']'){
                         /* Peer is complete. Terminate the peer session */
-                        for(auto& ctxp: ctx_ptrs){
-                            auto tmp = std::find(ctxp->peer_client_sessions().begin(), ctxp->peer_client_sessions().end(), session);
-                            if(tmp != ctxp->peer_client_sessions().end()){
-                                ctxp->peer_client_sessions().erase(tmp);
-                            }
-                        }
+                        ctx_ptrs.unbind(session);
+                        erase_json_splitter(session);
                         break;
-                    } else if((it != req.headers.end()) || (req.chunks.size() > 0 && req.chunks.back().chunk_size == http::HttpBigNum{0})){
+                    } else if((it != req.headers.end()) || (req.chunks.size() > 0 && req.chunks.back().chunk_size == 0)){
                         // We do not support HTTP/1.1 pipelining so we will only close the HTTP client stream after the ENTIRE server response has
                         // been consumed.
                         break;
@@ -1086,15 +1068,12 @@ namespace app{
                         std::cerr << "controller-app.cpp:1058:JSON parsing failed:" << ec.message() <<":value:" << json_obj_str << std::endl;
                         throw "this shouldn't happen.";
                     }
-                    auto ctx = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto& cp){
-                        auto tmp = std::find(cp->peer_client_sessions().begin(), cp->peer_client_sessions().end(), session);
-                        return (tmp == cp->peer_client_sessions().end()) ? false : true;
-                    });
+                    std::shared_ptr<ExecutionContext> ctx = ctx_ptrs.find(session);
 
                     // clock_gettime(CLOCK_REALTIME, &ts);
                     // std::cout << "controller-app.cpp:486:JSON parsed:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
 
-                    if(ctx == ctx_ptrs.end()){
+                    if(!ctx){
                         session->close();
                         return;
                     } else {
@@ -1110,10 +1089,10 @@ namespace app{
                             for(auto& peer: ja){
                                 peers.emplace_back(peer.as_string());
                             }
-                            std::vector<server::Remote> old_peers = (*ctx)->get_peers();
-                            (*ctx)->merge_peer_addresses(peers);
-                            std::vector<server::Remote> new_peers = (*ctx)->get_peers();
-                            std::shared_ptr<controller::app::ExecutionContext>& ctx_ptr = *ctx;
+                            std::vector<server::Remote> old_peers = ctx->get_peers();
+                            ctx->merge_peer_addresses(peers);
+                            std::vector<server::Remote> new_peers = ctx->get_peers();
+                            std::shared_ptr<controller::app::ExecutionContext>& ctx_ptr = ctx;
                             boost::json::object jo;
                             UUID::Uuid uuid = ctx_ptr->execution_context_id();
                             std::stringstream uuid_str;
@@ -1159,7 +1138,7 @@ namespace app{
                                             hcs_.push_back(client_session);
                                             hcs_.release();
                                             ctx_ptr->acquire();
-                                            ctx_ptr->peer_client_sessions().push_back(client_session);  
+                                            ctx_ptrs.bind(client_session, ctx_ptr);
                                             ctx_ptr->release();
                                             client_session->set(http::HttpReqRes({nreq,{}}));
                                             client_session->write([&, client_session](const std::error_code& ec){ 
@@ -1182,10 +1161,10 @@ namespace app{
                         }
                         for(auto& kvp: jr){
                             std::string k(kvp.key());
-                            auto rel = std::find_if((*ctx)->manifest().begin(), (*ctx)->manifest().end(), [&](auto& r){
+                            auto rel = std::find_if(ctx->manifest().begin(), ctx->manifest().end(), [&](auto& r){
                                 return r->key() == k;
                             });
-                            if(rel == (*ctx)->manifest().end()){
+                            if(rel == ctx->manifest().end()){
                                 std::cerr << "No relation with this key could be found in the manifest." << std::endl;
                                 throw "This shouldn't be possible";
                             }
@@ -1201,7 +1180,7 @@ namespace app{
                             }
                             (*rel)->release_value();
 
-                            auto& ctxp = *ctx;
+                            auto& ctxp = ctx;
                             std::ptrdiff_t idx = rel - (ctxp)->manifest().begin();
                             auto& thread_controls = ctxp->thread_controls();
                             auto& manifest = ctxp->manifest();
@@ -1229,15 +1208,12 @@ namespace app{
             // clock_gettime(CLOCK_REALTIME, &ts);
             // std::cout << "controller-app.cpp:640:http:HttpStatus::Created started:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
         } else {
-            auto server_ctx = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto ctx_ptr){
-                auto tmp = std::find(ctx_ptr->peer_client_sessions().begin(), ctx_ptr->peer_client_sessions().end(), session);
-                return (tmp == ctx_ptr->peer_client_sessions().end()) ? false : true;
-            });
-            if(server_ctx == ctx_ptrs.end()){
+            std::shared_ptr<ExecutionContext> server_ctx = ctx_ptrs.find(session);
+            if(!server_ctx){
                 // The doesn't belong to a context so just close it.
                 session->close();
             } else {
-                auto& ctx_ptr = *server_ctx;
+                auto& ctx_ptr = server_ctx;
                 std::vector<server::Remote> peers = ctx_ptr->get_peers();
                 if(peers.size() < 3){
                     // A peer list size of 1 indicates that the only peer is myself.
@@ -1254,6 +1230,7 @@ namespace app{
                         relation->release_value();
                         thread.stop_thread();
                     }
+                    ContextRegistry::signal(ctx_ptr);
                     io_mbox_ptr_->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
                     io_mbox_ptr_->sched_signal_cv_ptr->notify_one();
                 } else {
@@ -1292,35 +1269,30 @@ namespace app{
             // {...}, {...}, {...}
             // with no leading or trailing brackets.
             // Finally, the closing brace that we need to look for is the closing brace of the entire JSON object, and not of 
-            // any nested objects. So we must search for the closing brace from the comma delimiter position in reverse.
+            // any nested objects. The session's JsonSplitter tracks the nesting depth
+            // outside of string values across the chunks of the stream, and yields each object when its closing brace is found.
             for(; req.pos < req.next_chunk; ++req.pos){
                 // clock_gettime(CLOCK_REALTIME, &ts);
                 // std::cout << "controller-app.cpp:716:chunk processing started:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
-                std::size_t next_comma = 0;
                 const http::HttpChunk& chunk = req.chunks[req.pos];
                 const http::HttpBigNum& chunk_size = chunk.chunk_size;
 
-                if(chunk_size == http::HttpBigNum{0}){
+                if(chunk_size == 0){
                     // A 0 length chunk means that the entire HTTP Request has been consumed.
                     // We have to maintain the session until the entire HTTP response has been completely processed.
+                    erase_json_splitter(session);
                     return;
                 }
 
-                while(http::HttpBigNum{next_comma} < chunk_size){
+                JsonSplitter& splitter = json_splitter(session);
+                splitter.feed(chunk.chunk_data);
+                for(std::string_view json_obj_str = splitter.next(); !json_obj_str.empty(); json_obj_str = splitter.next()){
                     // struct timespec tjson[2] = {};
                     // clock_gettime(CLOCK_MONOTONIC, &tjson[0]);
-                    std::string_view json_obj_str = find_next_json_object(chunk.chunk_data, next_comma);
-                    if(json_obj_str.empty()){
-                        std::cerr << "controller-app.cpp:1173:json_obj_str is empty" << std::endl;
-                        continue;
-                    } else if(json_obj_str.front() == ']'){
+                    if(json_obj_str.front() == ']'){
                         /* Peer is complete. Terminate the peer session */
-                        for(auto& ctxp: ctx_ptrs){
-                            auto tmp = std::find(ctxp->peer_server_sessions().begin(), ctxp->peer_server_sessions().end(), session);
-                            if(tmp != ctxp->peer_server_sessions().end()){
-                                ctxp->peer_server_sessions().erase(tmp);
-                            }
-                        }
+                        ctx_ptrs.unbind(session);
+                        erase_json_splitter(session);
                         break;
                     }
 
@@ -1339,285 +1311,9 @@ namespace app{
 
                     if(req.route == "/run"){
                         if(req.verb == http::HttpVerb::POST){
-                            // clock_gettime(CLOCK_REALTIME, &ts);
-                            // std::cout << "controller-app.cpp:792:/run POST:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
-                            // struct timespec ts[2] = {};
-                            // clock_gettime(CLOCK_MONOTONIC, &ts[0]);
-                            boost::json::object json_obj;
-                            try{
-                                json_obj = val.as_object();
-                            } catch(std::invalid_argument& e){
-                                std::cerr << "controller-app.cpp:1326:val is not an object:" << boost::json::serialize(val) << std::endl;
-                                throw e;
-                            }
-                            controller::resources::run::Request run(json_obj);
-                            auto env = run.env();
-                            // std::string __OW_ACTIVATION_ID = env["__OW_ACTIVATION_ID"];
-                            // if(!__OW_ACTIVATION_ID.empty()){
-                            //     struct timespec ts = {};
-                            //     int status = clock_gettime(CLOCK_REALTIME, &ts);
-                            //     if(status != -1){
-                            //         std::cout << "controller-app.cpp:728:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":__OW_ACTIVATION_ID=" << __OW_ACTIVATION_ID << std::endl;
-                            //     }
-                            // }
-                            // Create a fiber continuation for processing the request.
-                            std::shared_ptr<ExecutionContext> ctx_ptr = controller::resources::run::handle(run, ctx_ptrs); 
-                            auto http_it = std::find(ctx_ptr->sessions().cbegin(), ctx_ptr->sessions().cend(), session);
-                            if(http_it == ctx_ptr->sessions().cend()){
-                                ctx_ptr->sessions().push_back(session);
-                            }
-                            ctx_ptr->env() = env;
-                            if (initialized_){
-                                // Initialize threads only once.
-                                // If ctx_ptr is already in the controller ctx_ptrs then threads don't need to be initialized again.
-                                auto ctx_it = std::find(ctx_ptrs.begin(), ctx_ptrs.end(), ctx_ptr);
-                                if (ctx_it == ctx_ptrs.end()){
-                                    auto it = std::find_if(ctx_ptr->peer_addresses().begin(), ctx_ptr->peer_addresses().end(), [&](auto& peer){
-                                        return (peer.ipv4_addr.address.sin_addr.s_addr == io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr && peer.ipv4_addr.address.sin_port == io_.local_sctp_address.ipv4_addr.address.sin_port);
-                                    });
-                                    if(it == ctx_ptr->peer_addresses().end()){
-                                        ctx_ptr->peer_addresses().push_back(io_.local_sctp_address);
-                                    }
-                                    ctx_ptrs.push_back(ctx_ptr);
-                                    #ifndef NDEBUG
-                                    try{
-                                    if(val.get_object().at("value").as_object().contains("execution_context")){
-                                        // If this is a new execution_context AND the function input parameters
-                                        // are wrapped in an existing execution context AND the primary peer address in the 
-                                        // incoming execution context is equal to the local SCTP address; then this execution context has already
-                                        // completed. The correct behaviour here is to terminate the context.
-
-                                        // We don't want to execute this logic in debug builds as it guards against explicitly setting 
-                                        // the UUID for new execution contexts (new execution contexts MUST use a locally generated UUID).
-                                        boost::json::array& ja = val.get_object()["value"].get_object()["execution_context"].at("peers").as_array();
-                                        std::string p(ja[0].as_string());
-                                        std::size_t pos = p.find(':');
-                                        std::string_view pip(&p[0],pos);
-                                        std::string_view pport(&p[pos+1], p.size()-pos-1);
-                                        std::uint16_t portnum = 0;
-                                        std::from_chars_result fcres = std::from_chars(pport.data(), pport.data()+pport.size(), portnum,10);
-                                        if(fcres.ec != std::errc()){
-                                            std::cerr << "Converting: " << pport << " to uint16_t failed: " << std::make_error_code(fcres.ec).message() << std::endl;
-                                            throw "This shouldn't happen!";
-                                        }
-                                        struct sockaddr_in rip = {};
-                                        rip.sin_family = AF_INET;
-                                        rip.sin_port = htons(portnum);
-                                        std::string pip_str(pip);
-                                        int ec = inet_aton(pip_str.c_str(), &rip.sin_addr);
-                                        if(ec == 0){
-                                            std::cerr << "Converting: " << pip << " to struct in_addr failed." << std::endl;
-                                            throw "This shouldn't happen!";
-                                        }
-                                        if(rip.sin_addr.s_addr == io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr && rip.sin_port == io_.local_sctp_address.ipv4_addr.address.sin_port){
-                                            for(std::size_t i=0; i < ctx_ptr->thread_controls().size(); ++i){
-                                                auto& thread = ctx_ptr->thread_controls()[i];
-                                                auto& relation = ctx_ptr->manifest()[i];
-                                                relation->acquire_value() = "null";
-                                                relation->release_value();
-                                                thread.signal().store(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
-                                            }
-                                            io_mbox_ptr_->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
-                                            io_mbox_ptr_->sched_signal_cv_ptr->notify_one();
-                                            return;                   
-                                        }
-                                    }
-                                    }catch(std::invalid_argument& e){
-                                        std::cerr << "controller-app.cpp:1401:val.value is not an object:" << boost::json::serialize(val) << std::endl;
-                                        throw e;
-                                    }
-                                    #endif
-
-                                    /* Initialize the http client sessions */
-                                    if(ctx_ptr->execution_context_idx_array().front() == 0){
-                                        /* This is the primary context */
-                                        // The primary context will have no client peer connections, only server peer connections.
-                                        // The primary context must hit the OW API endpoint `concurrency' no. of times with the
-                                        // a different execution context idx and the same execution context id each time.
-                                        make_api_requests(ctx_ptr, val, curl_mhnd_ptr_, &num_running_multi_handles_);
-                                    } else {
-                                        /* This is a secondary context */
-                                        boost::json::object jo;
-                                        UUID::Uuid uuid = ctx_ptr->execution_context_id();
-                                        std::stringstream uuid_str;
-                                        uuid_str << uuid;
-                                        jo.emplace("uuid", boost::json::string(uuid_str.str()));
-
-                                        std::vector<server::Remote> peers = ctx_ptr->get_peers();
-                                        boost::json::array ja;
-                                        for(auto& peer: peers){                                                       
-                                            ja.push_back(boost::json::string(rtostr(peer)));
-                                        }                                                           
-                                        jo.emplace("peers", ja);
-                                        
-                                        boost::json::object jo_ctx;
-                                        jo_ctx.emplace("execution_context", jo);
-                                        std::string data("[");
-                                        std::string json_str(boost::json::serialize(jo_ctx));
-                                        data.append(json_str);
-                                        http::HttpRequest nreq = {};
-                                        nreq.verb = http::HttpVerb::PUT;
-                                        nreq.route = "/run";
-                                        nreq.version = http::HttpVersion::V1_1;
-                                        nreq.headers = {
-                                            CONTROLLER_APP_COMMON_HTTP_HEADERS
-                                        };
-                                        http::HttpChunk nc = {};
-                                        nc.chunk_size = {data.size()};
-                                        nc.chunk_data = data;
-                                        nreq.chunks = {
-                                            nc
-                                        };
-                                        for(auto& peer: ctx_ptr->peer_addresses()){
-                                            if(peer.ipv4_addr.address.sin_addr.s_addr != io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr || peer.ipv4_addr.address.sin_port != io_.local_sctp_address.ipv4_addr.address.sin_port){   
-                                                io_.async_connect(peer, [&, ctx_ptr, nreq](const boost::system::error_code& ec, const std::shared_ptr<server::Session>& t_session){
-                                                    if(!ec){
-                                                        /* Creating a new client session with a potentially reused transport session, so need to clear the old buffers first.*/
-                                                        t_session->acquire_stream().str(std::string());
-                                                        t_session->release_stream();
-
-                                                        std::shared_ptr<http::HttpClientSession> client_session = std::make_shared<http::HttpClientSession>(hcs_, t_session);
-                                                        hcs_.acquire();
-                                                        hcs_.push_back(client_session);
-                                                        hcs_.release();
-                                                        ctx_ptr->acquire();
-                                                        ctx_ptr->peer_client_sessions().push_back(client_session);
-                                                        ctx_ptr->release();
-                                                        client_session->set(http::HttpReqRes({nreq,{}}));
-                                                        client_session->write([&, client_session](const std::error_code& ec){
-                                                            if(ec){
-                                                                client_session->close();
-                                                            }
-                                                            return;
-                                                        });
-                                                    }
-                                                });
-                                            }
-                                        }
-                                    }
-
-                                    const std::size_t& manifest_size = ctx_ptr->manifest().size();
-                                    // This id is pushed in the context constructor.
-                                    std::size_t execution_idx = ctx_ptr->pop_execution_idx();
-                                    // Get the starting relation.
-                                    std::string start_key(ctx_ptr->manifest()[execution_idx % manifest_size]->key());
-                                    std::shared_ptr<Relation> start = ctx_ptr->manifest().next(start_key, execution_idx);
-                                    // Find the index in the manifest of the starting relation.
-                                    auto start_it = std::find_if(ctx_ptr->manifest().begin(), ctx_ptr->manifest().end(), [&](auto& rel){
-                                        return rel->key() == start->key();
-                                    });
-                                    if (start_it == ctx_ptr->manifest().end()){
-                                        std::cerr << "controller-app.cpp:1340:there are no matches for rel->key() == start->key():start->key()=" << start->key() << std::endl;
-                                        // If the start key is past the end of the manifest, that means that
-                                        // there are no more relations to complete execution. Simply signal a SCHED_END condition and return from request routing.
-                                        io_mbox_ptr_->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
-                                        io_mbox_ptr_->sched_signal_cv_ptr->notify_one();
-                                        return;
-                                    }
-                                    std::ptrdiff_t start_idx = start_it - ctx_ptr->manifest().begin();
-                                    controller::app::ThreadControls::thread_sched_push();
-                                    controller::app::ThreadControls::set_start_time();
-                                    try{
-                                        std::thread initializer(
-                                            [&, ctx_ptr, manifest_size, start_idx, run](std::shared_ptr<controller::io::MessageBox> mbox_ptr){
-                                                auto signalp = mbox_ptr->sched_signal_ptr;
-                                                auto cvp = mbox_ptr->sched_signal_cv_ptr;
-                                                auto mtxp = mbox_ptr->sched_signal_mtx_ptr;
-                                                std::chrono::time_point<std::chrono::steady_clock> start = controller::app::ThreadControls::get_start_time();
-                                                auto& thread_controls = ctx_ptr->thread_controls();
-                                                std::chrono::time_point<std::chrono::steady_clock> finish;  
-
-                                                std::chrono::time_point<std::chrono::steady_clock> exec_timer_start;
-                                                std::chrono::time_point<std::chrono::steady_clock> exec_timer_finish;
-                                                std::chrono::nanoseconds exec_time = std::chrono::nanoseconds(0);
-
-                                                for(std::size_t i=0; i < manifest_size; ++i){
-                                                    if(exec_time == std::chrono::nanoseconds(0)){
-                                                        exec_timer_start = std::chrono::steady_clock::now();
-                                                    }
-                                                    if(ctx_ptr->is_stopped()){
-                                                        break;
-                                                    } else {
-                                                        auto& thread_control = thread_controls[(i+start_idx) % manifest_size];
-                                                        if(thread_control.is_stopped()){
-                                                            signalp->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
-                                                            cvp->notify_one();
-                                                            continue;
-                                                        } else {
-                                                            if(thread_control.state() == 0){
-                                                                initialize_executor(
-                                                                    thread_control,
-                                                                    mbox_ptr,
-                                                                    ctx_ptr,
-                                                                    manifest_size,
-                                                                    i,
-                                                                    start_idx
-                                                                );
-                                                            }
-                                                        }
-                                                    }
-                                                    if(exec_time == std::chrono::nanoseconds(0)){
-                                                        exec_timer_finish = std::chrono::steady_clock::now();
-                                                        exec_time = exec_timer_finish - exec_timer_start;
-                                                    }
-                                                    finish = std::chrono::steady_clock::now();
-                                                    while((finish - start + exec_time) > controller::app::ThreadControls::thread_sched_time_slice()){
-                                                        controller::app::ThreadControls::thread_sched_yield(false);
-                                                        start = controller::app::ThreadControls::get_start_time();
-                                                        if(ctx_ptr->is_stopped()){
-                                                            break;
-                                                        }
-                                                        auto thread_it = std::find_if(thread_controls.begin(), thread_controls.end(), [&](auto& thread){
-                                                            // Find a thread that has been notified to start but has not yet been initialized.
-                                                            return (thread.is_started() && !thread.is_stopped() && (thread.state() == 0));
-                                                        });
-                                                        if(thread_it != thread_controls.end()){
-                                                            std::size_t idx = thread_it - thread_controls.begin();
-                                                            auto& thread = *thread_it;
-                                                            initialize_executor(
-                                                                thread,
-                                                                mbox_ptr,
-                                                                ctx_ptr,
-                                                                manifest_size,
-                                                                idx,
-                                                                0
-                                                            );
-                                                        }
-                                                        finish = std::chrono::steady_clock::now();
-                                                    }
-                                                }
-                                                controller::app::ThreadControls::thread_sched_yield(true);
-                                                return;
-                                            }, io_mbox_ptr_
-                                        );
-                                        auto& thread_controls = ctx_ptr->thread_controls();
-                                        auto& thread = thread_controls[start_idx];
-                                        initializer.detach();
-                                        thread.notify(execution_idx);
-                                    } catch(std::system_error& e){
-                                        std::cerr << "controller-app.cpp:1454:initializer failed to start with error:" << e.what() << std::endl;
-                                        throw e;
-                                    }
-                                }
-                            } else {
-                                // invalidate the fibers.
-                                std::cerr << "controller-app.cpp:1460:/run route reached before initialization." << std::endl;
-                                http::HttpReqRes rr;
-                                while(ctx_ptr->sessions().size() > 0)
-                                {
-                                    std::shared_ptr<http::HttpSession>& next_session = ctx_ptr->sessions().back();
-                                    std::get<http::HttpResponse>(rr) = create_response(*ctx_ptr);
-                                    next_session->write(
-                                        rr,
-                                        [&, next_session](const std::error_code&){
-                                            next_session->close();
-                                        }
-                                    );
-                                    ctx_ptr->sessions().pop_back();
-                                }
+                            if(!run_request(session, val)){
+                                return;
                             }
-                            // clock_gettime(CLOCK_MONOTONIC, &ts[1]);
-                            // std::cout << "Run route - POST time: " << (ts[1].tv_sec*1000000 + ts[1].tv_nsec/1000) - (ts[0].tv_sec*1000000 + ts[0].tv_nsec/1000) << std::endl;
                         } else if(req.verb == http::HttpVerb::PUT){
                             // clock_gettime(CLOCK_REALTIME, &ts);
                             // std::cout << "controller-app.cpp:1141:/run PUT:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
@@ -1635,12 +1331,10 @@ namespace app{
                                 }
                                 std::string uuid_str(json_uuid);
                                 UUID::Uuid uuid(UUID::Uuid::v4, uuid_str);
-                                auto it = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto ctx_ptr){
-                                    return (ctx_ptr->execution_context_id() == uuid);
-                                });
-                                if(it != ctx_ptrs.end()){                                      
+                                std::shared_ptr<ExecutionContext> ctx = ctx_ptrs.find(uuid);
+                                if(ctx){
                                     /* Bind the http session to an existing context. */
-                                    (*it)->peer_server_sessions().push_back(session);
+                                    ctx_ptrs.bind(session, ctx);
 
                                     //[{"execution_context":{"uuid":"a70ea480860c45e19a5385c68188d1ff","peers":["127.0.0.1:5200"]}} 
                                     /* Merge peers in the peer list with the context peer list. */
@@ -1655,30 +1349,23 @@ namespace app{
                                     for(const auto& rpeer: remote_peers){
                                         remote_peer_list.emplace_back(rpeer.as_string());
                                     }
-                                    (*it)->merge_peer_addresses(remote_peer_list);
+                                    ctx->merge_peer_addresses(remote_peer_list);
 
                                     boost::json::object retjo;
                                     /* Construct a boost json array from the updated peer list */
                                     boost::json::array peers;
-                                    for(const auto& peer: (*it)->peer_addresses()){
+                                    for(const auto& peer: ctx->peer_addresses()){
                                         peers.emplace_back(rtostr(peer));
                                     }
                                     retjo.emplace("peers", peers);
 
                                     /* Construct the results object value */
                                     boost::json::object ro;
-                                    for(auto& relation: (*it)->manifest()){
-                                        const auto& value = relation->acquire_value();
-                                        if(!value.empty()){
-                                            boost::json::error_code ec;
-                                            boost::json::value jv = boost::json::parse(value, ec);
-                                            if(ec){
-                                                std::cerr << "controller-app.cpp:1647:JSON parsing failed:" << ec.message() << ":value:" << value << std::endl;
-                                                throw "This shouldn't be possible.";
-                                            }
-                                            ro.emplace(relation->key(), jv);
+                                    for(auto& relation: ctx->manifest()){
+                                        const RelationResult* result = relation->result();
+                                        if(result != nullptr){
+                                            ro.emplace(relation->key(), result->value);
                                         }
-                                        relation->release_value();
                                     }
                                     retjo.emplace("result", ro);
 
@@ -1743,11 +1430,8 @@ namespace app{
                             } else {
                                 /* An incoming state update. */
                                 /* Search for an execution context that holds the stream. */
-                                auto server_ctx = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto ctx_ptr){
-                                    auto tmp = std::find(ctx_ptr->peer_server_sessions().begin(), ctx_ptr->peer_server_sessions().end(), session);
-                                    return (tmp == ctx_ptr->peer_server_sessions().end()) ? false : true;
-                                });
-                                if(server_ctx == ctx_ptrs.end()){
+                                std::shared_ptr<ExecutionContext> server_ctx = ctx_ptrs.find(session);
+                                if(!server_ctx){
                                     /* There has been an error, the execution context no longer exists. Simply terminate the stream. */
                                     http::HttpReqRes rr = session->get();
                                     http::HttpResponse& res = std::get<http::HttpResponse>(rr);
@@ -1771,10 +1455,10 @@ namespace app{
                                     }
                                     for(auto& kvp: jo){
                                         std::string k(kvp.key());
-                                        auto relation = std::find_if((*server_ctx)->manifest().begin(), (*server_ctx)->manifest().end(), [&](auto& r){
+                                        auto relation = std::find_if(server_ctx->manifest().begin(), server_ctx->manifest().end(), [&](auto& r){
                                             return r->key() == k;
                                         });
-                                        if(relation == (*server_ctx)->manifest().end()){
+                                        if(relation == server_ctx->manifest().end()){
                                             std::cerr << "Relation does not exist in the active manifest." << std::endl;
                                             throw "This should never happen.";
                                         }
@@ -1790,7 +1474,7 @@ namespace app{
                                         (*relation)->release_value();
 
                                         /* Trigger rescheduling if necessary */
-                                        auto& ctxp = *server_ctx;
+                                        auto& ctxp = server_ctx;
                                         std::ptrdiff_t idx = relation - (ctxp)->manifest().begin();
                                         auto& thread_controls = ctxp->thread_controls();
                                         auto& manifest = ctxp->manifest();
@@ -1836,8 +1520,16 @@ namespace app{
                         if(!initialized_) {
                             // Execute the initializer.
                             if ( res.status == http::HttpStatus::OK ){
+                                // Launchers that were started before the action was initialized are stale.
+                                LauncherPool::clear();
                                 init.run();
+                                // The cached manifest template was compiled before the action was installed.
+                                ActionManifest::invalidate();
                                 initialized_ = true;
+                                if(Zygote::enabled()){
+                                    // (Re)start the zygote so that it preloads the newly installed action modules.
+                                    Zygote::start();
+                                }
                             }
                         }
                         session->write(
@@ -1889,6 +1581,328 @@ namespace app{
         // std::cout << "controller-app.cpp:1404:route_request finished:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
     }
 
+    bool Controller::run_request(std::shared_ptr<http::HttpSession>& session, boost::json::value& val){
+        // Returns false if the rest of the request must not be routed.
+        // clock_gettime(CLOCK_REALTIME, &ts);
+        // std::cout << "controller-app.cpp:792:/run POST:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << std::endl;
+        // struct timespec ts[2] = {};
+        // clock_gettime(CLOCK_MONOTONIC, &ts[0]);
+        boost::json::object json_obj;
+        try{
+            json_obj = val.as_object();
+        } catch(std::invalid_argument& e){
+            std::cerr << "controller-app.cpp:1326:val is not an object:" << boost::json::serialize(val) << std::endl;
+            throw e;
+        }
+        controller::resources::run::Request run(json_obj);
+        auto env = run.env();
+        // std::string __OW_ACTIVATION_ID = env["__OW_ACTIVATION_ID"];
+        // if(!__OW_ACTIVATION_ID.empty()){
+        //     struct timespec ts = {};
+        //     int status = clock_gettime(CLOCK_REALTIME, &ts);
+        //     if(status != -1){
+        //         std::cout << "controller-app.cpp:728:" << (ts.tv_sec*1000 + ts.tv_nsec/1000000) << ":__OW_ACTIVATION_ID=" << __OW_ACTIVATION_ID << std::endl;
+        //     }
+        // }
+        if(forward_request(run.execution_context_id(), session, val)){
+            return true;
+        }
+        // Create a fiber continuation for processing the request.
+        std::shared_ptr<ExecutionContext> ctx_ptr = controller::resources::run::handle(run, ctx_ptrs); 
+        auto http_it = std::find(ctx_ptr->sessions().cbegin(), ctx_ptr->sessions().cend(), session);
+        if(http_it == ctx_ptr->sessions().cend()){
+            ctx_ptr->sessions().push_back(session);
+        }
+        ctx_ptr->env() = env;
+        if (initialized_){
+            // Initialize threads only once.
+            // If ctx_ptr is already in the controller ctx_ptrs then threads don't need to be initialized again.
+            if (!ctx_ptrs.contains(ctx_ptr)){
+                auto it = std::find_if(ctx_ptr->peer_addresses().begin(), ctx_ptr->peer_addresses().end(), [&](auto& peer){
+                    return (peer.ipv4_addr.address.sin_addr.s_addr == io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr && peer.ipv4_addr.address.sin_port == io_.local_sctp_address.ipv4_addr.address.sin_port);
+                });
+                if(it == ctx_ptr->peer_addresses().end()){
+                    ctx_ptr->peer_addresses().push_back(io_.local_sctp_address);
+                }
+                if(!ctx_ptrs.insert(ctx_ptr)){
+                    // Another shard registered a context with the same id first, so the request is routed on that shard.
+                    if(!forward_request(run.execution_context_id(), session, val)){
+                        // The other shard has erased the context since, so the request is routed here again.
+                        return run_request(session, val);
+                    }
+                    return false;
+                }
+                // Keep warm launchers available for the relations in this manifest.
+                LauncherPool::prime(ctx_ptr->manifest().index(), ctx_ptr->manifest().concurrency());
+                #ifndef NDEBUG
+                try{
+                if(val.get_object().at("value").as_object().contains("execution_context")){
+                    // If this is a new execution_context AND the function input parameters
+                    // are wrapped in an existing execution context AND the primary peer address in the 
+                    // incoming execution context is equal to the local SCTP address; then this execution context has already
+                    // completed. The correct behaviour here is to terminate the context.
+
+                    // We don't want to execute this logic in debug builds as it guards against explicitly setting 
+                    // the UUID for new execution contexts (new execution contexts MUST use a locally generated UUID).
+                    boost::json::array& ja = val.get_object()["value"].get_object()["execution_context"].at("peers").as_array();
+                    std::string p(ja[0].as_string());
+                    std::size_t pos = p.find(':');
+                    std::string_view pip(&p[0],pos);
+                    std::string_view pport(&p[pos+1], p.size()-pos-1);
+                    std::uint16_t portnum = 0;
+                    std::from_chars_result fcres = std::from_chars(pport.data(), pport.data()+pport.size(), portnum,10);
+                    if(fcres.ec != std::errc()){
+                        std::cerr << "Converting: " << pport << " to uint16_t failed: " << std::make_error_code(fcres.ec).message() << std::endl;
+                        throw "This shouldn't happen!";
+                    }
+                    struct sockaddr_in rip = {};
+                    rip.sin_family = AF_INET;
+                    rip.sin_port = htons(portnum);
+                    std::string pip_str(pip);
+                    int ec = inet_aton(pip_str.c_str(), &rip.sin_addr);
+                    if(ec == 0){
+                        std::cerr << "Converting: " << pip << " to struct in_addr failed." << std::endl;
+                        throw "This shouldn't happen!";
+                    }
+                    if(rip.sin_addr.s_addr == io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr && rip.sin_port == io_.local_sctp_address.ipv4_addr.address.sin_port){
+                        for(std::size_t i=0; i < ctx_ptr->thread_controls().size(); ++i){
+                            auto& thread = ctx_ptr->thread_controls()[i];
+                            auto& relation = ctx_ptr->manifest()[i];
+                            relation->acquire_value() = "null";
+                            relation->release_value();
+                            thread.signal().store(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+                        }
+                        ContextRegistry::signal(ctx_ptr);
+                        io_mbox_ptr_->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+                        io_mbox_ptr_->sched_signal_cv_ptr->notify_one();
+                        return false;
+                    }
+                }
+                }catch(std::invalid_argument& e){
+                    std::cerr << "controller-app.cpp:1401:val.value is not an object:" << boost::json::serialize(val) << std::endl;
+                    throw e;
+                }
+                #endif
+
+                /* Initialize the http client sessions */
+                if(ctx_ptr->execution_context_idx_array().front() == 0){
+                    /* This is the primary context */
+                    // The primary context will have no client peer connections, only server peer connections.
+                    // The primary context must hit the OW API endpoint `concurrency' no. of times with the
+                    // a different execution context idx and the same execution context id each time.
+                    make_api_requests(ctx_ptr, val, curl_mhnd_ptr_, &num_running_multi_handles_);
+                } else {
+                    /* This is a secondary context */
+                    boost::json::object jo;
+                    UUID::Uuid uuid = ctx_ptr->execution_context_id();
+                    std::stringstream uuid_str;
+                    uuid_str << uuid;
+                    jo.emplace("uuid", boost::json::string(uuid_str.str()));
+
+                    std::vector<server::Remote> peers = ctx_ptr->get_peers();
+                    boost::json::array ja;
+                    for(auto& peer: peers){                                                       
+                        ja.push_back(boost::json::string(rtostr(peer)));
+                    }                                                           
+                    jo.emplace("peers", ja);
+
+                    boost::json::object jo_ctx;
+                    jo_ctx.emplace("execution_context", jo);
+                    std::string data("[");
+                    std::string json_str(boost::json::serialize(jo_ctx));
+                    data.append(json_str);
+                    http::HttpRequest nreq = {};
+                    nreq.verb = http::HttpVerb::PUT;
+                    nreq.route = "/run";
+                    nreq.version = http::HttpVersion::V1_1;
+                    nreq.headers = {
+                        CONTROLLER_APP_COMMON_HTTP_HEADERS
+                    };
+                    http::HttpChunk nc = {};
+                    nc.chunk_size = {data.size()};
+                    nc.chunk_data = data;
+                    nreq.chunks = {
+                        nc
+                    };
+                    for(auto& peer: ctx_ptr->peer_addresses()){
+                        if(peer.ipv4_addr.address.sin_addr.s_addr != io_.local_sctp_address.ipv4_addr.address.sin_addr.s_addr || peer.ipv4_addr.address.sin_port != io_.local_sctp_address.ipv4_addr.address.sin_port){   
+                            io_.async_connect(peer, [&, ctx_ptr, nreq](const boost::system::error_code& ec, const std::shared_ptr<server::Session>& t_session){
+                                if(!ec){
+                                    /* Creating a new client session with a potentially reused transport session, so need to clear the old buffers first.*/
+                                    t_session->acquire_stream().str(std::string());
+                                    t_session->release_stream();
+
+                                    std::shared_ptr<http::HttpClientSession> client_session = std::make_shared<http::HttpClientSession>(hcs_, t_session);
+                                    hcs_.acquire();
+                                    hcs_.push_back(client_session);
+                                    hcs_.release();
+                                    ctx_ptr->acquire();
+                                    ctx_ptrs.bind(client_session, ctx_ptr);
+                                    ctx_ptr->release();
+                                    client_session->set(http::HttpReqRes({nreq,{}}));
+                                    client_session->write([&, client_session](const std::error_code& ec){
+                                        if(ec){
+                                            client_session->close();
+                                        }
+                                        return;
+                                    });
+                                }
+                            });
+                        }
+                    }
+                }
+
+                const std::size_t& manifest_size = ctx_ptr->manifest().size();
+                // This id is pushed in the context constructor.
+                std::size_t execution_idx = ctx_ptr->pop_execution_idx();
+                // Get the starting relation.
+                std::shared_ptr<Relation> start = ctx_ptr->manifest().next(execution_idx % manifest_size, execution_idx);
+                // Find the index in the manifest of the starting relation.
+                auto start_it = ctx_ptr->manifest().begin() + ctx_ptr->manifest().position(start->key());
+                if (start_it == ctx_ptr->manifest().end()){
+                    std::cerr << "controller-app.cpp:1340:there are no matches for rel->key() == start->key():start->key()=" << start->key() << std::endl;
+                    // If the start key is past the end of the manifest, that means that
+                    // there are no more relations to complete execution. Simply signal a SCHED_END condition and return from request routing.
+                    ContextRegistry::signal(ctx_ptr);
+                    io_mbox_ptr_->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+                    io_mbox_ptr_->sched_signal_cv_ptr->notify_one();
+                    return false;
+                }
+                std::ptrdiff_t start_idx = start_it - ctx_ptr->manifest().begin();
+                auto sched_handle = controller::app::ThreadControls::thread_sched_push(activation_deadline(ctx_ptr->env()));
+                sched_handle->remaining.store(ctx_ptr->manifest().remaining_levels(), std::memory_order::memory_order_relaxed);
+                controller::app::ThreadControls::set_start_time();
+                try{
+                    std::thread initializer(
+                        [&, ctx_ptr, manifest_size, start_idx, run, sched_handle](std::shared_ptr<controller::io::MessageBox> mbox_ptr){
+                            auto signalp = mbox_ptr->sched_signal_ptr;
+                            auto cvp = mbox_ptr->sched_signal_cv_ptr;
+                            auto mtxp = mbox_ptr->sched_signal_mtx_ptr;
+                            std::chrono::time_point<std::chrono::steady_clock> start = controller::app::ThreadControls::get_start_time(sched_handle);
+                            auto& thread_controls = ctx_ptr->thread_controls();
+                            std::chrono::time_point<std::chrono::steady_clock> finish;  
+
+                            std::chrono::time_point<std::chrono::steady_clock> exec_timer_start;
+                            std::chrono::time_point<std::chrono::steady_clock> exec_timer_finish;
+                            std::chrono::nanoseconds exec_time = std::chrono::nanoseconds(0);
+
+                            for(std::size_t i=0; i < manifest_size; ++i){
+                                if(exec_time == std::chrono::nanoseconds(0)){
+                                    exec_timer_start = std::chrono::steady_clock::now();
+                                }
+                                if(ctx_ptr->is_stopped()){
+                                    break;
+                                } else {
+                                    auto& thread_control = thread_controls[(i+start_idx) % manifest_size];
+                                    if(thread_control.is_stopped()){
+                                        ContextRegistry::signal(ctx_ptr);
+                                        signalp->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+                                        cvp->notify_one();
+                                        continue;
+                                    } else {
+                                        if(thread_control.state() == 0){
+                                            initialize_executor(
+                                                thread_control,
+                                                mbox_ptr,
+                                                ctx_ptr,
+                                                manifest_size,
+                                                i,
+                                                start_idx
+                                            );
+                                        }
+                                    }
+                                }
+                                if(exec_time == std::chrono::nanoseconds(0)){
+                                    exec_timer_finish = std::chrono::steady_clock::now();
+                                    exec_time = exec_timer_finish - exec_timer_start;
+                                }
+                                finish = std::chrono::steady_clock::now();
+                                while((finish - start + exec_time) > controller::app::ThreadControls::thread_sched_time_slice()){
+                                    sched_handle->remaining.store(ctx_ptr->manifest().remaining_levels(), std::memory_order::memory_order_relaxed);
+                                    controller::app::ThreadControls::thread_sched_yield(false, sched_handle);
+                                    start = controller::app::ThreadControls::get_start_time(sched_handle);
+                                    if(ctx_ptr->is_stopped()){
+                                        break;
+                                    }
+                                    auto thread_it = std::find_if(thread_controls.begin(), thread_controls.end(), [&](auto& thread){
+                                        // Find a thread that has been notified to start but has not yet been initialized.
+                                        return (thread.is_started() && !thread.is_stopped() && (thread.state() == 0));
+                                    });
+                                    if(thread_it != thread_controls.end()){
+                                        std::size_t idx = thread_it - thread_controls.begin();
+                                        auto& thread = *thread_it;
+                                        initialize_executor(
+                                            thread,
+                                            mbox_ptr,
+                                            ctx_ptr,
+                                            manifest_size,
+                                            idx,
+                                            0
+                                        );
+                                    }
+                                    finish = std::chrono::steady_clock::now();
+                                }
+                            }
+                            controller::app::ThreadControls::thread_sched_yield(true, sched_handle);
+                            return;
+                        }, io_mbox_ptr_
+                    );
+                    auto& thread_controls = ctx_ptr->thread_controls();
+                    auto& thread = thread_controls[start_idx];
+                    initializer.detach();
+                    thread.notify(execution_idx);
+                } catch(std::system_error& e){
+                    std::cerr << "controller-app.cpp:1454:initializer failed to start with error:" << e.what() << std::endl;
+                    throw e;
+                }
+            }
+        } else {
+            // invalidate the fibers.
+            std::cerr << "controller-app.cpp:1460:/run route reached before initialization." << std::endl;
+            http::HttpReqRes rr;
+            while(ctx_ptr->sessions().size() > 0)
+            {
+                std::shared_ptr<http::HttpSession>& next_session = ctx_ptr->sessions().back();
+                std::get<http::HttpResponse>(rr) = create_response(*ctx_ptr);
+                next_session->write(
+                    rr,
+                    [&, next_session](const std::error_code&){
+                        next_session->close();
+                    }
+                );
+                ctx_ptr->sessions().pop_back();
+            }
+        }
+        // clock_gettime(CLOCK_MONOTONIC, &ts[1]);
+        // std::cout << "Run route - POST time: " << (ts[1].tv_sec*1000000 + ts[1].tv_nsec/1000) - (ts[0].tv_sec*1000000 + ts[0].tv_nsec/1000) << std::endl;
+        return true;
+    }
+
+    bool Controller::forward_request(const UUID::Uuid& uuid, const std::shared_ptr<http::HttpSession>& session, const boost::json::value& val){
+        // Only the shard that owns an execution context mutates it, so requests for a context that another shard owns are
+        // routed on the io_context of that shard.
+        if(uuid == UUID::Uuid()){
+            return false;
+        }
+        const ContextRegistry* owner = ContextRegistry::owner(uuid);
+        if(owner == nullptr || owner == &ctx_ptrs){
+            return false;
+        }
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        auto it = std::find_if(shards_.begin(), shards_.end(), [&](Controller* shard){
+            return (&shard->ctx_ptrs == owner);
+        });
+        if(it == shards_.end()){
+            return false;
+        }
+        Controller* shard = *it;
+        lk.unlock();
+        boost::asio::post(shard->ioc_, [shard, session = std::shared_ptr<http::HttpSession>(session), val = boost::json::value(val)]() mutable {
+            shard->run_request(session, val);
+        });
+        return true;
+    }
+
     http::HttpResponse Controller::create_response(ExecutionContext& ctx){
         http::HttpResponse res = {};
         if(ctx.route() == controller::resources::Routes::RUN){
@@ -1931,18 +1945,11 @@ namespace app{
                             jrel.clear();
                             all_null = true;
                         }
-                        std::string value = relation->acquire_value();
-                        relation->release_value();
-                        // std::cout << "controller-app.cpp:1911:value=" << value << std::endl;
+                        const RelationResult* result = relation->result();
                         boost::json::value jv;
-                        if(!value.empty() && value != "null"){
+                        if(result != nullptr && !result->value.is_null()){
                             all_null = false;
-                            boost::json::error_code ec;
-                            jv = boost::json::parse(value, ec);
-                            if(ec){
-                                std::cerr << "controller-app.cpp:1904:JSON parsing failed:" << ec.message() << ":value:" << value << std::endl;
-                                throw "This shouldn't happen.";
-                            }
+                            jv = result->value;
                         }
                         jrel.emplace(relation->key(), jv);
                     }
@@ -2082,6 +2089,9 @@ namespace app{
 
     Controller::~Controller()
     {
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        shards_.erase(std::remove(shards_.begin(), shards_.end(), this), shards_.end());
+        lk.unlock();
         stop();
     }
 }// namespace app
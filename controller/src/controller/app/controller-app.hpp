@@ -4,8 +4,11 @@
 #include <boost/json.hpp>
 #include <application-servers/http/http-server.hpp>
 #include "../io/controller-io.hpp"
+#include "context-registry.hpp"
+#include "json-splitter.hpp"
 #include <iostream>
 #include <filesystem>
+#include <unordered_map>
 #include <curl/curl.h>
 
 
@@ -49,7 +52,8 @@ namespace app{
     {
     public:
         Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc);
-        Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc, const std::filesystem::path& upath, std::uint16_t sport);
+        // Sharded controllers each run their own io_context, http servers and context registry.
+        Controller(std::shared_ptr<controller::io::MessageBox> mbox_ptr, boost::asio::io_context& ioc, const std::filesystem::path& upath, std::uint16_t sport, std::size_t shard);
         void start();
         void start_controller();
         void route_response(std::shared_ptr<http::HttpClientSession>& session);
@@ -63,6 +67,17 @@ namespace app{
         void stop();
         ~Controller();
     private:
+        // Routes one /run POST object, and returns false if the rest of the request must not be routed.
+        bool run_request(std::shared_ptr<http::HttpSession>& session, boost::json::value& val);
+        // Posts the object to the shard that owns the execution context, if that is another shard.
+        bool forward_request(const UUID::Uuid& uuid, const std::shared_ptr<http::HttpSession>& session, const boost::json::value& val);
+        static std::mutex shards_mtx_;
+        static std::vector<Controller*> shards_;
+
+        // The JSON splitter of the chunked body of an HTTP session.
+        JsonSplitter& json_splitter(const std::shared_ptr<const void>& session);
+        void erase_json_splitter(const std::shared_ptr<const void>& session) { json_splitters_.erase(session.get()); }
+
         // Http Server.
         http::HttpServer hs_;
         // Http Client Server.
@@ -72,10 +87,13 @@ namespace app{
         pthread_t tid_;
         // Global Signals.
         std::shared_ptr<controller::io::MessageBox> controller_mbox_ptr_;
-        // Execution Context IDs.
-        std::vector<std::shared_ptr<ExecutionContext> > ctx_ptrs;
-        // OpenWhisk Action Proxy Initialized.
-        bool initialized_;
+        // Execution Contexts.
+        ContextRegistry ctx_ptrs;
+        // JSON body splitters, indexed by HTTP session. The splitters of expired sessions are swept when the index grows.
+        std::unordered_map<const void*, std::pair<std::weak_ptr<const void>, JsonSplitter> > json_splitters_;
+        std::size_t json_splitters_sweep_ = 16;
+        // OpenWhisk Action Proxy Initialized. The action is initialized once for all shards.
+        static std::atomic<bool> initialized_;
         // IO
         int num_running_multi_handles_;
         std::shared_ptr<libcurl::CurlMultiHandle> curl_mhnd_ptr_;
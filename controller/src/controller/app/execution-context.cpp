@@ -1,7 +1,5 @@
 #include "execution-context.hpp"
 #include <filesystem>
-#include <fstream>
-#include <boost/json.hpp>
 #include "action-relation.hpp"
 #include <charconv>
 
@@ -34,87 +32,7 @@ namespace app{
         #ifdef OW_PROFILE
         start_ = std::chrono::steady_clock::now();
         #endif
-        const char* __OW_ACTIONS = getenv("__OW_ACTIONS");
-        if ( __OW_ACTIONS == nullptr ){
-            std::cerr << "execution-context.cpp:26:__OW_ACTIONS not defined." << std::endl;
-            throw "This shouldn't happen.";
-        }
-        std::filesystem::path action_path(__OW_ACTIONS);
-        std::filesystem::path manifest_path(action_path / "action-manifest.json");
-        if (std::filesystem::exists(manifest_path)){
-            std::fstream f(manifest_path, std::ios_base::in);
-            boost::json::error_code ec;
-            boost::json::value tmp = boost::json::parse(f,ec);
-            boost::json::object manifest;
-            try{
-                manifest = tmp.as_object();
-            } catch(std::invalid_argument& e){
-                std::cerr << "execution-context.cpp:52:tmp is not an object:" << boost::json::serialize(tmp) << std::endl;
-                throw e;
-            }
-            if (ec){
-                std::cerr << "execution-context.cpp:37:boost json parse failed." << std::endl;
-                throw "This shouldn't happen.";
-            }
-            // If the manifest is empty throw an exception.
-            if(manifest.empty()){
-                std::cerr << "execution-context.cpp:42:action-manifest.json can't be empty." << std::endl;
-                throw "This shouldn't happen.";
-            }
-            /* If the action manifest contains an __OW_NUM_CONCURRENCY key, set the manifest concurrency to that value, otherwise set it to 1.*/
-            // Subsequently erase the __OW_NUM_CONCURRENCY KEY from the ingested manifest to ensure that the subsequent logic continues to work.
-            if(manifest.contains("__OW_NUM_CONCURRENCY")){
-                if(manifest["__OW_NUM_CONCURRENCY"].is_int64()){
-                    manifest_.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_int64();
-                } else if (manifest["__OW_NUM_CONCURRENCY"].is_uint64()){
-                    manifest_.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_uint64();
-                } else {
-                    std::cerr << "Manifest __OW_NUM_CONCURRENCY is too large, or is not an integer." << std::endl;
-                }
-                manifest.erase("__OW_NUM_CONCURRENCY");
-            }
-
-            // Loop through manifest.json until manifest_ contains the same number of keys.
-            while(manifest_.size() < manifest.size()){
-                // Find a key that isn't in the manifest_ yet.
-                auto it = std::find_if(manifest.begin(), manifest.end(), [&](auto& kvp){
-                    auto tmp = std::find_if(manifest_.begin(), manifest_.end(), [&](auto& rel){
-                        return rel->key() == kvp.key();
-                    });
-                    return (tmp != manifest_.end()) ? false : true;
-                });
-                // Insert it into the manifest, using a recursive tree traversal method.
-                std::string key(it->key());
-                manifest_.emplace(key, manifest); 
-            }
-            // Reverse lexicographically sort the manifest.
-            std::sort(manifest_.begin(), manifest_.end(), [&](std::shared_ptr<Relation> a, std::shared_ptr<Relation> b){
-                return a->depth() > b->depth();
-            });
-        } else {
-            const char* __OW_ACTION_EXT = getenv("__OW_ACTION_EXT");
-            if ( __OW_ACTION_EXT == nullptr ){
-                std::cerr << "execution-context.cpp:78:__OW_ACTION_EXT envvar is not defined." << std::endl;
-                throw "this shouldn't happen.";
-            }
-            // By default the file is called "main" + __OW_ACTION_EXT.
-            // e.g. "main.lua", or "main.py", or "main.js".
-            std::string filename("main");
-            filename.append(".");
-            filename.append(__OW_ACTION_EXT);
-            std::filesystem::path fn_path(action_path / filename);
-
-            const char* __OW_ACTION_ENTRY_POINT = getenv("__OW_ACTION_ENTRY_POINT");
-            std::string entrypoint;
-            if ( __OW_ACTION_ENTRY_POINT == nullptr ){
-                // By default, the entry point is called main.
-                entrypoint = std::string("main");
-            } else {
-                entrypoint = std::string(__OW_ACTION_ENTRY_POINT);
-            }
-            // By default, the entry point has no dependencies.
-            manifest_.push_back( std::make_shared<Relation>(std::move(entrypoint), std::move(fn_path), std::vector<std::shared_ptr<Relation> >()));
-        }
+        manifest_.instantiate(ActionManifest::load());
 
         // Create a temporary directory for scripting convenience in /tmp/ACTIVATION_ID
         std::filesystem::path tmp_dir("/tmp");
@@ -174,89 +92,7 @@ namespace app{
             peers_.push_back(peer_inet_addr);
         }
 
-        const char* __OW_ACTIONS = getenv("__OW_ACTIONS");
-        if ( __OW_ACTIONS == nullptr ){
-            std::cerr << "execution-context.cpp:140:__OW_ACTIONS envvar not defined." << std::endl;
-            throw "this shouldn't happen.";
-        }
-        std::filesystem::path action_path(__OW_ACTIONS);
-        std::filesystem::path manifest_path(action_path / "action-manifest.json");
-        if (std::filesystem::exists(manifest_path)){
-            std::fstream f(manifest_path, std::ios_base::in);
-            boost::json::error_code ec;
-            boost::json::value tmp = boost::json::parse(f,ec);
-            if (ec){
-                std::cerr << "execution-context.cpp:150:" << ec.message() << std::endl;
-                throw "boost json parse failed.";
-            }
-            boost::json::object manifest;
-            try{
-                manifest = tmp.as_object();
-            }catch(std::system_error& e){
-                std::cerr << "execution-context.cpp:196:tmp is not an object:" << boost::json::serialize(tmp) << std::endl;
-                throw e;
-            }
-            // If the manifest is empty throw an exception.
-            if(manifest.empty()){
-                std::cerr << "The action-manifest.json file can not be empty." << std::endl;
-                throw "action-manifest.json can't be empty.";
-            }
-            /* If the action manifest contains an __OW_NUM_CONCURRENCY key, set the manifest concurrency to that value, otherwise set it to 1.*/
-            // Subsequently erase the __OW_NUM_CONCURRENCY KEY from the ingested manifest to ensure that the subsequent logic continues to work.
-            if(manifest.contains("__OW_NUM_CONCURRENCY")){
-                if(manifest["__OW_NUM_CONCURRENCY"].is_int64()){
-                    manifest_.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_int64();
-                } else if (manifest["__OW_NUM_CONCURRENCY"].is_uint64()){
-                    manifest_.concurrency() = manifest["__OW_NUM_CONCURRENCY"].get_uint64();
-                } else {
-                    std::cerr << "Manifest __OW_NUM_CONCURRENCY is too large, or is not an integer." << std::endl;
-                    manifest_.concurrency() = 1;
-                }
-                manifest.erase("__OW_NUM_CONCURRENCY");
-            } else {
-                manifest_.concurrency() = 1;
-            }
-            // Loop through manifest.json until manifest_ contains the same number of keys.
-            while(manifest_.size() < manifest.size()){
-                // Find a key that isn't in the manifest_ yet.
-                auto it = std::find_if(manifest.begin(), manifest.end(), [&](auto& kvp){
-                    auto tmp = std::find_if(manifest_.begin(), manifest_.end(), [&](auto& rel){
-                        return rel->key() == kvp.key();
-                    });
-                    return (tmp != manifest_.end()) ? false : true;
-                });
-                // Insert it into the manifest, using a recursive tree traversal method.
-                std::string key(it->key());
-                manifest_.emplace(key, manifest);
-            }
-            // Reverse lexicographically sort the manifest.
-            std::sort(manifest_.begin(), manifest_.end(), [&](std::shared_ptr<Relation> a, std::shared_ptr<Relation> b){
-                return a->depth() > b->depth();
-            });
-        } else {
-            const char* __OW_ACTION_EXT = getenv("__OW_ACTION_EXT");
-            if ( __OW_ACTION_EXT == nullptr ){
-                std::cerr << "execution-context.cpp:194:__OW_ACTION_EXT envvar is not defined." << std::endl;
-                throw "Environment variable __OW_ACTION_EXT is not defined!";
-            }
-            // By default the file is called "main" + __OW_ACTION_EXT.
-            // e.g. "main.lua", or "main.py", or "main.js".
-            std::string filename("main");
-            filename.append(".");
-            filename.append(__OW_ACTION_EXT);
-            std::filesystem::path fn_path(action_path / filename);
-
-            const char* __OW_ACTION_ENTRY_POINT = getenv("__OW_ACTION_ENTRY_POINT");
-            std::string entrypoint;
-            if ( __OW_ACTION_ENTRY_POINT == nullptr ){
-                // By default, the entry point is called main.
-                entrypoint = std::string("main");
-            } else {
-                entrypoint = std::string(__OW_ACTION_ENTRY_POINT);
-            }
-            // By default, the entry point has no dependencies.
-            manifest_.push_back( std::make_shared<Relation>(std::move(entrypoint), std::move(fn_path), std::vector<std::shared_ptr<Relation> >()));
-        }
+        manifest_.instantiate(ActionManifest::load());
 
         // Create a temporary directory for scripting convenience in /tmp/ACTIVATION_ID
         std::filesystem::path tmp_dir("/tmp");
@@ -0,0 +1,199 @@
+#include "executor-cgroup.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static bool write_file(const std::string& path, std::string_view data){
+    int fd = -1;
+    do{
+        fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    }while(fd == -1 && errno == EINTR);
+    if(fd == -1){
+        return false;
+    }
+    int len = 0;
+    do{
+        len = write(fd, data.data(), data.size());
+    }while(len == -1 && errno == EINTR);
+    int error = errno;
+    if(close(fd) == -1){
+        std::cerr << "executor-cgroup.cpp:26:close() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "what?";
+    }
+    errno = error;
+    return (len == static_cast<int>(data.size()));
+}
+
+static bool make_cgroup(const std::string& path){
+    if(mkdir(path.c_str(), 0755) == -1){
+        switch(errno)
+        {
+            case EEXIST:
+                return true;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+namespace controller{
+namespace app{
+    /* Executor Cgroup Static Members */
+    bool ExecutorCgroup::enabled_ = false;
+    bool ExecutorCgroup::cpu_controller_ = false;
+    std::string ExecutorCgroup::root_;
+    std::mutex ExecutorCgroup::mtx_;
+    std::vector<std::string> ExecutorCgroup::stale_;
+
+    void ExecutorCgroup::init()
+    {
+        if(ExecutorCgroup::enabled_ || getenv("__OW_CGROUP_FREEZER") == nullptr){
+            return;
+        }
+        std::string root;
+        const char* __OW_CGROUP_ROOT = getenv("__OW_CGROUP_ROOT");
+        if(__OW_CGROUP_ROOT != nullptr){
+            root = __OW_CGROUP_ROOT;
+        } else {
+            // The cgroup v2 hierarchy has a single entry of the form 0::/path.
+            std::ifstream cgroup("/proc/self/cgroup");
+            std::string line;
+            while(std::getline(cgroup, line)){
+                if(line.rfind("0::", 0) == 0){
+                    root = "/sys/fs/cgroup" + line.substr(3);
+                    break;
+                }
+            }
+        }
+        while(!root.empty() && root.back() == '/'){
+            root.pop_back();
+        }
+        if(root.empty()){
+            std::cerr << "executor-cgroup.cpp:79:no cgroup v2 hierarchy was found, executors will be paused with signals." << std::endl;
+            return;
+        }
+        // Controllers can only be enabled in the subtree of a cgroup that has no processes of its own,
+        // so the controller moves itself into a leaf first.
+        if(!make_cgroup(root + "/controller") || !write_file(root + "/controller/cgroup.procs", std::to_string(getpid()))){
+            std::cerr << "executor-cgroup.cpp:85:" << root << " is not writable, executors will be paused with signals:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            return;
+        }
+        if(!make_cgroup(root + "/executors")){
+            std::cerr << "executor-cgroup.cpp:89:mkdir(" << root << "/executors) failed, executors will be paused with signals:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            return;
+        }
+        ExecutorCgroup::cpu_controller_ = write_file(root + "/cgroup.subtree_control", "+cpu") && write_file(root + "/executors/cgroup.subtree_control", "+cpu");
+        if(!ExecutorCgroup::cpu_controller_){
+            std::cerr << "executor-cgroup.cpp:94:the cpu controller is not available, executor CPU weights will not be set:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        }
+        ExecutorCgroup::root_ = root + "/executors";
+        ExecutorCgroup::enabled_ = true;
+        return;
+    }
+
+    std::string ExecutorCgroup::path(pid_t pid)
+    {
+        return ExecutorCgroup::root_ + "/" + std::to_string(pid);
+    }
+
+    void ExecutorCgroup::attach(pid_t pid)
+    {
+        if(!ExecutorCgroup::enabled_){
+            return;
+        }
+        ExecutorCgroup::sweep();
+        std::string cgroup = ExecutorCgroup::path(pid);
+        if(!make_cgroup(cgroup)){
+            std::cerr << "executor-cgroup.cpp:114:mkdir(" << cgroup << ") failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            return;
+        }
+        if(!write_file(cgroup + "/cgroup.procs", std::to_string(pid))){
+            // The executor has already exited, or can't be moved. Either way it is paused with signals.
+            if(rmdir(cgroup.c_str()) == -1 && errno != ENOENT){
+                std::cerr << "executor-cgroup.cpp:120:rmdir(" << cgroup << ") failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            }
+            return;
+        }
+        static const char* __OW_CGROUP_CPU_MAX = getenv("__OW_CGROUP_CPU_MAX");
+        if(ExecutorCgroup::cpu_controller_ && __OW_CGROUP_CPU_MAX != nullptr){
+            if(!write_file(cgroup + "/cpu.max", __OW_CGROUP_CPU_MAX)){
+                std::cerr << "executor-cgroup.cpp:127:invalid __OW_CGROUP_CPU_MAX=" << __OW_CGROUP_CPU_MAX << ":" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            }
+        }
+        return;
+    }
+
+    bool ExecutorCgroup::freeze(pid_t pid, bool frozen)
+    {
+        if(!ExecutorCgroup::enabled_){
+            return false;
+        }
+        // Executors that could not be attached to a cgroup fall back to signals.
+        return write_file(ExecutorCgroup::path(pid) + "/cgroup.freeze", (frozen) ? "1" : "0");
+    }
+
+    void ExecutorCgroup::set_weight(pid_t pid, std::uint32_t weight)
+    {
+        if(!ExecutorCgroup::enabled_ || !ExecutorCgroup::cpu_controller_){
+            return;
+        }
+        // cpu.weight must be in the range [1, 10000].
+        weight = std::clamp<std::uint32_t>(weight, 1, 10000);
+        write_file(ExecutorCgroup::path(pid) + "/cpu.weight", std::to_string(weight));
+        return;
+    }
+
+    bool ExecutorCgroup::kill(pid_t pid)
+    {
+        if(!ExecutorCgroup::enabled_){
+            return false;
+        }
+        // cgroup.kill sends SIGKILL to every process in the cgroup, even if it is frozen.
+        return write_file(ExecutorCgroup::path(pid) + "/cgroup.kill", "1");
+    }
+
+    void ExecutorCgroup::release(pid_t pid)
+    {
+        if(!ExecutorCgroup::enabled_){
+            return;
+        }
+        std::string cgroup = ExecutorCgroup::path(pid);
+        if(rmdir(cgroup.c_str()) == -1){
+            switch(errno)
+            {
+                case ENOENT:
+                    break;
+                case EBUSY:
+                {
+                    // Descendants of the executor are still running, try again later.
+                    std::unique_lock<std::mutex> lk(ExecutorCgroup::mtx_);
+                    ExecutorCgroup::stale_.push_back(std::move(cgroup));
+                    break;
+                }
+                default:
+                    std::cerr << "executor-cgroup.cpp:181:rmdir(" << cgroup << ") failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    break;
+            }
+        }
+        return;
+    }
+
+    void ExecutorCgroup::sweep()
+    {
+        std::unique_lock<std::mutex> lk(ExecutorCgroup::mtx_);
+        auto it = std::remove_if(ExecutorCgroup::stale_.begin(), ExecutorCgroup::stale_.end(), [](const std::string& cgroup){
+            return (rmdir(cgroup.c_str()) == 0 || errno != EBUSY);
+        });
+        ExecutorCgroup::stale_.erase(it, ExecutorCgroup::stale_.end());
+        return;
+    }
+    // End of Executor Cgroup Static Members
+}//namespace app
+}//namespace controller
@@ -0,0 +1,42 @@
+#ifndef EXECUTOR_CGROUP_HPP
+#define EXECUTOR_CGROUP_HPP
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace controller{
+namespace app{
+    /* Places every executor in its own cgroup v2 leaf, so that it can be preempted with the cgroup freezer. */
+    // Freezing a cgroup stops every process in it, including grandchildren that have left the executor process group,
+    // and the frozen processes can't observe it the way they can observe SIGSTOP. Executors are also given a cpu.weight
+    // when they are scheduled, so that relations on the critical path get a larger share of the CPU, and an optional
+    // cpu.max limit from __OW_CGROUP_CPU_MAX. The backend is enabled by setting __OW_CGROUP_FREEZER. The controller moves itself
+    // into a "controller" leaf of its own cgroup (or of __OW_CGROUP_ROOT) and creates executor cgroups under "executors".
+    // If the cgroup hierarchy is not writable, executors are paused and continued with signals.
+    class ExecutorCgroup
+    {
+    public:
+        static constexpr std::uint32_t DEFAULT_CPU_WEIGHT = 100;
+        static void init();
+        static bool enabled() { return enabled_; }
+        // The parent cgroup of the executor cgroups, that children of the zygote attach themselves to.
+        static const std::string& root() { return root_; }
+        static void attach(pid_t pid);
+        static bool freeze(pid_t pid, bool frozen);
+        static void set_weight(pid_t pid, std::uint32_t weight);
+        static bool kill(pid_t pid);
+        static void release(pid_t pid);
+    private:
+        static std::string path(pid_t pid);
+        static void sweep();
+        static bool enabled_;
+        static bool cpu_controller_;
+        static std::string root_;
+        static std::mutex mtx_;
+        static std::vector<std::string> stale_;
+    };
+}//namespace app
+}//namespace controller
+#endif
@@ -0,0 +1,347 @@
+#include "executor-reactor.hpp"
+#include "execution-context.hpp"
+#include "context-registry.hpp"
+#include "../io/controller-io.hpp"
+#include <iostream>
+#include <thread>
+#include <array>
+#include <string_view>
+#include <system_error>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace controller{
+namespace app{
+    /* Executor Reactor Static Members */
+    std::mutex ExecutorReactor::mtx_;
+    int ExecutorReactor::epfd_ = -1;
+    int ExecutorReactor::efd_ = -1;
+    std::uint64_t ExecutorReactor::next_id_ = 1;
+    std::deque<ExecutorReactor::Executor> ExecutorReactor::pending_;
+    std::map<std::uint64_t, ExecutorReactor::Executor> ExecutorReactor::executors_;
+
+    bool ExecutorReactor::enabled()
+    {
+        static const bool enabled = [](){
+            const char* __OW_EXECUTOR_ENGINE = getenv("__OW_EXECUTOR_ENGINE");
+            return (__OW_EXECUTOR_ENGINE != nullptr && std::string_view(__OW_EXECUTOR_ENGINE) == "epoll");
+        }();
+        return enabled;
+    }
+
+    void ExecutorReactor::add(std::shared_ptr<ExecutionContext> ctx_ptr, std::size_t idx, std::shared_ptr<controller::io::MessageBox> mbox_ptr)
+    {
+        std::unique_lock<std::mutex> lk(ExecutorReactor::mtx_);
+        if(ExecutorReactor::epfd_ == -1){
+            ExecutorReactor::epfd_ = epoll_create1(EPOLL_CLOEXEC);
+            if(ExecutorReactor::epfd_ == -1){
+                std::cerr << "executor-reactor.cpp:40:epoll_create1() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            ExecutorReactor::efd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if(ExecutorReactor::efd_ == -1){
+                std::cerr << "executor-reactor.cpp:45:eventfd() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            // The eventfd is identified by id 0.
+            struct epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = 0;
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_ADD, ExecutorReactor::efd_, &ev) == -1){
+                std::cerr << "executor-reactor.cpp:53:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            try{
+                std::thread reactor(&ExecutorReactor::run);
+                reactor.detach();
+            } catch(std::system_error& e){
+                std::cerr << "executor-reactor.cpp:60:executor reactor failed to start with error:" << e.what() << std::endl;
+                throw e;
+            }
+        }
+        ExecutorReactor::pending_.push_back({ctx_ptr, idx, mbox_ptr, -1, false, false, -1, false});
+        lk.unlock();
+        ExecutorReactor::wake();
+        return;
+    }
+
+    void ExecutorReactor::wake()
+    {
+        if(!ExecutorReactor::enabled()){
+            return;
+        }
+        std::unique_lock<std::mutex> lk(ExecutorReactor::mtx_);
+        if(ExecutorReactor::efd_ == -1){
+            return;
+        }
+        std::uint64_t notice = 1;
+        int len = 0;
+        do{
+            len = write(ExecutorReactor::efd_, &notice, sizeof(notice));
+            if(len == -1){
+                switch(errno)
+                {
+                    case EINTR:
+                        break;
+                    case EAGAIN:
+                        // The counter is saturated, so the reactor is already going to wake up.
+                        return;
+                    default:
+                        std::cerr << "executor-reactor.cpp:92:write(efd) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            }
+        }while(len == -1);
+        return;
+    }
+
+    void ExecutorReactor::unregister(Executor& executor)
+    {
+        if(executor.registered){
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_DEL, executor.fd, nullptr) == -1){
+                std::cerr << "executor-reactor.cpp:104:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            executor.registered = false;
+        }
+        if(executor.writing){
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_DEL, executor.wfd, nullptr) == -1){
+                std::cerr << "executor-reactor.cpp:112:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            executor.writing = false;
+        }
+        return;
+    }
+
+    std::map<std::uint64_t, ExecutorReactor::Executor>::iterator ExecutorReactor::finish(std::map<std::uint64_t, Executor>::iterator it, bool stopped)
+    {
+        auto& executor = it->second;
+        auto& thread_control = executor.ctx_ptr->thread_controls()[executor.idx];
+        // The fd must be removed from the epoll set before the pipe is closed or released.
+        ExecutorReactor::unregister(executor);
+        if(stopped){
+            thread_control.cleanup();
+        } else {
+            thread_control.thread_continue();
+        }
+        thread_control.signal().fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+        ContextRegistry::signal(executor.ctx_ptr);
+        executor.mbox_ptr->sched_signal_ptr->fetch_or(CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
+        executor.mbox_ptr->sched_signal_cv_ptr->notify_one();
+        return ExecutorReactor::executors_.erase(it);
+    }
+
+    std::map<std::uint64_t, ExecutorReactor::Executor>::iterator ExecutorReactor::fail(std::map<std::uint64_t, Executor>::iterator it)
+    {
+        auto& executor = it->second;
+        try{
+            ExecutorReactor::unregister(executor);
+        } catch(...){
+            // The fds are dropped from the epoll set when the pipes are closed.
+            executor.registered = false;
+            executor.writing = false;
+        }
+        return ExecutorReactor::finish(it, true);
+    }
+
+    void ExecutorReactor::handle(std::map<std::uint64_t, Executor>::iterator it, std::uint32_t events)
+    {
+        auto& executor = it->second;
+        auto& thread_control = executor.ctx_ptr->thread_controls()[executor.idx];
+        switch(thread_control.state())
+        {
+            case 1:
+                if(!(events & EPOLLIN)){
+                    // The launcher exited before it sent the ready handshake, a pipe with no writers and no data only reports the hang up.
+                    ExecutorReactor::finish(it, true);
+                    break;
+                }
+                // The launcher ready handshake has arrived, pause the launcher until it is scheduled.
+                thread_control.thread_continue();
+                thread_control.thread_continue();
+                executor.ready = true;
+                break;
+            case 5:
+                thread_control.thread_continue();
+                if(thread_control.state() != 6){
+                    if(events & (EPOLLHUP | EPOLLERR)){
+                        ExecutorReactor::finish(it, true);
+                    }
+                    break;
+                }
+                [[fallthrough]];
+            case 6:
+                if(thread_control.read_available()){
+                    ExecutorReactor::finish(it, false);
+                }
+                break;
+            default:
+                // The launcher exited while it was waiting to be scheduled. Stop watching the pipe, it will be
+                // cleaned up when the executor fails to continue.
+                if(events & (EPOLLHUP | EPOLLERR)){
+                    ExecutorReactor::unregister(executor);
+                }
+                break;
+        }
+        return;
+    }
+
+    void ExecutorReactor::handle_write(std::uint64_t id, Executor& executor, std::uint32_t events)
+    {
+        auto& thread_control = executor.ctx_ptr->thread_controls()[executor.idx];
+        // The downstream pipe is registered one shot, so that it is never left armed after write_available() has closed it.
+        executor.writing = false;
+        if(events & EPOLLERR){
+            // The launcher exited before it read its parameters, its result pipe reports the hang up.
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_DEL, executor.wfd, nullptr) == -1){
+                std::cerr << "executor-reactor.cpp:183:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            return;
+        }
+        if(!thread_control.write_available()){
+            struct epoll_event ev = {};
+            ev.events = EPOLLOUT | EPOLLONESHOT;
+            ev.data.u64 = id | ExecutorReactor::WRITE_ID;
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_MOD, executor.wfd, &ev) == -1){
+                std::cerr << "executor-reactor.cpp:193:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            executor.writing = true;
+        } else if(thread_control.params_fd() != -1){
+            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_DEL, executor.wfd, nullptr) == -1){
+                std::cerr << "executor-reactor.cpp:199:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+        }
+        return;
+    }
+
+    void ExecutorReactor::run()
+    {
+        std::array<struct epoll_event, 64> events;
+        while(true){
+            int nfds = epoll_wait(ExecutorReactor::epfd_, events.data(), events.size(), -1);
+            if(nfds == -1){
+                switch(errno)
+                {
+                    case EINTR:
+                        continue;
+                    default:
+                        std::cerr << "executor-reactor.cpp:177:epoll_wait() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            }
+            for(int i = 0; i < nfds; ++i){
+                std::uint64_t id = events[i].data.u64;
+                if(id == 0){
+                    std::uint64_t notice = 0;
+                    while(read(ExecutorReactor::efd_, &notice, sizeof(notice)) == -1 && errno == EINTR){}
+                    continue;
+                }
+                if(id & ExecutorReactor::WRITE_ID){
+                    auto it = ExecutorReactor::executors_.find(id & ~ExecutorReactor::WRITE_ID);
+                    if(it != ExecutorReactor::executors_.end() && it->second.writing){
+                        try{
+                            ExecutorReactor::handle_write(it->first, it->second, events[i].events);
+                        } catch(...){
+                            std::cerr << "executor-reactor.cpp:252:executor failed while writing its parameters." << std::endl;
+                            ExecutorReactor::fail(it);
+                        }
+                    }
+                    continue;
+                }
+                auto it = ExecutorReactor::executors_.find(id);
+                if(it != ExecutorReactor::executors_.end()){
+                    try{
+                        ExecutorReactor::handle(it, events[i].events);
+                    } catch(...){
+                        std::cerr << "executor-reactor.cpp:263:executor failed while handling an event." << std::endl;
+                        ExecutorReactor::fail(it);
+                    }
+                }
+            }
+
+            // Register the executors that have been added since the last iteration.
+            std::unique_lock<std::mutex> lk(ExecutorReactor::mtx_);
+            std::deque<Executor> pending;
+            pending.swap(ExecutorReactor::pending_);
+            lk.unlock();
+            for(auto& pending_executor: pending){
+                // Executors are tracked before they are registered, so that an executor that fails to register is stopped.
+                std::uint64_t id = ExecutorReactor::next_id_++;
+                auto it = ExecutorReactor::executors_.emplace(id, std::move(pending_executor)).first;
+                auto& executor = it->second;
+                try{
+                    auto& thread_control = executor.ctx_ptr->thread_controls()[executor.idx];
+                    executor.fd = thread_control.result_fd();
+                    executor.wfd = thread_control.params_fd();
+                    for(int fd: {executor.fd, executor.wfd}){
+                        int flags = fcntl(fd, F_GETFL);
+                        if(flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1){
+                            std::cerr << "executor-reactor.cpp:204:fcntl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                            throw "what?";
+                        }
+                    }
+                    if(thread_control.state() == 2){
+                        // Pooled launchers have already completed the ready handshake.
+                        thread_control.thread_continue();
+                        executor.ready = true;
+                    }
+                    struct epoll_event ev = {};
+                    ev.events = EPOLLIN;
+                    ev.data.u64 = id;
+                    if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_ADD, executor.fd, &ev) == -1){
+                        std::cerr << "executor-reactor.cpp:217:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                    }
+                    executor.registered = true;
+                } catch(...){
+                    std::cerr << "executor-reactor.cpp:304:executor failed to register." << std::endl;
+                    ExecutorReactor::fail(it);
+                }
+            }
+
+            // Advance executors that have been scheduled or stopped since the last iteration.
+            auto it = ExecutorReactor::executors_.begin();
+            while(it != ExecutorReactor::executors_.end()){
+                auto& executor = it->second;
+                auto& thread_control = executor.ctx_ptr->thread_controls()[executor.idx];
+                try{
+                    if(thread_control.is_stopped()){
+                        it = ExecutorReactor::finish(it, true);
+                    } else if(executor.ready && thread_control.is_started() && thread_control.state() == 3){
+                        // Continue the launcher, and write the parameters. The result is read when the pipe is readable.
+                        if(!(thread_control.thread_continue() && thread_control.thread_continue())){
+                            it = ExecutorReactor::finish(it, true);
+                            continue;
+                        }
+                        if(thread_control.params_pending()){
+                            // The rest of the parameters is written when the downstream pipe is writable.
+                            struct epoll_event ev = {};
+                            ev.events = EPOLLOUT | EPOLLONESHOT;
+                            ev.data.u64 = it->first | ExecutorReactor::WRITE_ID;
+                            if(epoll_ctl(ExecutorReactor::epfd_, EPOLL_CTL_ADD, executor.wfd, &ev) == -1){
+                                std::cerr << "executor-reactor.cpp:293:epoll_ctl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                                throw "what?";
+                            }
+                            executor.writing = true;
+                        }
+                        ++it;
+                    } else {
+                        ++it;
+                    }
+                } catch(...){
+                    std::cerr << "executor-reactor.cpp:339:executor failed to continue." << std::endl;
+                    it = ExecutorReactor::fail(it);
+                }
+            }
+        }
+    }
+    // End of Executor Reactor Static Members
+}//namespace app
+}//namespace controller
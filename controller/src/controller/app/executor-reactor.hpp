@@ -0,0 +1,66 @@
+#ifndef EXECUTOR_REACTOR_HPP
+#define EXECUTOR_REACTOR_HPP
+#include <memory>
+#include <mutex>
+#include <map>
+#include <deque>
+#include <cstdint>
+
+/*Forward Declarations*/
+namespace controller{
+namespace io{
+    struct MessageBox;
+}
+namespace app{
+    class ExecutionContext;
+}
+}
+
+namespace controller{
+namespace app{
+    /* An event driven alternative to running one detached executor thread per relation. */
+    // Launcher pipes are registered with a single epoll instance, and the ThreadControls state machine is advanced
+    // on readiness events instead of by polling the pipe. Scheduling notifications wake the reactor through an eventfd,
+    // so no timers are involved however many relations are in flight. The reactor is selected by setting
+    // __OW_EXECUTOR_ENGINE=epoll, the default is one thread per relation.
+    // Parameters are written to a non-blocking pipe, and whatever does not fit is written when the pipe becomes
+    // writable, so a slow launcher never stalls the other executors on the reactor.
+    class ExecutorReactor
+    {
+    public:
+        static bool enabled();
+        static void add(std::shared_ptr<ExecutionContext> ctx_ptr, std::size_t idx, std::shared_ptr<controller::io::MessageBox> mbox_ptr);
+        static void wake();
+    private:
+        struct Executor
+        {
+            std::shared_ptr<ExecutionContext> ctx_ptr;
+            std::size_t idx;
+            std::shared_ptr<controller::io::MessageBox> mbox_ptr;
+            int fd;
+            bool registered;
+            bool ready;
+            // The downstream pipe is only watched while parameters that did not fit into it are pending.
+            int wfd;
+            bool writing;
+        };
+        // Writability of the downstream pipe is reported with the id of the executor with the top bit set.
+        static constexpr std::uint64_t WRITE_ID = std::uint64_t(1) << 63;
+        static void run();
+        static void handle(std::map<std::uint64_t, Executor>::iterator it, std::uint32_t events);
+        static void handle_write(std::uint64_t id, Executor& executor, std::uint32_t events);
+        static std::map<std::uint64_t, Executor>::iterator finish(std::map<std::uint64_t, Executor>::iterator it, bool stopped);
+        static void unregister(Executor& executor);
+        // Stops an executor whose state machine threw, so that only its relation fails.
+        static std::map<std::uint64_t, Executor>::iterator fail(std::map<std::uint64_t, Executor>::iterator it);
+
+        static std::mutex mtx_;
+        static int epfd_;
+        static int efd_;
+        static std::uint64_t next_id_;
+        static std::deque<Executor> pending_;
+        static std::map<std::uint64_t, Executor> executors_;
+    };
+}//namespace app
+}//namespace controller
+#endif
@@ -0,0 +1,216 @@
+#include "json-splitter.hpp"
+#include <algorithm>
+#include <cstring>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace controller{
+namespace app{
+    namespace {
+        constexpr std::size_t BLOCK_SZ = 64;
+        constexpr std::uint64_t ODD_BITS = 0xAAAAAAAAAAAAAAAAULL;
+
+        struct Block
+        {
+            std::uint64_t quote;
+            std::uint64_t backslash;
+            // Braces and brackets.
+            std::uint64_t structural;
+        };
+
+        #ifdef __SSE2__
+        inline std::uint64_t eq(const __m128i (&v)[4], char c){
+            const __m128i m = _mm_set1_epi8(c);
+            std::uint64_t r = 0;
+            for(int i = 0; i < 4; ++i){
+                r |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], m)))) << (16*i);
+            }
+            return r;
+        }
+
+        // '[' and ']' differ from '{' and '}' only in the 0x20 bit.
+        inline std::uint64_t structural(const __m128i (&v)[4]){
+            const __m128i lower = _mm_set1_epi8(0x20);
+            const __m128i open = _mm_set1_epi8('{');
+            const __m128i close = _mm_set1_epi8('}');
+            std::uint64_t r = 0;
+            for(int i = 0; i < 4; ++i){
+                const __m128i c = _mm_or_si128(v[i], lower);
+                r |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(c, open), _mm_cmpeq_epi8(c, close))))) << (16*i);
+            }
+            return r;
+        }
+        #endif
+
+        inline Block classify(const char* p){
+            Block b;
+            #ifdef __SSE2__
+            const __m128i v[4] = {
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48))
+            };
+            b.quote = eq(v, '"');
+            b.backslash = eq(v, '\\');
+            b.structural = structural(v);
+            #else
+            b = {};
+            for(std::size_t i = 0; i < BLOCK_SZ; ++i){
+                const std::uint64_t bit = 1ULL << i;
+                switch(p[i])
+                {
+                    case '"': b.quote |= bit; break;
+                    case '\\': b.backslash |= bit; break;
+                    case '{': case '}': case '[': case ']': b.structural |= bit; break;
+                }
+            }
+            #endif
+            return b;
+        }
+
+        // Bit i of the result is the parity of bits 0..i of x.
+        inline std::uint64_t prefix_xor(std::uint64_t x){
+            #ifdef __PCLMUL__
+            return static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, x), _mm_set1_epi8('\xFF'), 0)));
+            #else
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+            #endif
+        }
+    }
+
+    void JsonSplitter::feed(std::string_view chunk)
+    {
+        chunk_ = chunk;
+        pos_ = 0;
+        // An unfinished object continues from the start of the chunk.
+        start_ = 0;
+        return;
+    }
+
+    std::string_view JsonSplitter::next()
+    {
+        if(carried_){
+            carry_.clear();
+            carried_ = false;
+        }
+        while(pos_ < chunk_.size()){
+            std::size_t n = std::min(chunk_.size() - pos_, BLOCK_SZ);
+            for(std::uint64_t bits = structurals(chunk_.data() + pos_, n); bits != 0; bits &= bits - 1){
+                std::size_t at = pos_ + __builtin_ctzll(bits);
+                switch(chunk_[at])
+                {
+                    case '{':
+                    {
+                        if(depth_++ == 0){
+                            start_ = at;
+                        }
+                        break;
+                    }
+                    case '}':
+                    {
+                        if(depth_ == 0){
+                            // ignore spurious closing braces.
+                            break;
+                        }
+                        if(--depth_ == 0){
+                            return complete(at + 1);
+                        }
+                        break;
+                    }
+                    case '[':
+                    {
+                        if(depth_ == 0){
+                            ++brackets_;
+                        }
+                        break;
+                    }
+                    case ']':
+                    {
+                        if(depth_ == 0 && --brackets_ <= 0){
+                            /* The array is closed. */
+                            brackets_ = 0;
+                            pos_ = at + 1;
+                            reset_carries();
+                            return chunk_.substr(at, 1);
+                        }
+                        break;
+                    }
+                }
+            }
+            pos_ += n;
+        }
+        if(depth_ > 0 && start_ < chunk_.size()){
+            carry_.append(chunk_.substr(start_));
+            start_ = chunk_.size();
+        }
+        return std::string_view();
+    }
+
+    void JsonSplitter::clear()
+    {
+        chunk_ = std::string_view();
+        pos_ = 0;
+        start_ = 0;
+        depth_ = 0;
+        brackets_ = 0;
+        reset_carries();
+        carry_.clear();
+        carried_ = false;
+        return;
+    }
+
+    std::uint64_t JsonSplitter::structurals(const char* p, std::size_t n)
+    {
+        // The tail of the chunk is padded with spaces, which are never structural.
+        char tail[BLOCK_SZ];
+        if(n < BLOCK_SZ){
+            std::memset(tail, ' ', BLOCK_SZ);
+            std::memcpy(tail, p, n);
+            p = tail;
+        }
+        Block b = classify(p);
+
+        // A backslash escapes the next character unless it is escaped itself. Subtracting each run of backslashes from
+        // the position after it marks the characters that follow a run of odd length.
+        std::uint64_t escaped = escaped_;
+        if(b.backslash != 0){
+            std::uint64_t escapes = b.backslash & ~escaped_;
+            std::uint64_t codes = (((escapes << 1) | ODD_BITS) - escapes) ^ ODD_BITS;
+            escaped = codes ^ (b.backslash | escaped_);
+            escaped_ = (codes & b.backslash) >> 63;
+        } else {
+            escaped_ = 0;
+        }
+        if(n < BLOCK_SZ){
+            // The escape carry comes from the last byte of the chunk instead of the end of the block.
+            escaped_ = (escaped >> n) & 1;
+        }
+
+        // Every unescaped quote toggles the string state.
+        std::uint64_t in_string = prefix_xor(b.quote & ~escaped) ^ in_string_;
+        in_string_ = 0 - ((in_string >> (n - 1)) & 1);
+        return b.structural & ~in_string;
+    }
+
+    std::string_view JsonSplitter::complete(std::size_t end)
+    {
+        pos_ = end;
+        reset_carries();
+        std::string_view obj = chunk_.substr(start_, end - start_);
+        if(carry_.empty()){
+            return obj;
+        }
+        carry_.append(obj);
+        carried_ = true;
+        return carry_;
+    }
+}//namespace app
+}//namespace controller
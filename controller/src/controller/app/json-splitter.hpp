@@ -0,0 +1,52 @@
+#ifndef JSON_SPLITTER_HPP
+#define JSON_SPLITTER_HPP
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace controller{
+namespace app{
+    /* Splits a streamed array of JSON objects, [{...}, {...}, ...], into its top level objects. */
+    // The stream is scanned 64 bytes at a time: the quotes, backslashes, braces and brackets of each block are found
+    // with vector compares, the escaped characters and the string literals are masked out with carry-less bit arithmetic,
+    // and only the braces and brackets that remain are visited to track the nesting depth. Braces inside string values
+    // therefore don't break the framing.
+    // The scan is resumable: the string, escape and depth state is carried from one chunk to the next, and an object
+    // that is split across chunks is collected into a carry buffer, so every chunk is only scanned once.
+    class JsonSplitter
+    {
+    public:
+        JsonSplitter() = default;
+
+        // Starts scanning the next chunk of the stream. The chunk must stay valid until it has been consumed.
+        void feed(std::string_view chunk);
+        // Returns the next complete top level object, or "]" when the array is closed. An empty view is returned once the
+        // chunk has been consumed. Views are valid until the next call to feed or next.
+        std::string_view next();
+        // True if the stream stopped in the middle of an object.
+        bool pending() const { return depth_ > 0; }
+        void clear();
+
+    private:
+        // Finds the unquoted braces and brackets of the first n <= 64 bytes of p, and carries the string state forward.
+        std::uint64_t structurals(const char* p, std::size_t n);
+        void reset_carries() { in_string_ = 0; escaped_ = 0; }
+        std::string_view complete(std::size_t end);
+
+        std::string_view chunk_;
+        std::size_t pos_ = 0;
+        // The start of the current object in the chunk.
+        std::size_t start_ = 0;
+        std::size_t depth_ = 0;
+        long brackets_ = 0;
+        // All ones if the previous block ended inside a string literal.
+        std::uint64_t in_string_ = 0;
+        // 1 if the first byte of the next block is escaped.
+        std::uint64_t escaped_ = 0;
+        // The leading part of an object that started in an earlier chunk.
+        std::string carry_;
+        bool carried_ = false;
+    };
+}//namespace app
+}//namespace controller
+#endif
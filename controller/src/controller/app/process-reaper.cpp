@@ -0,0 +1,195 @@
+#include "process-reaper.hpp"
+#include "executor-cgroup.hpp"
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+static int pidfd_open(pid_t pid){
+    #ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+    #else
+    errno = ENOSYS;
+    return -1;
+    #endif
+}
+
+namespace controller{
+namespace app{
+    /* Process Reaper Static Members */
+    boost::asio::io_context* ProcessReaper::ioc_ = nullptr;
+    std::atomic<bool> ProcessReaper::polling_{true};
+    std::atomic<std::size_t> ProcessReaper::reaped_{0};
+    std::atomic<std::size_t> ProcessReaper::signaled_{0};
+    std::atomic<std::uint64_t> ProcessReaper::cpu_time_us_{0};
+    std::mutex ProcessReaper::mtx_;
+    std::vector<pid_t> ProcessReaper::watched_;
+
+    void ProcessReaper::init(boost::asio::io_context& ioc)
+    {
+        ProcessReaper::ioc_ = &ioc;
+        int pidfd = pidfd_open(getpid());
+        if(pidfd == -1){
+            std::cerr << "process-reaper.cpp:34:pidfd_open() failed, falling back to waitpid:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            return;
+        }
+        if(close(pidfd) == -1){
+            std::cerr << "process-reaper.cpp:38:close(pidfd) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        ProcessReaper::polling_.store(false, std::memory_order::memory_order_relaxed);
+        return;
+    }
+
+    void ProcessReaper::track(pid_t pid)
+    {
+        if(ProcessReaper::polling()){
+            return;
+        }
+        int pidfd = pidfd_open(pid);
+        if(pidfd == -1){
+            switch(errno)
+            {
+                case ESRCH:
+                    // The process has already been reaped.
+                    return;
+                default:
+                    std::cerr << "process-reaper.cpp:58:pidfd_open() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+        auto descriptor = std::make_shared<boost::asio::posix::stream_descriptor>(*ProcessReaper::ioc_, pidfd);
+        descriptor->async_wait(boost::asio::posix::stream_descriptor::wait_read, [descriptor, pid](const boost::system::error_code& ec){
+            if(ec){
+                return;
+            }
+            // The pidfd is readable once the process has exited.
+            int status = 0;
+            struct rusage ru = {};
+            pid_t reaped = 0;
+            do{
+                reaped = wait4(pid, &status, WNOHANG, &ru);
+            }while(reaped == -1 && errno == EINTR);
+            if(reaped != pid){
+                return;
+            }
+            ExecutorCgroup::release(pid);
+            std::uint64_t utime = ru.ru_utime.tv_sec*1000000 + ru.ru_utime.tv_usec;
+            std::uint64_t stime = ru.ru_stime.tv_sec*1000000 + ru.ru_stime.tv_usec;
+            ProcessReaper::reaped_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            ProcessReaper::cpu_time_us_.fetch_add(utime + stime, std::memory_order::memory_order_relaxed);
+            if(WIFSIGNALED(status)){
+                ProcessReaper::signaled_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            }
+            #ifdef OW_PROFILE
+            std::cout << "process-reaper.cpp:85:pid=" << pid
+                << ":status=" << ((WIFEXITED(status)) ? WEXITSTATUS(status) : -WTERMSIG(status))
+                << ":utime=" << utime << "us:stime=" << stime << "us:maxrss=" << ru.ru_maxrss << "kB" << std::endl;
+            #endif
+            return;
+        });
+        return;
+    }
+
+    void ProcessReaper::watch(pid_t pid)
+    {
+        if(ProcessReaper::polling()){
+            std::unique_lock<std::mutex> lk(ProcessReaper::mtx_);
+            ProcessReaper::watched_.push_back(pid);
+            return;
+        }
+        int pidfd = pidfd_open(pid);
+        if(pidfd == -1){
+            switch(errno)
+            {
+                case ESRCH:
+                    // The process has already exited.
+                    ExecutorCgroup::release(pid);
+                    return;
+                default:
+                    std::cerr << "process-reaper.cpp:115:pidfd_open() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+        auto descriptor = std::make_shared<boost::asio::posix::stream_descriptor>(*ProcessReaper::ioc_, pidfd);
+        descriptor->async_wait(boost::asio::posix::stream_descriptor::wait_read, [descriptor, pid](const boost::system::error_code& ec){
+            if(ec){
+                return;
+            }
+            // The pidfd is readable once the process has exited, and the zygote reaps it.
+            ExecutorCgroup::release(pid);
+            ProcessReaper::reaped_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            return;
+        });
+        return;
+    }
+
+    void ProcessReaper::poll()
+    {
+        std::unique_lock<std::mutex> lk(ProcessReaper::mtx_);
+        auto it = std::remove_if(ProcessReaper::watched_.begin(), ProcessReaper::watched_.end(), [](pid_t pid){
+            if(kill(pid, 0) == -1 && errno == ESRCH){
+                ExecutorCgroup::release(pid);
+                return true;
+            }
+            return false;
+        });
+        ProcessReaper::watched_.erase(it, ProcessReaper::watched_.end());
+        return;
+    }
+
+    bool ProcessReaper::escalate(pid_t pid)
+    {
+        if(ProcessReaper::ioc_ == nullptr || ProcessReaper::polling()){
+            return false;
+        }
+        // The pidfd tells the timer whether the executor has exited, before its pid can be reused.
+        int pidfd = pidfd_open(pid);
+        if(pidfd == -1){
+            switch(errno)
+            {
+                case ESRCH:
+                    // The executor has already been reaped.
+                    return true;
+                default:
+                    std::cerr << "process-reaper.cpp:161:pidfd_open() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    return false;
+            }
+        }
+        auto descriptor = std::make_shared<boost::asio::posix::stream_descriptor>(*ProcessReaper::ioc_, pidfd);
+        auto timer = std::make_shared<boost::asio::steady_timer>(*ProcessReaper::ioc_, ProcessReaper::KILL_ESCALATION_MS);
+        descriptor->async_wait(boost::asio::posix::stream_descriptor::wait_read, [timer](const boost::system::error_code& ec){
+            if(!ec){
+                // The executor exited within the grace period.
+                timer->cancel();
+            }
+            return;
+        });
+        timer->async_wait([timer, descriptor, pid](const boost::system::error_code& ec){
+            descriptor->cancel();
+            if(ec){
+                return;
+            }
+            // The pidfd and the timer can both be ready in the same round.
+            struct pollfd pfd = {descriptor->native_handle(), POLLIN, 0};
+            if(::poll(&pfd, 1, 0) != 0){
+                return;
+            }
+            // Descendants that have left the process group are only reachable through the executor cgroup.
+            ExecutorCgroup::kill(pid);
+            if(kill(-pid, SIGKILL) == -1 && errno != ESRCH){
+                std::cerr << "process-reaper.cpp:187:kill() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            }
+            return;
+        });
+        return true;
+    }
+    // End of Process Reaper Static Members
+}//namespace app
+}//namespace controller
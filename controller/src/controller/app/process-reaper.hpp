@@ -0,0 +1,52 @@
+#ifndef PROCESS_REAPER_HPP
+#define PROCESS_REAPER_HPP
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <sys/types.h>
+
+/*Forward Declarations*/
+namespace boost{
+namespace asio{
+    class io_context;
+}
+}
+
+namespace controller{
+namespace app{
+    /* Reaps executor processes as soon as they exit by registering a pidfd for each of them on the io_context. */
+    // Termination is escalated from SIGTERM to SIGKILL with a timer on the io_context instead of a blocking sleep, and the
+    // timer is cancelled if the executor exits first.
+    // If pidfds are not supported by the kernel, the controller falls back to polling with waitpid(-1) at the end of
+    // every scheduling round. Children of the zygote are reaped by the zygote, so they are only watched, and their
+    // executor cgroups are released when they exit.
+    class ProcessReaper
+    {
+    public:
+        static constexpr std::chrono::milliseconds KILL_ESCALATION_MS = std::chrono::milliseconds(20);
+        static void init(boost::asio::io_context& ioc);
+        static bool polling() { return polling_.load(std::memory_order::memory_order_relaxed); }
+        static void track(pid_t pid);
+        static void watch(pid_t pid);
+        // Releases the watched processes that have exited, when pidfds are not supported.
+        static void poll();
+        static bool escalate(pid_t pid);
+
+        // Accounting.
+        static std::size_t reaped() { return reaped_.load(std::memory_order::memory_order_relaxed); }
+        static std::size_t signaled() { return signaled_.load(std::memory_order::memory_order_relaxed); }
+        static std::chrono::microseconds cpu_time() { return std::chrono::microseconds(cpu_time_us_.load(std::memory_order::memory_order_relaxed)); }
+    private:
+        static boost::asio::io_context* ioc_;
+        static std::atomic<bool> polling_;
+        static std::atomic<std::size_t> reaped_;
+        static std::atomic<std::size_t> signaled_;
+        static std::atomic<std::uint64_t> cpu_time_us_;
+        static std::mutex mtx_;
+        static std::vector<pid_t> watched_;
+    };
+}//namespace app
+}//namespace controller
+#endif
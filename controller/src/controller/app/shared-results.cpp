@@ -0,0 +1,91 @@
+#include "shared-results.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace controller{
+namespace app{
+    /* Shared Results Static Members */
+    bool SharedResults::enabled()
+    {
+        static const bool enabled = (getenv("__OW_MEMFD_RESULTS") != nullptr);
+        return enabled;
+    }
+
+    int SharedResults::create()
+    {
+        int fd = memfd_create("ow-result", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if(fd == -1){
+            switch(errno)
+            {
+                case EMFILE:
+                case ENFILE:
+                case ENOMEM:
+                    // Fall back to the launcher pipes for this invocation.
+                    return -1;
+                default:
+                    std::cerr << "shared-results.cpp:31:memfd_create() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+        return fd;
+    }
+
+    std::string SharedResults::path(int fd)
+    {
+        static const std::string prefix = "/proc/" + std::to_string(getpid()) + "/fd/";
+        return prefix + std::to_string(fd);
+    }
+
+    bool SharedResults::load(int fd, std::string_view length, std::string& value)
+    {
+        std::size_t size = 0;
+        std::from_chars_result fcres = std::from_chars(length.data(), length.data() + length.size(), size, 10);
+        if(fcres.ec != std::errc() || fcres.ptr != length.data() + length.size()){
+            std::cerr << "shared-results.cpp:49:invalid result length from the launcher:" << length << std::endl;
+            return false;
+        }
+        // Sealing the memfd guarantees that the result can't change after it has been handed to the dependents.
+        if(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1){
+            std::cerr << "shared-results.cpp:54:fcntl(F_ADD_SEALS) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            return false;
+        }
+        value.resize(size);
+        std::size_t bytes_read = 0;
+        while(bytes_read < size){
+            ssize_t len = pread(fd, value.data() + bytes_read, size - bytes_read, bytes_read);
+            if(len == -1){
+                switch(errno)
+                {
+                    case EINTR:
+                        continue;
+                    default:
+                        std::cerr << "shared-results.cpp:67:pread() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            } else if(len == 0){
+                std::cerr << "shared-results.cpp:71:the result memfd is shorter than the result length." << std::endl;
+                value.clear();
+                return false;
+            }
+            bytes_read += len;
+        }
+        return true;
+    }
+
+    void SharedResults::close(int& fd)
+    {
+        if(fd != -1 && ::close(fd) == -1){
+            std::cerr << "shared-results.cpp:83:close() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        fd = -1;
+        return;
+    }
+    // End of Shared Results Static Members
+}//namespace app
+}//namespace controller
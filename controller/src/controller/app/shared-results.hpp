@@ -0,0 +1,28 @@
+#ifndef SHARED_RESULTS_HPP
+#define SHARED_RESULTS_HPP
+#include <string>
+#include <string_view>
+
+namespace controller{
+namespace app{
+    /* Passes relation results between executors in sealed memfds instead of through the launcher pipes. */
+    // The controller creates a memfd for every invocation and names it in the parameter frame, together with the
+    // memfds holding the results of the dependencies of the relation:
+    // {"__OW_RESULT":"/proc/<pid>/fd/<n>", "__OW_PARAMS":{...}, "__OW_MEMFD":{"<key>":"/proc/<pid>/fd/<m>", ...}}
+    // The launcher reads its dependencies from the named memfds, writes its result into the result memfd, and writes
+    // only the length of the result to fd 3. The controller then seals the memfd so that it can be handed to the dependents
+    // as it is. Launchers open the memfds through the /proc file descriptor table of the controller, so they must run
+    // as the same user. The transport is enabled by setting __OW_MEMFD_RESULTS, and if a memfd can't be created the
+    // invocation falls back to the pipes.
+    class SharedResults
+    {
+    public:
+        static bool enabled();
+        static int create();
+        static std::string path(int fd);
+        static bool load(int fd, std::string_view length, std::string& value);
+        static void close(int& fd);
+    };
+}//namespace app
+}//namespace controller
+#endif
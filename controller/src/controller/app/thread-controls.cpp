@@ -1,10 +1,22 @@
 #include "thread-controls.hpp"
+#include "zygote.hpp"
+#include "process-reaper.hpp"
+#include "executor-reactor.hpp"
+#include "executor-cgroup.hpp"
+#include "shared-results.hpp"
 #include <csignal>
 #include <iostream>
 #include <sys/resource.h>
 #include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <unistd.h>
+#include <spawn.h>
+#include <charconv>
+#include <climits>
+#include <algorithm>
+#include <string_view>
 
 #define MAX_LENGTH 65535
 
@@ -124,6 +136,9 @@ static bool fork_exec(std::array<int, 2>& pipe_, pid_t& pid_, std::shared_ptr<co
     std::string p = relation->path().stem().string();
     std::string k = relation->key();
     std::vector<const char*> argv{__OW_ACTION_BIN, __OW_ACTION_LAUNCHER, p.c_str(), k.c_str(), nullptr};
+    if(controller::app::LauncherPool::persistent()){
+        argv.insert(argv.end()-1, "--persistent");
+    }
     pid_t pid = fork();
     switch(pid)
     {
@@ -179,6 +194,141 @@ static bool fork_exec(std::array<int, 2>& pipe_, pid_t& pid_, std::shared_ptr<co
     return true;
 }
 
+static bool spawn_exec(std::array<int, 2>& pipe_, pid_t& pid_, std::shared_ptr<controller::app::Relation> relation, std::map<std::string, std::string>& env) {
+    // posix_spawn does not copy the address space of the controller (glibc uses CLONE_VM|CLONE_VFORK), and it
+    // only returns after the process group has been set, so no eventfd synchronization is necessary.
+    int downstream[2] = {};
+    int upstream[2] = {};
+    if (pipe(downstream) == -1){
+        std::cerr << "thread-controls.cpp:195:pipe(downstream) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "what?";
+    }
+    if (pipe(upstream) == -1){
+        std::cerr << "thread-controls.cpp:199:pipe(upstream) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "what?";
+    }
+    const char* __OW_ACTION_BIN = getenv("__OW_ACTION_BIN");
+    if ( __OW_ACTION_BIN == nullptr ){
+        std::cerr << "__OW_ACTION_BIN envvar is not set." << std::endl;
+        throw "__OW_ACTION_BIN environment variable not set.";
+    }
+    const char* __OW_ACTION_LAUNCHER = getenv("__OW_ACTION_LAUNCHER");
+    if ( __OW_ACTION_LAUNCHER == nullptr ){
+        std::cerr << "__OW_ACTION_LAUNCHER envvar is not set." << std::endl;
+        throw "__OW_ACTION_LAUNCHER environment varible not set.";
+    }
+    std::string p = relation->path().stem().string();
+    std::string k = relation->key();
+    std::vector<const char*> argv{__OW_ACTION_BIN, __OW_ACTION_LAUNCHER, p.c_str(), k.c_str(), nullptr};
+    if(controller::app::LauncherPool::persistent()){
+        argv.insert(argv.end()-1, "--persistent");
+    }
+    // The exported environment is the controller environment, overridden by the relation environment.
+    std::vector<std::string> envs;
+    for(char** e = environ; *e != nullptr; ++e){
+        std::string_view entry(*e);
+        if(env.find(std::string(entry.substr(0, entry.find('=')))) == env.end()){
+            envs.emplace_back(entry);
+        }
+    }
+    for(auto& pair: env){
+        envs.emplace_back(pair.first + "=" + pair.second);
+    }
+    std::vector<char*> envp;
+    for(auto& e: envs){
+        envp.push_back(e.data());
+    }
+    envp.push_back(nullptr);
+
+    // The executor must not inherit the SIGTERM mask from the controller.
+    sigset_t sigmask = {};
+    if(pthread_sigmask(SIG_SETMASK, nullptr, &sigmask) != 0 || sigdelset(&sigmask, SIGTERM) == -1){
+        std::cerr << "thread-controls.cpp:238:building the executor signal mask failed." << std::endl;
+        throw "what?";
+    }
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t file_actions;
+    int status = posix_spawnattr_init(&attr);
+    if(status == 0){
+        status = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+    }
+    if(status == 0){
+        status = posix_spawnattr_setpgroup(&attr, 0);
+    }
+    if(status == 0){
+        status = posix_spawnattr_setsigmask(&attr, &sigmask);
+    }
+    if(status == 0){
+        status = posix_spawn_file_actions_init(&file_actions);
+    }
+    if(status == 0){
+        status = posix_spawn_file_actions_addclose(&file_actions, downstream[1]);
+    }
+    if(status == 0){
+        status = posix_spawn_file_actions_addclose(&file_actions, upstream[0]);
+    }
+    if(status == 0){
+        status = posix_spawn_file_actions_adddup2(&file_actions, downstream[0], STDIN_FILENO);
+    }
+    if(status == 0){
+        status = posix_spawn_file_actions_adddup2(&file_actions, upstream[1], 3);
+    }
+    if(status == 0 && upstream[1] != 3){
+        status = posix_spawn_file_actions_addclose(&file_actions, upstream[1]);
+    }
+    if(status != 0){
+        std::cerr << "thread-controls.cpp:272:posix_spawn attributes failed:" << std::make_error_code(std::errc(status)).message() << std::endl;
+        throw "what?";
+    }
+    pid_t pid = 0;
+    status = posix_spawn(&pid, __OW_ACTION_BIN, &file_actions, &attr, const_cast<char* const*>(argv.data()), envp.data());
+    posix_spawn_file_actions_destroy(&file_actions);
+    posix_spawnattr_destroy(&attr);
+    if(status != 0){
+        std::cerr << "thread-controls.cpp:280:posix_spawn failed:" << std::make_error_code(std::errc(status)).message() << std::endl;
+        throw "This shouldn't happen.";
+    }
+    pid_ = pid;
+    if(close(downstream[0]) == -1){
+        std::cerr << "thread-controls.cpp:285:close(downstream[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "this shouldn't happen.";
+    }
+    if (close(upstream[1]) == -1){
+        std::cerr << "thread-controls.cpp:289:close(upstream[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "this shouldn't happen.";
+    }
+    pipe_[0] = upstream[0];
+    pipe_[1] = downstream[1];
+    return true;
+}
+
+static bool spawn_launcher(std::array<int, 2>& pipe_, pid_t& pid_, std::shared_ptr<controller::app::Relation> relation, std::map<std::string, std::string>& env) {
+    // The spawn backend is selected once at startup with __OW_SPAWN_BACKEND=fork|posix_spawn.
+    static const bool use_posix_spawn = [](){
+        const char* __OW_SPAWN_BACKEND = getenv("__OW_SPAWN_BACKEND");
+        if(__OW_SPAWN_BACKEND == nullptr || std::string_view(__OW_SPAWN_BACKEND) == "fork"){
+            return false;
+        } else if (std::string_view(__OW_SPAWN_BACKEND) == "posix_spawn"){
+            return true;
+        }
+        std::cerr << "thread-controls.cpp:306:unknown __OW_SPAWN_BACKEND=" << __OW_SPAWN_BACKEND << ", using fork." << std::endl;
+        return false;
+    }();
+    #ifdef OW_PROFILE
+    const auto start = std::chrono::steady_clock::now();
+    #endif
+    bool spawned = (use_posix_spawn) ? spawn_exec(pipe_, pid_, relation, env) : fork_exec(pipe_, pid_, relation, env);
+    if(spawned){
+        controller::app::ProcessReaper::track(pid_);
+        controller::app::ExecutorCgroup::attach(pid_);
+    }
+    #ifdef OW_PROFILE
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "thread-controls.cpp:315:backend=" << ((use_posix_spawn) ? "posix_spawn" : "fork") << ":spawn duration=" << duration.count() << "us" << std::endl;
+    #endif
+    return spawned;
+}
+
 static bool wait_for_launcher(std::array<int, 2>& pipe){
     char ready[1] = {};
     int len = 0;
@@ -204,6 +354,9 @@ static bool wait_for_launcher(std::array<int, 2>& pipe){
 }
 
 static bool subprocess_pause(pid_t pid){
+    if(controller::app::ExecutorCgroup::freeze(pid, true)){
+        return true;
+    }
     if(kill(-pid, SIGSTOP) == -1){
         switch(errno)
         {
@@ -218,6 +371,9 @@ static bool subprocess_pause(pid_t pid){
 }
 
 static bool subprocess_continue(pid_t pid){
+    if(controller::app::ExecutorCgroup::freeze(pid, false)){
+        return true;
+    }
     if (kill(-pid, SIGCONT) == -1){
         switch(errno)
         {
@@ -231,43 +387,160 @@ static bool subprocess_continue(pid_t pid){
     return true;
 }
 
-static bool write_params_to_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe, std::string params){
-    int len = 0;
-    std::size_t bytes_written = 0;
+static void writev_to_subprocess(int fd, std::vector<struct iovec>& iov, std::string& pending){
+    // Writes are retried until every buffer has been written, at most IOV_MAX buffers at a time.
+    // If the fd is non-blocking and the pipe is full, the rest is copied into pending, and written once the fd is writable.
+    std::size_t pos = 0;
+    while(pos < iov.size()){
+        int iovcnt = static_cast<int>(std::min<std::size_t>(iov.size() - pos, IOV_MAX));
+        ssize_t len = writev(fd, iov.data() + pos, iovcnt);
+        if(len == -1){
+            switch(errno)
+            {
+                case EINTR:
+                    continue;
+                case EAGAIN:
+                    for(; pos < iov.size(); ++pos){
+                        pending.append(static_cast<const char*>(iov[pos].iov_base), iov[pos].iov_len);
+                    }
+                    return;
+                default:
+                    std::cerr << "thread-controls.cpp:401:writev() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+        std::size_t written = len;
+        while(pos < iov.size() && written >= iov[pos].iov_len){
+            written -= iov[pos++].iov_len;
+        }
+        if(written > 0){
+            iov[pos].iov_base = static_cast<char*>(iov[pos].iov_base) + written;
+            iov[pos].iov_len -= written;
+        }
+    }
+    return;
+}
+
+static bool write_params_to_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe, std::string params, int result_memfd, const std::map<std::string, std::string>& env, std::string& pending){
+    static constexpr char OPEN[] = "{";
+    static constexpr char COLON[] = ":";
+    static constexpr char COMMA[] = ",";
+    static constexpr char CLOSE[] = "}";
+    static constexpr char NEWLINE[] = "\n";
+    static constexpr char SHARED_RESULT[] = "{\"__OW_RESULT\":";
+    static constexpr char SHARED_PARAMS[] = ",\"__OW_PARAMS\":";
+    static constexpr char SHARED_MEMFD[] = ",\"__OW_MEMFD\":{";
+    static constexpr char FRAME_ENV[] = "{\"__OW_ENV\":";
+    static constexpr char FRAME_INPUT[] = ",\"__OW_INPUT\":";
+    auto fragment = [](const char* data, std::size_t size){
+        return iovec{const_cast<char*>(data), size};
+    };
+    // The parameters are gathered from buffers that are already serialized, so no intermediate
+    // JSON object or concatenated string is built. Published dependency results are immutable
+    // and live as long as the relation, so they can be referenced directly.
+    std::vector<struct iovec> iov;
+    std::vector<std::string> keys;
+    // Dependencies whose results are held in memfds are named in the frame instead of being copied into it.
+    std::vector<std::pair<std::size_t, std::string> > memfds;
+    std::string result_path;
+    std::string frame_env;
+    char header[4] = {};
+    if(controller::app::LauncherPool::persistent()){
+        // Persistent launchers outlive the activation that spawned them, so every frame carries the environment of
+        // its own activation.
+        boost::json::object jenv;
+        for(auto& kvp: env){
+            jenv.emplace(kvp.first, kvp.second);
+        }
+        frame_env = boost::json::serialize(jenv);
+        iov.push_back(fragment(header, sizeof(header)));
+        iov.push_back(fragment(FRAME_ENV, sizeof(FRAME_ENV) - 1));
+        iov.push_back(fragment(frame_env.data(), frame_env.size()));
+        iov.push_back(fragment(FRAME_INPUT, sizeof(FRAME_INPUT) - 1));
+    }
+    if(result_memfd != -1){
+        result_path = boost::json::serialize(boost::json::value(controller::app::SharedResults::path(result_memfd)));
+        iov.push_back(fragment(SHARED_RESULT, sizeof(SHARED_RESULT) - 1));
+        iov.push_back(fragment(result_path.data(), result_path.size()));
+        iov.push_back(fragment(SHARED_PARAMS, sizeof(SHARED_PARAMS) - 1));
+    }
     if(relation->size() == 0){
         // continue to use params if the relation has no dependencies.
-        params.append("\n");
+        iov.push_back(fragment(params.data(), params.size()));
     } else {
         // Override params with emplaced parameters.
-        boost::json::object jv;
+        keys.reserve(relation->size());
+        memfds.reserve(relation->size());
+        iov.reserve(iov.size() + 8*relation->size() + 4);
+        iov.push_back(fragment(OPEN, sizeof(OPEN) - 1));
         for (auto& dep: *relation){
-            std::string value = dep->acquire_value();
-            dep->release_value();
-            if(value.empty() || value == "null"){
+            const controller::app::RelationResult* result = dep->result();
+            if(result == nullptr || result->value.is_null()){
                 return false;
             }
-            jv.emplace(dep->key(), boost::json::parse(value));
+            keys.push_back(boost::json::serialize(boost::json::value(dep->key())));
+            if(result_memfd != -1 && result->memfd != -1){
+                memfds.emplace_back(keys.size() - 1, boost::json::serialize(boost::json::value(controller::app::SharedResults::path(result->memfd))));
+                continue;
+            }
+            if(iov.back().iov_base != OPEN){
+                iov.push_back(fragment(COMMA, sizeof(COMMA) - 1));
+            }
+            iov.push_back(fragment(keys.back().data(), keys.back().size()));
+            iov.push_back(fragment(COLON, sizeof(COLON) - 1));
+            iov.push_back(fragment(result->serialized.data(), result->serialized.size()));
         }
-        params = boost::json::serialize(jv);
-        params.append("\n");
+        iov.push_back(fragment(CLOSE, sizeof(CLOSE) - 1));
     }
-    do{
-        len = write(pipe[1], params.data() + bytes_written, params.size() - bytes_written);
-        if(len <= 0){
-            switch(errno)
-            {
-                case 0:
-                    break;
-                case EINTR:
-                    break;
-                default:
-                    std::cerr << "thread-controls.cpp:144:write() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
-                    throw "what?";
+    if(result_memfd != -1){
+        iov.push_back(fragment(SHARED_MEMFD, sizeof(SHARED_MEMFD) - 1));
+        for(std::size_t i = 0; i < memfds.size(); ++i){
+            if(i > 0){
+                iov.push_back(fragment(COMMA, sizeof(COMMA) - 1));
             }
-        } else {
-           bytes_written += len; 
+            iov.push_back(fragment(keys[memfds[i].first].data(), keys[memfds[i].first].size()));
+            iov.push_back(fragment(COLON, sizeof(COLON) - 1));
+            iov.push_back(fragment(memfds[i].second.data(), memfds[i].second.size()));
+        }
+        iov.push_back(fragment(CLOSE, sizeof(CLOSE) - 1));
+        iov.push_back(fragment(CLOSE, sizeof(CLOSE) - 1));
+    }
+    if(controller::app::LauncherPool::persistent()){
+        iov.push_back(fragment(CLOSE, sizeof(CLOSE) - 1));
+    }
+    iov.push_back(fragment(NEWLINE, sizeof(NEWLINE) - 1));
+    if(controller::app::LauncherPool::persistent()){
+        // Persistent launchers read parameters as frames with a 4 byte big endian length prefix.
+        std::size_t length = 0;
+        for(std::size_t i = 1; i < iov.size(); ++i){
+            length += iov[i].iov_len;
         }
-    }while(bytes_written < params.size());
+        header[0] = static_cast<char>((length >> 24) & 0xFF);
+        header[1] = static_cast<char>((length >> 16) & 0xFF);
+        header[2] = static_cast<char>((length >> 8) & 0xFF);
+        header[3] = static_cast<char>(length & 0xFF);
+    }
+    writev_to_subprocess(pipe[1], iov, pending);
+    return true;
+}
+
+static bool write_stream_to_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe, const controller::app::ResultStream& stream, std::string& pending){
+    static constexpr char CLOSE[] = "}\n";
+    // The forwarded bytes are only valid parameters if the dependency stored them as its result. Otherwise the
+    // relation fails like it does when write_params_to_subprocess() finds no result.
+    const controller::app::RelationResult* result = (*relation)[0]->result();
+    if(result == nullptr || result->value.is_null() || result->serialized.size() < stream.forwarded){
+        return false;
+    }
+    if(stream.complete){
+        return (result->serialized.size() == stream.forwarded);
+    }
+    // Write the part of the dependency result that could not be forwarded, and close the parameters object.
+    std::vector<struct iovec> iov = {
+        {const_cast<char*>(result->serialized.data()) + stream.forwarded, result->serialized.size() - stream.forwarded},
+        {const_cast<char*>(CLOSE), sizeof(CLOSE) - 1}
+    };
+    writev_to_subprocess(pipe[1], iov, pending);
     return true;
 }
 
@@ -304,10 +577,190 @@ static bool wait_for_result_from_subprocess(std::array<int, 2>& pipe, std::uniqu
     return true;
 }
 
-static bool read_result_from_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe){
+static void store_result(std::shared_ptr<controller::app::Relation>& relation, std::string& val, int& result_memfd){
+    if(result_memfd != -1){
+        // The launcher wrote its result into the memfd, and only the length of the result into the pipe.
+        std::string length(std::move(val));
+        val.clear();
+        if(!length.empty() && controller::app::SharedResults::load(result_memfd, length, val) && !val.empty() && val != "null"){
+            relation->acquire_value() = val;
+            relation->release_value(result_memfd);
+            result_memfd = -1;
+        }
+        controller::app::SharedResults::close(result_memfd);
+        return;
+    }
+    if(!val.empty() && val != "null"){
+        relation->acquire_value() = val;
+        relation->release_value();
+    }
+    return;
+}
+
+static bool read_exactly(int fd, char* buf, std::size_t n){
+    std::size_t bytes_read = 0;
+    int len = 0;
+    while(bytes_read < n){
+        len = read(fd, buf + bytes_read, n - bytes_read);
+        if(len < 0){
+            switch(errno)
+            {
+                case EINTR:
+                    break;
+                default:
+                    std::cerr << "thread-controls.cpp:366:read(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        } else if(len == 0){
+            return false;
+        } else {
+            bytes_read += len;
+        }
+    }
+    return true;
+}
+
+static void close_stream(controller::app::ResultStream& stream){
+    if(stream.fd != -1 && close(stream.fd) == -1){
+        std::cerr << "thread-controls.cpp:602:close(stream.fd) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "what?";
+    }
+    stream.fd = -1;
+    return;
+}
+
+static controller::app::ResultStream::State forward_result_to_subprocess(const std::shared_ptr<controller::app::Relation>& relation, int fd, controller::app::ResultStream& stream, std::string& val){
+    // The dependent is paused until it is scheduled, so the result is only forwarded while its pipe has room.
+    // Whatever is left is read into the controller copy, and written by the dependent once it has been scheduled.
+    std::string prefix("{");
+    prefix.append(boost::json::serialize(boost::json::value(relation->key())));
+    prefix.append(":");
+    // The downstream pipe of a ready launcher is empty, and the prefix is smaller than PIPE_BUF.
+    if(write(stream.fd, prefix.data(), prefix.size()) != static_cast<ssize_t>(prefix.size())){
+        // Nothing was forwarded, so the dependent writes its parameters as usual.
+        return controller::app::ResultStream::State::WITHDRAWN;
+    }
+    std::array<struct pollfd, 2> pfds = {{
+        {fd, POLLIN, 0},
+        {stream.fd, POLLOUT, 0}
+    }};
+    while(true){
+        ssize_t len = tee(fd, stream.fd, INT_MAX, SPLICE_F_NONBLOCK);
+        if(len > 0){
+            // Consume the bytes that were just duplicated into the downstream pipe.
+            std::size_t offset = val.size();
+            val.resize(offset + len);
+            if(!read_exactly(fd, val.data() + offset, len)){
+                val.resize(offset);
+                return controller::app::ResultStream::State::CLAIMED;
+            }
+            stream.forwarded += len;
+        } else if(len == 0){
+            // The launcher has closed its end of the pipe, so the forwarded parameters are complete.
+            if(poll(&pfds[1], 1, 0) == 1 && (pfds[1].revents & POLLOUT)){
+                stream.complete = (write(stream.fd, "}\n", 2) == 2);
+            }
+            return controller::app::ResultStream::State::CLAIMED;
+        } else {
+            switch(errno)
+            {
+                case EINTR:
+                    break;
+                case EAGAIN:
+                    // Either the result pipe is empty, or the downstream pipe is full.
+                    if(poll(&pfds[1], 1, 0) == 0){
+                        return controller::app::ResultStream::State::CLAIMED;
+                    }
+                    while(poll(&pfds[0], 1, -1) == -1){
+                        if(errno != EINTR){
+                            std::cerr << "thread-controls.cpp:654:poll() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                            throw "what?";
+                        }
+                    }
+                    break;
+                default:
+                    // The dependent has gone away, read the rest of the result normally.
+                    return controller::app::ResultStream::State::CLAIMED;
+            }
+        }
+    }
+}
+
+static void publish_records(std::shared_ptr<controller::app::Relation>& relation, std::string& val, std::size_t& published, bool eof){
+    // Records are published one complete line at a time, and the final line doesn't need a trailing newline.
+    std::size_t end = (eof) ? val.size() : val.rfind('\n');
+    if(end == std::string::npos || end + ((eof) ? 0 : 1) <= published){
+        return;
+    }
+    if(!eof){
+        ++end;
+    }
+    relation->append_records(std::string_view(val).substr(published, end - published));
+    published = end;
+    if(eof){
+        if(!val.empty() && val.back() != '\n'){
+            relation->append_records("\n");
+        }
+        relation->close_records();
+    }
+    return;
+}
+
+static std::string records_to_array(const std::string& records){
+    // The value of a streaming relation is the JSON array of its records.
+    std::string array("[");
+    std::size_t start = 0;
+    while(start < records.size()){
+        std::size_t end = records.find('\n', start);
+        if(end == std::string::npos){
+            end = records.size();
+        }
+        if(end > start){
+            if(array.size() > 1){
+                array.append(",");
+            }
+            array.append(records, start, end - start);
+        }
+        start = end + 1;
+    }
+    array.append("]");
+    return array;
+}
+
+static bool read_result_from_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe, int& result_memfd, std::shared_ptr<controller::app::ResultStream> stream, bool records){
     std::array<char, MAX_LENGTH> buf;
     std::string val;
     int len = 0;
+    // The state that the stream settles in once the result has been read, if it is forwarded.
+    controller::app::ResultStream::State settled = controller::app::ResultStream::State::CLAIMED;
+    bool forwarding = false;
+    if(stream){
+        std::unique_lock<std::mutex> lk(stream->mtx);
+        forwarding = (stream->state == controller::app::ResultStream::State::OFFERED);
+        if(!forwarding){
+            stream.reset();
+        } else {
+            stream->state = controller::app::ResultStream::State::FORWARDING;
+        }
+    }
+    auto settle = [&](){
+        std::unique_lock<std::mutex> lk(stream->mtx);
+        stream->state = settled;
+        close_stream(*stream);
+        lk.unlock();
+        stream->cv.notify_all();
+    };
+    if(forwarding){
+        // The mutex is not held while the producer blocks on its own pipe.
+        try{
+            settled = forward_result_to_subprocess(relation, pipe[0], *stream, val);
+        } catch(...){
+            settled = controller::app::ResultStream::State::WITHDRAWN;
+            settle();
+            throw;
+        }
+    }
+    std::size_t published = 0;
     do{
         len = read(pipe[0], buf.data(), MAX_LENGTH);
         if(len < 0){
@@ -317,25 +770,53 @@ static bool read_result_from_subprocess(std::shared_ptr<controller::app::Relatio
                     break;
                 default:
                     std::cerr << "thread-controls.cpp:302:read(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    if(stream){
+                        settle();
+                    }
                     throw "what?";
             }
         } else if(len == 0){
             break;
         } else {
             val.append(buf.data(), len);
+            if(records){
+                publish_records(relation, val, published, false);
+            }
         }
     }while(true);
-    if(!val.empty()){
-        if(val == "null"){
-            return true;
-        }
-        relation->acquire_value() = val;
-        relation->release_value();
+    if(records){
+        publish_records(relation, val, published, true);
+        val = records_to_array(val);
+    }
+    store_result(relation, val, result_memfd);
+    if(stream){
+        settle();
     }
     return true;
 }
 
+static bool read_framed_result_from_subprocess(std::shared_ptr<controller::app::Relation> relation, std::array<int, 2>& pipe, bool& reusable, int& result_memfd){
+    // Persistent launchers write each result as a frame with a 4 byte big endian length prefix, and keep running afterwards.
+    unsigned char header[4] = {};
+    reusable = false;
+    if(!read_exactly(pipe[0], reinterpret_cast<char*>(header), sizeof(header))){
+        // The launcher exited without writing a result.
+        return true;
+    }
+    std::size_t length = (static_cast<std::size_t>(header[0]) << 24) | (static_cast<std::size_t>(header[1]) << 16) | (static_cast<std::size_t>(header[2]) << 8) | header[3];
+    std::string val(length, '\0');
+    if(!read_exactly(pipe[0], val.data(), length)){
+        std::cerr << "thread-controls.cpp:389:read(pipe[0]) encountered eof in the middle of a result frame." << std::endl;
+        return true;
+    }
+    reusable = true;
+    store_result(relation, val, result_memfd);
+    return true;
+}
+
 static void kill_subprocesses(pid_t pid){
+    // Frozen executors can't handle SIGTERM until their cgroup is thawed.
+    controller::app::ExecutorCgroup::freeze(pid, false);
     if(kill(-pid, SIGTERM) == -1){
         switch(errno)
         {
@@ -354,7 +835,8 @@ static void kill_subprocesses(pid_t pid){
                 std::cerr << "thread-controls.cpp:204:kill() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
                 throw "what?";
         }
-    } else {
+    } else if(!controller::app::ProcessReaper::escalate(pid)){
+        // Without an io_context to run the escalation timer on, block for the grace period instead.
         struct timespec ts[2] = {};
         ts[0] = {0, 20000000}; // 20ms
         while(nanosleep(&ts[0], &ts[1]) < 0){
@@ -368,6 +850,7 @@ static void kill_subprocesses(pid_t pid){
                     throw "what?";
             }
         }
+        controller::app::ExecutorCgroup::kill(pid);
         if(kill(-pid, SIGKILL) == -1){
             switch(errno)
             {
@@ -387,58 +870,540 @@ static void close_pipe(std::array<int, 2>& pipe){
         std::cerr << "thread-controls.cpp:213:close(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
         throw "what?";
     }
-    if(close(pipe[1]) == -1){
+    // The downstream pipe of a streaming relation is closed as soon as its input is complete.
+    if(pipe[1] != -1 && close(pipe[1]) == -1){
         std::cerr << "thread-controls.cpp:217:close(pipe[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
         throw "what?";
     }
     return;
 }
 
+static std::string launcher_key(const std::shared_ptr<controller::app::Relation>& relation){
+    std::string key(relation->path().stem().string());
+    key.append(":");
+    key.append(relation->key());
+    return key;
+}
+
 namespace controller{
 namespace app{
+    /* Launcher Pool Static Members */
+    std::mutex LauncherPool::mtx_;
+    std::condition_variable LauncherPool::cv_;
+    bool LauncherPool::started_ = false;
+    std::size_t LauncherPool::generation_ = 0;
+    std::size_t LauncherPool::depth_ = 1;
+    std::map<std::string, std::shared_ptr<Relation> > LauncherPool::relations_;
+    std::map<std::string, std::size_t> LauncherPool::depths_;
+    std::map<std::string, std::deque<LauncherHandle> > LauncherPool::launchers_;
+    std::atomic<std::size_t> LauncherPool::hits_{0};
+    std::atomic<std::size_t> LauncherPool::misses_{0};
+
+    bool LauncherPool::enabled()
+    {
+        static const bool enabled = [](){
+            if(getenv("__OW_LAUNCHER_POOL") == nullptr){
+                return false;
+            }
+            // Pooled launchers are spawned before the activation that claims them, so they can only receive its
+            // environment in the frames that persistent launchers read.
+            if(!LauncherPool::persistent()){
+                std::cerr << "thread-controls.cpp:888:__OW_LAUNCHER_POOL requires __OW_PERSISTENT_LAUNCHER to be set." << std::endl;
+                throw "what?";
+            }
+            return true;
+        }();
+        return enabled;
+    }
+
+    void LauncherPool::prime(const std::vector<std::shared_ptr<Relation> >& relations, std::size_t concurrency)
+    {
+        if(!LauncherPool::enabled() && !LauncherPool::persistent()){
+            return;
+        }
+        std::size_t depth = (concurrency > 0) ? concurrency : 1;
+        const char* __OW_LAUNCHER_POOL_DEPTH = getenv("__OW_LAUNCHER_POOL_DEPTH");
+        if(__OW_LAUNCHER_POOL_DEPTH != nullptr){
+            std::string_view depth_str(__OW_LAUNCHER_POOL_DEPTH);
+            std::from_chars_result fcres = std::from_chars(depth_str.data(), depth_str.data()+depth_str.size(), depth, 10);
+            if(fcres.ec != std::errc()){
+                std::cerr << "thread-controls.cpp:436:__OW_LAUNCHER_POOL_DEPTH is not an integer:" << std::make_error_code(fcres.ec).message() << std::endl;
+                throw "what?";
+            }
+        }
+        std::unique_lock<std::mutex> lk(LauncherPool::mtx_);
+        // Persistent executors that are released back into the pool are kept to the same depth.
+        LauncherPool::depth_ = depth;
+        if(!LauncherPool::enabled()){
+            return;
+        }
+        for(auto& relation: relations){
+            std::string key = launcher_key(relation);
+            if(LauncherPool::relations_.find(key) == LauncherPool::relations_.end()){
+                // The pool keeps its own copy of the relation so that it doesn't hold on to execution context state.
+                LauncherPool::relations_.emplace(key, std::make_shared<Relation>(relation->key(), relation->path(), std::vector<std::shared_ptr<Relation> >()));
+                LauncherPool::depths_.emplace(key, depth);
+            }
+        }
+        if(!LauncherPool::started_){
+            try{
+                std::thread refiller(&LauncherPool::refill);
+                refiller.detach();
+            } catch(std::system_error& e){
+                std::cerr << "thread-controls.cpp:454:launcher pool refill thread failed to start with error:" << e.what() << std::endl;
+                throw e;
+            }
+            LauncherPool::started_ = true;
+        }
+        lk.unlock();
+        LauncherPool::cv_.notify_one();
+        return;
+    }
+
+    bool LauncherPool::persistent()
+    {
+        static const bool persistent = (getenv("__OW_PERSISTENT_LAUNCHER") != nullptr);
+        return persistent;
+    }
+
+    void LauncherPool::release(const std::shared_ptr<Relation>& relation, pid_t pid, const std::array<int, 2>& pipe)
+    {
+        std::unique_lock<std::mutex> lk(LauncherPool::mtx_);
+        auto& launchers = LauncherPool::launchers_[launcher_key(relation)];
+        if(launchers.size() < LauncherPool::depth_){
+            launchers.push_back({pid, pipe});
+            return;
+        }
+        lk.unlock();
+        // The pool is already full, so the executor is terminated instead.
+        std::array<int, 2> excess(pipe);
+        kill_subprocesses(pid);
+        close_pipe(excess);
+        return;
+    }
+
+    bool LauncherPool::claim(const std::shared_ptr<Relation>& relation, pid_t& pid, std::array<int, 2>& pipe)
+    {
+        if(!LauncherPool::enabled() && !LauncherPool::persistent()){
+            return false;
+        }
+        std::unique_lock<std::mutex> lk(LauncherPool::mtx_);
+        auto it = LauncherPool::launchers_.find(launcher_key(relation));
+        if(it == LauncherPool::launchers_.end() || it->second.empty()){
+            lk.unlock();
+            LauncherPool::misses_.fetch_add(1, std::memory_order::memory_order_relaxed);
+            return false;
+        }
+        LauncherHandle handle = it->second.front();
+        it->second.pop_front();
+        lk.unlock();
+        LauncherPool::cv_.notify_one();
+        pid = handle.pid;
+        pipe = handle.pipe;
+        LauncherPool::hits_.fetch_add(1, std::memory_order::memory_order_relaxed);
+        return true;
+    }
+
+    void LauncherPool::clear()
+    {
+        std::unique_lock<std::mutex> lk(LauncherPool::mtx_);
+        ++LauncherPool::generation_;
+        std::map<std::string, std::deque<LauncherHandle> > launchers;
+        launchers.swap(LauncherPool::launchers_);
+        LauncherPool::relations_.clear();
+        LauncherPool::depths_.clear();
+        lk.unlock();
+        for(auto& kvp: launchers){
+            for(auto& handle: kvp.second){
+                kill_subprocesses(handle.pid);
+                close_pipe(handle.pipe);
+            }
+        }
+        return;
+    }
+
+    void LauncherPool::refill()
+    {
+        std::unique_lock<std::mutex> lk(LauncherPool::mtx_);
+        while(true){
+            std::map<std::string, std::size_t>::iterator it;
+            LauncherPool::cv_.wait(lk, [&](){
+                it = std::find_if(LauncherPool::depths_.begin(), LauncherPool::depths_.end(), [&](auto& kvp){
+                    return (LauncherPool::launchers_[kvp.first].size() < kvp.second);
+                });
+                return (it != LauncherPool::depths_.end());
+            });
+            std::string key(it->first);
+            std::shared_ptr<Relation> relation = LauncherPool::relations_[key];
+            std::size_t generation = LauncherPool::generation_;
+            lk.unlock();
+            // Pooled launchers only inherit the controller environment, the activation environment is sent in every frame.
+            std::map<std::string, std::string> env;
+            LauncherHandle handle = {};
+            bool started = false;
+            try{
+                started = spawn_launcher(handle.pipe, handle.pid, relation, env) && wait_for_launcher(handle.pipe);
+            } catch(const char* e){
+                std::cerr << "thread-controls.cpp:526:launcher " << key << " failed to start:" << e << std::endl;
+                if(handle.pid > 0){
+                    kill_subprocesses(handle.pid);
+                    close_pipe(handle.pipe);
+                }
+            }
+            lk.lock();
+            if(!started){
+                // Stop refilling launchers that fail to start.
+                LauncherPool::depths_[key] = 0;
+            } else if(generation != LauncherPool::generation_){
+                // The pool was cleared while the launcher was starting.
+                lk.unlock();
+                kill_subprocesses(handle.pid);
+                close_pipe(handle.pipe);
+                lk.lock();
+            } else {
+                LauncherPool::launchers_[key].push_back(handle);
+            }
+        }
+    }
+    // End of Launcher Pool Static Members
+
     /* Class Static Members */
-    std::chrono::time_point<std::chrono::steady_clock> ThreadControls::start_timer_;
+    std::atomic<std::chrono::steady_clock::rep> ThreadControls::start_timer_{0};
+    std::atomic<std::size_t> ThreadControls::sched_size_{0};
     std::mutex ThreadControls::sched_mtx_;
     std::deque<std::shared_ptr<ThreadSchedHandle> > ThreadControls::sched_handles_;
+    std::atomic<std::int64_t> ThreadControls::relation_time_ns_{0};
+    std::atomic<std::size_t> ThreadControls::deadline_misses_{0};
+    std::atomic<std::size_t> ThreadControls::deadline_hits_{0};
+    std::mutex ThreadControls::streams_mtx_;
+    std::map<const Relation*, std::shared_ptr<ResultStream> > ThreadControls::streams_;
+
     void ThreadControls::set_start_time()
     {
-        std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
-        ThreadControls::start_timer_ = std::chrono::steady_clock::now();
+        ThreadControls::start_timer_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order::memory_order_relaxed);
     }
 
     std::chrono::time_point<std::chrono::steady_clock> ThreadControls::get_start_time()
     {
-        std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
-        return ThreadControls::start_timer_;
+        return std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::duration(ThreadControls::start_timer_.load(std::memory_order::memory_order_relaxed)));
+    }
+
+    std::chrono::time_point<std::chrono::steady_clock> ThreadControls::get_start_time(const std::shared_ptr<ThreadSchedHandle>& current)
+    {
+        // Round robin time slices are handed from thread to thread, so they all share the same start time.
+        if(!current || ThreadControls::sched_policy() == SchedPolicy::ROUND_ROBIN){
+            return ThreadControls::get_start_time();
+        }
+        return std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::duration(current->start.load(std::memory_order::memory_order_relaxed)));
     }
 
     std::chrono::milliseconds ThreadControls::thread_sched_time_slice()
     {
-        std::unique_lock<std::mutex> lk (ThreadControls::sched_mtx_);
-        if(ThreadControls::sched_handles_.empty()){
+        std::size_t size = ThreadControls::sched_size_.load(std::memory_order::memory_order_relaxed);
+        if(size == 0){
             std::cerr << "thread-controls.cpp:367:Timeslices shouldn't be requested when there are no thread handles to schedule." << std::endl;
             throw "what?";
         } else {
-            return ThreadControls::THREAD_SCHED_TIME_SLICE_MS/ThreadControls::sched_handles_.size();
+            return ThreadControls::THREAD_SCHED_TIME_SLICE_MS/size;
         }
     }
 
-    std::shared_ptr<ThreadSchedHandle> ThreadControls::thread_sched_push()
+    std::shared_ptr<ThreadSchedHandle> ThreadControls::thread_sched_push(std::chrono::time_point<std::chrono::steady_clock> deadline)
     {
-        std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
         std::shared_ptr<ThreadSchedHandle> handle = std::make_shared<ThreadSchedHandle>();
+        handle->deadline = deadline;
+        handle->start.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order::memory_order_relaxed);
+        std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
         sched_handles_.push_front(handle);
+        lk.unlock();
+        ThreadControls::sched_size_.fetch_add(1, std::memory_order::memory_order_relaxed);
         return handle;
     }
 
-    void ThreadControls::thread_sched_yield(bool finished)
+    SchedPolicy ThreadControls::sched_policy()
+    {
+        static const SchedPolicy policy = [](){
+            const char* __OW_SCHED_POLICY = getenv("__OW_SCHED_POLICY");
+            if(__OW_SCHED_POLICY == nullptr){
+                return SchedPolicy::ROUND_ROBIN;
+            }
+            std::string_view name(__OW_SCHED_POLICY);
+            if(name == "edf"){
+                return SchedPolicy::EARLIEST_DEADLINE;
+            } else if(name == "llf"){
+                return SchedPolicy::LEAST_LAXITY;
+            } else if(name != "rr"){
+                std::cerr << "thread-controls.cpp:813:unknown scheduling policy " << name << ", falling back to round robin." << std::endl;
+            }
+            return SchedPolicy::ROUND_ROBIN;
+        }();
+        return policy;
+    }
+
+    bool ThreadControls::stream_results()
+    {
+        static const bool enabled = (getenv("__OW_SPLICE_RESULTS") != nullptr);
+        return enabled;
+    }
+
+    std::shared_ptr<ResultStream> ThreadControls::claim_stream(const std::shared_ptr<Relation>& relation)
+    {
+        if(!ThreadControls::stream_results()){
+            return nullptr;
+        }
+        std::unique_lock<std::mutex> lk(ThreadControls::streams_mtx_);
+        auto it = ThreadControls::streams_.find(relation.get());
+        if(it == ThreadControls::streams_.end()){
+            return nullptr;
+        }
+        std::shared_ptr<ResultStream> stream = std::move(it->second);
+        ThreadControls::streams_.erase(it);
+        return stream;
+    }
+
+    void ThreadControls::offer_stream()
     {
+        // Results are only streamed between launchers that are read by blocking executor threads, and that exchange
+        // unframed parameters through their pipes.
+        if(!ThreadControls::stream_results() || ExecutorReactor::enabled() || LauncherPool::persistent() || SharedResults::enabled()){
+            return;
+        }
+        if(relation->size() != 1 || (*relation)[0]->complete() || relation->stream() || (*relation)[0]->stream()){
+            return;
+        }
+        int fd = fcntl(pipe_[1], F_DUPFD_CLOEXEC, 0);
+        if(fd == -1){
+            std::cerr << "thread-controls.cpp:1066:fcntl(F_DUPFD_CLOEXEC) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        // A larger pipe lets more of the result be forwarded before the dependent is scheduled. It is not an error
+        // if the pipe can't be resized.
+        fcntl(fd, F_SETPIPE_SZ, ThreadControls::STREAM_PIPE_SIZE);
+        auto stream = std::make_shared<ResultStream>();
+        stream->fd = fd;
+        std::unique_lock<std::mutex> lk(ThreadControls::streams_mtx_);
+        if(ThreadControls::streams_.emplace((*relation)[0].get(), stream).second){
+            stream_ = std::move(stream);
+            return;
+        }
+        // Another dependent is already waiting for the result.
+        lk.unlock();
+        close_stream(*stream);
+        return;
+    }
+
+    void ThreadControls::withdraw_stream()
+    {
+        if(!stream_){
+            return;
+        }
+        std::unique_lock<std::mutex> lk(ThreadControls::streams_mtx_);
+        auto it = ThreadControls::streams_.find((*relation)[0].get());
+        if(it != ThreadControls::streams_.end() && it->second == stream_){
+            ThreadControls::streams_.erase(it);
+        }
+        lk.unlock();
+        // This waits until a result that is being forwarded has been read.
+        std::unique_lock<std::mutex> stream_lk(stream_->mtx);
+        if(stream_->state == ResultStream::State::OFFERED){
+            stream_->state = ResultStream::State::WITHDRAWN;
+            close_stream(*stream_);
+        }
+        stream_->cv.wait(stream_lk, [&](){ return stream_->state != ResultStream::State::FORWARDING; });
+        return;
+    }
+
+    bool ThreadControls::streams_records(const std::shared_ptr<Relation>& relation)
+    {
+        // Records are read by blocking executor threads, and are exchanged through unframed pipes.
+        return (relation->stream() && !ExecutorReactor::enabled() && !LauncherPool::persistent() && !SharedResults::enabled());
+    }
+
+    bool ThreadControls::forward_records()
+    {
+        // Forwards the records of the streaming dependency into the launcher, one parameters object per line.
+        // The downstream pipe is non-blocking, so a launcher that is paused or busy never stalls the executor thread.
+        if(pipe_[1] == -1){
+            return true;
+        }
+        auto& dependency = (*relation)[0];
+        if(!records_closed_){
+            std::string lines;
+            // Local producers close their records before they publish their result, so the result is loaded first.
+            const RelationResult* result = dependency->result();
+            records_closed_ = dependency->read_records(records_offset_, lines);
+            if(!records_closed_ && result != nullptr){
+                // The dependency was completed without streaming its records here, for instance by a peer.
+                records_closed_ = true;
+                if(records_offset_ == 0 && result->value.is_array()){
+                    for(auto& record: result->value.get_array()){
+                        lines.append(boost::json::serialize(record));
+                        lines.append("\n");
+                    }
+                }
+            }
+            std::string prefix("{");
+            prefix.append(boost::json::serialize(boost::json::value(dependency->key())));
+            prefix.append(":");
+            std::size_t start = 0;
+            while(start < lines.size()){
+                std::size_t end = lines.find('\n', start);
+                if(end == std::string::npos){
+                    end = lines.size();
+                }
+                if(end > start){
+                    records_out_.append(prefix);
+                    records_out_.append(lines, start, end - start);
+                    records_out_.append("}\n");
+                }
+                start = end + 1;
+            }
+        }
+        std::size_t bytes_written = 0;
+        while(bytes_written < records_out_.size()){
+            ssize_t len = write(pipe_[1], records_out_.data() + bytes_written, records_out_.size() - bytes_written);
+            if(len == -1){
+                if(errno == EINTR){
+                    continue;
+                } else if(errno == EAGAIN){
+                    break;
+                }
+                // The launcher has exited, its result is collected as usual.
+                records_out_.clear();
+                bytes_written = 0;
+                records_closed_ = true;
+                break;
+            }
+            bytes_written += len;
+        }
+        records_out_.erase(0, bytes_written);
+        if(records_closed_ && records_out_.empty()){
+            // Closing the pipe tells the launcher that there are no more records.
+            if(close(pipe_[1]) == -1){
+                std::cerr << "thread-controls.cpp:1242:close(pipe[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            pipe_[1] = -1;
+        }
+        return true;
+    }
+
+    void ThreadControls::unwatch_records()
+    {
+        if(records_efd_ == -1){
+            return;
+        }
+        (*relation)[0]->unwatch_records(records_efd_);
+        // stop_thread() only signals the eventfd while it holds the context mutex.
+        ctx_mtx_->lock();
+        int efd = records_efd_;
+        records_efd_ = -1;
+        ctx_mtx_->unlock();
+        if(close(efd) == -1){
+            std::cerr << "thread-controls.cpp:1303:close(records_efd) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        return;
+    }
+
+    std::chrono::time_point<std::chrono::steady_clock> ThreadControls::thread_sched_priority(const ThreadSchedHandle& handle, std::chrono::time_point<std::chrono::steady_clock> now)
+    {
+        // Contexts without a deadline are only scheduled when no context with a deadline is waiting.
+        if(handle.deadline == std::chrono::time_point<std::chrono::steady_clock>::max()){
+            return handle.deadline;
+        }
+        if(ThreadControls::sched_policy() == SchedPolicy::LEAST_LAXITY){
+            // The laxity is the slack left after the remaining levels of the critical path have been executed,
+            // offset by the current time so that all priorities are comparable as time points.
+            auto work = ThreadControls::relation_time() * handle.remaining.load(std::memory_order::memory_order_relaxed);
+            return now + ((handle.deadline - now) - work);
+        }
+        return handle.deadline;
+    }
+
+    void ThreadControls::relation_time_sample(std::chrono::nanoseconds sample)
+    {
+        // Exponentially weighted moving average of the relation execution time, with a weight of 1/8.
+        std::int64_t average = ThreadControls::relation_time_ns_.load(std::memory_order::memory_order_relaxed);
+        std::int64_t next = 0;
+        do{
+            next = (average == 0) ? sample.count() : average + (sample.count() - average)/8;
+        }while(!ThreadControls::relation_time_ns_.compare_exchange_weak(average, next, std::memory_order::memory_order_relaxed));
+        return;
+    }
+
+    void ThreadControls::thread_sched_yield_deadline(bool finished, const std::shared_ptr<ThreadSchedHandle>& current)
+    {
+        // Threads that do not own a scheduling handle don't take part in deadline scheduling.
+        if(!current){
+            return;
+        }
+        std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
+        auto now = std::chrono::steady_clock::now();
+        if(finished){
+            auto it = std::find(ThreadControls::sched_handles_.begin(), ThreadControls::sched_handles_.end(), current);
+            if(it != ThreadControls::sched_handles_.end()){
+                ThreadControls::sched_handles_.erase(it);
+                ThreadControls::sched_size_.fetch_sub(1, std::memory_order::memory_order_relaxed);
+            }
+            if(current->deadline != std::chrono::time_point<std::chrono::steady_clock>::max()){
+                if(now > current->deadline){
+                    ThreadControls::deadline_misses_.fetch_add(1, std::memory_order::memory_order_relaxed);
+                } else {
+                    ThreadControls::deadline_hits_.fetch_add(1, std::memory_order::memory_order_relaxed);
+                }
+            }
+        }
+        // Find the waiting context with the highest priority.
+        auto next = ThreadControls::sched_handles_.end();
+        for(auto it = ThreadControls::sched_handles_.begin(); it != ThreadControls::sched_handles_.end(); ++it){
+            if((*it)->parked && (next == ThreadControls::sched_handles_.end() || ThreadControls::thread_sched_priority(**it, now) < ThreadControls::thread_sched_priority(**next, now))){
+                next = it;
+            }
+        }
+        if(!finished && (next == ThreadControls::sched_handles_.end() || !(ThreadControls::thread_sched_priority(**next, now) < ThreadControls::thread_sched_priority(*current, now)))){
+            // The current context still has the highest priority, so it continues to run.
+            lk.unlock();
+            current->start.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order::memory_order_relaxed);
+            ThreadControls::set_start_time();
+            return;
+        }
+        if(next != ThreadControls::sched_handles_.end()){
+            auto handle = *next;
+            handle->parked = false;
+            std::unique_lock<std::mutex> handle_lock(handle->mtx);
+            handle->flag.store(true, std::memory_order::memory_order_relaxed);
+            handle->cv.notify_one();
+        }
+        if(finished){
+            lk.unlock();
+            ThreadControls::set_start_time();
+            return;
+        }
+        current->parked = true;
+        lk.unlock();
+        std::unique_lock<std::mutex> handle_lock(current->mtx);
+        current->cv.wait(handle_lock, [&](){ return current->flag.load(std::memory_order::memory_order_relaxed); });
+        current->flag.store(false, std::memory_order::memory_order_relaxed);
+        handle_lock.unlock();
+        current->start.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order::memory_order_relaxed);
+        ThreadControls::set_start_time();
+        return;
+    }
+
+    void ThreadControls::thread_sched_yield(bool finished, const std::shared_ptr<ThreadSchedHandle>& current)
+    {
+        if(ThreadControls::sched_policy() != SchedPolicy::ROUND_ROBIN){
+            ThreadControls::thread_sched_yield_deadline(finished, current);
+            return;
+        }
         std::unique_lock<std::mutex> lk(ThreadControls::sched_mtx_);
         if(!ThreadControls::sched_handles_.empty()){
             auto handle = ThreadControls::sched_handles_.front();
             ThreadControls::sched_handles_.pop_front();
             if(finished){
                 lk.unlock();
+                ThreadControls::sched_size_.fetch_sub(1, std::memory_order::memory_order_relaxed);
                 ThreadControls::set_start_time();
                 std::unique_lock<std::mutex> handle_lock(handle->mtx);
                 bool flag = handle->flag.load(std::memory_order::memory_order_relaxed);
@@ -446,7 +1411,7 @@ namespace app{
                 handle->cv.notify_one();
                 handle_lock.unlock();
             } else {
-                sched_handles_.push_back(handle);
+                ThreadControls::sched_handles_.push_back(handle);
                 lk.unlock();
                 std::unique_lock<std::mutex> handle_lock(handle->mtx);
                 bool flag = handle->flag.load(std::memory_order::memory_order_relaxed);
@@ -456,8 +1421,7 @@ namespace app{
                 handle->cv.wait(handle_lock, [&](){ return (handle->flag.load(std::memory_order::memory_order_relaxed) == flag); });
                 handle_lock.unlock();
             }
-        } else {
-            lk.unlock();
+            return;
         }
         return;
     }
@@ -479,6 +1443,7 @@ namespace app{
         signal_->fetch_or(CTL_IO_SCHED_START_EVENT, std::memory_order::memory_order_relaxed);
         ThreadControls::thread_sched_yield(false);
         cv_->notify_one();
+        ExecutorReactor::wake();
         return;
     }  
 
@@ -491,41 +1456,258 @@ namespace app{
             // we must guarantee that the thread is unblocked (started) before it can be preempted.
             signal_->fetch_or(CTL_IO_SCHED_START_EVENT | CTL_IO_SCHED_END_EVENT, std::memory_order::memory_order_relaxed);
             cv_->notify_one();
+            ExecutorReactor::wake();
+            // Wake a pipelined executor that is waiting for records.
+            ctx_mtx_->lock();
+            if(records_efd_ != -1){
+                std::uint64_t notice = 1;
+                while(write(records_efd_, &notice, sizeof(notice)) == -1 && errno == EINTR){}
+            }
+            ctx_mtx_->unlock();
         }
         return tmp;
     }
 
     void ThreadControls::cleanup(){
-        if(state_ > 0){
+        // Executors that have been released for reuse no longer belong to this thread.
+        if(state_ > 0 && pid_ > 0){
             kill_subprocesses(pid_);
             close_pipe(pipe_);
         }
+        SharedResults::close(result_memfd_);
+        params_out_.clear();
+        params_eof_ = false;
+        unwatch_records();
+        if(stream_){
+            // Don't wait for a result that is still being forwarded, the producer closes the stream when it is done.
+            std::unique_lock<std::mutex> lk(ThreadControls::streams_mtx_);
+            auto it = ThreadControls::streams_.find((*relation)[0].get());
+            if(it != ThreadControls::streams_.end() && it->second == stream_){
+                ThreadControls::streams_.erase(it);
+            }
+            lk.unlock();
+            std::unique_lock<std::mutex> stream_lk(stream_->mtx);
+            if(stream_->state == ResultStream::State::OFFERED){
+                stream_->state = ResultStream::State::WITHDRAWN;
+                close_stream(*stream_);
+            }
+            stream_.reset();
+        }
+    }
+
+    bool ThreadControls::read_available(){
+        // Reads whatever is available on a non-blocking result pipe, and returns true once the result is complete.
+        std::array<char, MAX_LENGTH> buf;
+        int len = 0;
+        do{
+            len = read(pipe_[0], buf.data(), MAX_LENGTH);
+            if(len < 0){
+                switch(errno)
+                {
+                    case EINTR:
+                        break;
+                    case EAGAIN:
+                        return false;
+                    default:
+                        std::cerr << "thread-controls.cpp:883:read(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            } else if(len > 0){
+                result_.append(buf.data(), len);
+                if(pipelined_){
+                    publish_records(relation, result_, records_published_, false);
+                }
+            }
+            if(LauncherPool::persistent() && result_.size() >= 4){
+                const unsigned char* header = reinterpret_cast<const unsigned char*>(result_.data());
+                std::size_t length = (static_cast<std::size_t>(header[0]) << 24) | (static_cast<std::size_t>(header[1]) << 16) | (static_cast<std::size_t>(header[2]) << 8) | header[3];
+                if(result_.size() - 4 >= length){
+                    result_ = result_.substr(4, length);
+                    reusable_ = true;
+                    break;
+                }
+            }
+        }while(len != 0);
+        if(pipelined_){
+            publish_records(relation, result_, records_published_, true);
+            result_ = records_to_array(result_);
+        }
+        if(reusable_ || !LauncherPool::persistent()){
+            store_result(relation, result_, result_memfd_);
+        }
+        SharedResults::close(result_memfd_);
+        result_.clear();
+        state_->fetch_add(1, std::memory_order::memory_order_relaxed);
+        return true;
+    }
+
+    bool ThreadControls::write_available(){
+        // Writes the parameters that did not fit into a non-blocking downstream pipe, and returns true once they have all been written.
+        std::size_t bytes_written = 0;
+        while(bytes_written < params_out_.size()){
+            ssize_t len = write(pipe_[1], params_out_.data() + bytes_written, params_out_.size() - bytes_written);
+            if(len == -1){
+                if(errno == EINTR){
+                    continue;
+                } else if(errno == EAGAIN){
+                    break;
+                }
+                std::cerr << "thread-controls.cpp:1494:write(pipe[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            bytes_written += len;
+        }
+        params_out_.erase(0, bytes_written);
+        if(!params_out_.empty()){
+            return false;
+        }
+        if(params_eof_){
+            // Closing the pipe tells a streaming launcher that there are no more records.
+            if(close(pipe_[1]) == -1){
+                std::cerr << "thread-controls.cpp:1506:close(pipe[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+            pipe_[1] = -1;
+            params_eof_ = false;
+        }
+        return true;
     }
 
     bool ThreadControls::thread_continue(){
         switch(state_->load(std::memory_order::memory_order_relaxed))
         {
             case 0:
+                if(ThreadControls::streams_records(relation)){
+                    // Streaming launchers handle one record per line until their input is closed.
+                    env["__OW_STREAM"] = "1";
+                    pipelined_ = (relation->size() == 1 && ThreadControls::streams_records((*relation)[0]));
+                } else if(LauncherPool::claim(relation, pid_, pipe_)){
+                    // Pooled launchers have already completed the ready handshake.
+                    state_->store(2, std::memory_order::memory_order_relaxed);
+                    return true;
+                }
+                if(Zygote::spawn(relation, env, pid_, pipe_)){
+                    // The child normally attaches itself before it opens its FIFOs, this only sets its limits.
+                    ExecutorCgroup::attach(pid_);
+                    ProcessReaper::watch(pid_);
+                    // Children forked by the zygote still complete the ready handshake.
+                    state_->store(1, std::memory_order::memory_order_relaxed);
+                    return true;
+                }
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
-                return fork_exec(pipe_, pid_, relation, env);
+                return spawn_launcher(pipe_, pid_, relation, env);
             case 1:
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
                 return wait_for_launcher(pipe_);
             case 2:
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
+                offer_stream();
                 return subprocess_pause(pid_);
             case 3:
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
+                ExecutorCgroup::set_weight(pid_, cpu_weight);
                 return subprocess_continue(pid_);
             case 4:
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
-                return write_params_to_subprocess(relation, pipe_, boost::json::serialize(params));
+                exec_start_ = std::chrono::steady_clock::now();
+                if(stream_){
+                    withdraw_stream();
+                    std::shared_ptr<ResultStream> stream = std::move(stream_);
+                    if(stream->state == ResultStream::State::CLAIMED){
+                        return write_stream_to_subprocess(relation, pipe_, *stream, params_out_);
+                    }
+                }
+                if(pipelined_){
+                    // Records are forwarded from the streaming dependency while this relation is waiting for its result.
+                    for(int fd: pipe_){
+                        int flags = fcntl(fd, F_GETFL);
+                        if(flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1){
+                            std::cerr << "thread-controls.cpp:1524:fcntl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                            throw "what?";
+                        }
+                    }
+                    int efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                    if(efd == -1){
+                        std::cerr << "thread-controls.cpp:1631:eventfd() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                    }
+                    ctx_mtx_->lock();
+                    records_efd_ = efd;
+                    ctx_mtx_->unlock();
+                    (*relation)[0]->watch_records(records_efd_);
+                    relation->open_records();
+                    return forward_records();
+                }
+                if(SharedResults::enabled()){
+                    SharedResults::close(result_memfd_);
+                    result_memfd_ = SharedResults::create();
+                }
+                if(ThreadControls::streams_records(relation)){
+                    if(!write_params_to_subprocess(relation, pipe_, boost::json::serialize(params), result_memfd_, env, params_out_)){
+                        return false;
+                    }
+                    relation->open_records();
+                    // A streaming relation without a streaming dependency handles a single parameters record.
+                    if(!params_out_.empty()){
+                        // The pipe is closed once the rest of the parameters have been written.
+                        params_eof_ = true;
+                        return true;
+                    }
+                    if(close(pipe_[1]) == -1){
+                        std::cerr << "thread-controls.cpp:1542:close(pipe[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                    }
+                    pipe_[1] = -1;
+                    return true;
+                }
+                return write_params_to_subprocess(relation, pipe_, boost::json::serialize(params), result_memfd_, env, params_out_);
             case 5:
+                if(pipelined_){
+                    // Records are forwarded, and results are collected, until the launcher closes its output. The executor
+                    // sleeps until the launcher writes, the downstream pipe drains, or the dependency publishes records.
+                    forward_records();
+                    std::array<struct pollfd, 3> pfds = {{
+                        {pipe_[0], POLLIN, 0},
+                        {(records_out_.empty()) ? -1 : pipe_[1], POLLOUT, 0},
+                        {records_efd_, POLLIN, 0}
+                    }};
+                    if(poll(pfds.data(), pfds.size(), -1) == -1 && errno != EINTR){
+                        std::cerr << "thread-controls.cpp:1555:poll() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                    }
+                    if(pfds[2].revents & POLLIN){
+                        std::uint64_t notice = 0;
+                        while(read(records_efd_, &notice, sizeof(notice)) == -1 && errno == EINTR){}
+                    }
+                    if(pfds[0].revents & (POLLIN | POLLHUP)){
+                        read_available();
+                    }
+                    return true;
+                }
                 return wait_for_result_from_subprocess(pipe_, state_);
             case 6:
                 state_->fetch_add(1, std::memory_order::memory_order_relaxed);
-                return read_result_from_subprocess(relation, pipe_);
+                if(pipelined_){
+                    // The result was collected by read_available().
+                    return true;
+                }
+                if(LauncherPool::persistent()){
+                    return read_framed_result_from_subprocess(relation, pipe_, reusable_, result_memfd_);
+                }
+                return read_result_from_subprocess(relation, pipe_, result_memfd_, ThreadControls::claim_stream(relation), ThreadControls::streams_records(relation));
             default:
+                ThreadControls::relation_time_sample(std::chrono::steady_clock::now() - exec_start_);
+                if(reusable_){
+                    // Hand the idle executor back to the launcher pool so that the next invocation of this relation can reuse it.
+                    LauncherPool::release(relation, pid_, pipe_);
+                    pid_ = 0;
+                    reusable_ = false;
+                    return false;
+                }
+                // A launcher can fail before it has read all of its parameters.
+                params_out_.clear();
+                params_eof_ = false;
+                unwatch_records();
                 close_pipe(pipe_);
                 return false;
         }
@@ -1,17 +1,20 @@
 #ifndef THREAD_CONTROLS_HPP
 #define THREAD_CONTROLS_HPP
 #include <thread>
+#include <array>
 #include <cstring>
 #include <deque>
 #include <atomic>
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <chrono>
 #include <map>
 #include <boost/json.hpp>
 #include <condition_variable>
 #include "../controller-events.hpp"
 #include "action-relation.hpp"
+#include "executor-cgroup.hpp"
 
 namespace controller{
 namespace app{
@@ -20,21 +23,113 @@ namespace app{
     {
         std::mutex mtx;
         std::condition_variable cv;
-        std::atomic<bool> flag;
+        std::atomic<bool> flag{false};
+        // Deadline scheduling.
+        std::chrono::time_point<std::chrono::steady_clock> deadline{std::chrono::time_point<std::chrono::steady_clock>::max()};
+        std::atomic<std::size_t> remaining{0};
+        bool parked{false};
+        // Start of the current time slice, in steady clock ticks.
+        std::atomic<std::chrono::steady_clock::rep> start{0};
+    };
+
+    enum class SchedPolicy
+    {
+        ROUND_ROBIN,
+        EARLIEST_DEADLINE,
+        LEAST_LAXITY
+    };
+
+    /* The result of a relation that is being streamed into the launcher of a dependent. */
+    // A dependent with a single dependency offers a duplicate of its downstream pipe once its launcher is ready.
+    // The launcher that produces the dependency result tees it into the offered pipe while the controller reads
+    // its own copy, and the dependent only writes whatever could not be forwarded once it has been scheduled.
+    // The mutex is only held to change the state. The producer owns the stream while it is FORWARDING, and notifies
+    // the condition variable once the result has been read and the stream is CLAIMED or WITHDRAWN.
+    struct ResultStream
+    {
+        enum class State
+        {
+            OFFERED,
+            FORWARDING,
+            CLAIMED,
+            WITHDRAWN
+        };
+        std::mutex mtx;
+        std::condition_variable cv;
+        int fd{-1};
+        State state{State::OFFERED};
+        // The number of result bytes that have been forwarded, and whether the parameter frame was completed.
+        std::size_t forwarded{0};
+        bool complete{false};
+    };
+
+    struct LauncherHandle
+    {
+        pid_t pid;
+        std::array<int, 2> pipe;
+    };
+
+    /* A pool of launchers that have already been exec'd and have completed the ready handshake. */
+    // Pooled launchers are keyed by the launcher arguments (file stem and relation key), and only inherit the
+    // controller environment. The pool is enabled by setting __OW_LAUNCHER_POOL, and each relation is kept 
+    // __OW_LAUNCHER_POOL_DEPTH launchers deep, or __OW_NUM_CONCURRENCY deep if the depth is not set.
+    // When __OW_PERSISTENT_LAUNCHER is set, launchers serve many invocations using length prefixed frames, 
+    // and executors are released back into the pool after their result has been read, up to the pool depth.
+    // The pool requires persistent launchers, since a claimed launcher only receives the environment of its
+    // activation in a frame.
+    // Each frame is {"__OW_ENV":{...}, "__OW_INPUT":...}, and the launcher replaces the environment of the previous
+    // activation with __OW_ENV before it handles __OW_INPUT.
+    class LauncherPool
+    {
+    public:
+        static bool enabled();
+        static void prime(const std::vector<std::shared_ptr<Relation> >& relations, std::size_t concurrency);
+        static bool persistent();
+        static bool claim(const std::shared_ptr<Relation>& relation, pid_t& pid, std::array<int, 2>& pipe);
+        static void release(const std::shared_ptr<Relation>& relation, pid_t pid, const std::array<int, 2>& pipe);
+        static void clear();
+        static std::size_t hits() { return hits_.load(std::memory_order::memory_order_relaxed); }
+        static std::size_t misses() { return misses_.load(std::memory_order::memory_order_relaxed); }
+    private:
+        static void refill();
+        static std::mutex mtx_;
+        static std::condition_variable cv_;
+        static bool started_;
+        static std::size_t generation_;
+        static std::size_t depth_;
+        static std::map<std::string, std::shared_ptr<Relation> > relations_;
+        static std::map<std::string, std::size_t> depths_;
+        static std::map<std::string, std::deque<LauncherHandle> > launchers_;
+        static std::atomic<std::size_t> hits_;
+        static std::atomic<std::size_t> misses_;
     };
 
     class ThreadControls
     {
     public:
         static constexpr std::chrono::milliseconds THREAD_SCHED_TIME_SLICE_MS = std::chrono::milliseconds(5);
-        static std::chrono::time_point<std::chrono::steady_clock> start_timer_;
+        static std::atomic<std::chrono::steady_clock::rep> start_timer_;
+        static std::atomic<std::size_t> sched_size_;
+        // Handles wait in a single ring, so that every handle is visited in turn. Deadline scheduling compares
+        // every waiting handle in the same ring.
         static std::mutex sched_mtx_;
         static std::deque<std::shared_ptr<ThreadSchedHandle> > sched_handles_;
         static void set_start_time();
         static std::chrono::time_point<std::chrono::steady_clock> get_start_time();
+        static std::chrono::time_point<std::chrono::steady_clock> get_start_time(const std::shared_ptr<ThreadSchedHandle>& current);
         static std::chrono::milliseconds thread_sched_time_slice();
-        static std::shared_ptr<ThreadSchedHandle> thread_sched_push();
-        static void thread_sched_yield(bool finished);
+        static std::shared_ptr<ThreadSchedHandle> thread_sched_push(std::chrono::time_point<std::chrono::steady_clock> deadline = std::chrono::time_point<std::chrono::steady_clock>::max());
+        static void thread_sched_yield(bool finished, const std::shared_ptr<ThreadSchedHandle>& current = nullptr);
+
+        // Deadline scheduling is selected with __OW_SCHED_POLICY=edf|llf, the default is round robin.
+        static SchedPolicy sched_policy();
+        static std::chrono::nanoseconds relation_time() { return std::chrono::nanoseconds(relation_time_ns_.load(std::memory_order::memory_order_relaxed)); }
+        static std::size_t deadline_misses() { return deadline_misses_.load(std::memory_order::memory_order_relaxed); }
+        static std::size_t deadline_hits() { return deadline_hits_.load(std::memory_order::memory_order_relaxed); }
+
+        // Streaming of results into the launchers of single dependency relations is enabled with __OW_SPLICE_RESULTS.
+        static constexpr int STREAM_PIPE_SIZE = 1048576;
+        static bool stream_results();
 
         explicit ThreadControls():
             pid_{0},
@@ -44,11 +139,14 @@ namespace app{
             signal_(std::make_unique<std::atomic<std::uint16_t> >()),
             ctx_cv_(std::make_unique<std::condition_variable>()),
             state_(std::make_unique<std::atomic<std::size_t> >(0)),
-            pipe_{}
+            pipe_{},
+            reusable_{false}
         {}
         boost::json::object params;
         std::map<std::string, std::string> env;
         std::shared_ptr<Relation> relation;
+        // The executor cgroup cpu.weight, applied when the executor is scheduled.
+        std::uint32_t cpu_weight{ExecutorCgroup::DEFAULT_CPU_WEIGHT};
         std::atomic<std::uint16_t>& signal() { return *signal_; }
         void wait();
         void notify(std::size_t idx);
@@ -63,7 +161,29 @@ namespace app{
         pid_t& pid() { return pid_; }
         void cleanup();
         bool thread_continue();
+
+        // Event driven executors.
+        int result_fd() const { return pipe_[0]; }
+        int params_fd() const { return pipe_[1]; }
+        bool params_pending() const { return !params_out_.empty(); }
+        bool read_available();
+        bool write_available();
     private:
+        static void thread_sched_yield_deadline(bool finished, const std::shared_ptr<ThreadSchedHandle>& current);
+        static std::chrono::time_point<std::chrono::steady_clock> thread_sched_priority(const ThreadSchedHandle& handle, std::chrono::time_point<std::chrono::steady_clock> now);
+        static void relation_time_sample(std::chrono::nanoseconds sample);
+        static std::atomic<std::int64_t> relation_time_ns_;
+        static std::atomic<std::size_t> deadline_misses_;
+        static std::atomic<std::size_t> deadline_hits_;
+        static std::shared_ptr<ResultStream> claim_stream(const std::shared_ptr<Relation>& relation);
+        static std::mutex streams_mtx_;
+        static std::map<const Relation*, std::shared_ptr<ResultStream> > streams_;
+        void offer_stream();
+        void withdraw_stream();
+        static bool streams_records(const std::shared_ptr<Relation>& relation);
+        bool forward_records();
+        void unwatch_records();
+
         pid_t pid_;
         std::unique_ptr<std::mutex> mtx_;
         std::unique_ptr<std::mutex> ctx_mtx_;
@@ -72,6 +192,23 @@ namespace app{
         std::unique_ptr<std::condition_variable> ctx_cv_;
         std::unique_ptr<std::atomic<std::size_t> > state_;
         std::array<int, 2> pipe_;
+        bool reusable_;
+        std::string result_;
+        // The memfd that the current invocation writes its result into, when results are shared through memfds.
+        int result_memfd_{-1};
+        // Parameters that did not fit into a non-blocking downstream pipe, and whether the pipe is closed once they are written.
+        std::string params_out_;
+        bool params_eof_{false};
+        std::shared_ptr<ResultStream> stream_;
+        // Records forwarded from a streaming dependency.
+        bool pipelined_{false};
+        bool records_closed_{false};
+        std::size_t records_offset_{0};
+        std::size_t records_published_{0};
+        std::string records_out_;
+        // Signalled by the streaming dependency when it publishes records, and by stop_thread().
+        int records_efd_{-1};
+        std::chrono::time_point<std::chrono::steady_clock> exec_start_;
         std::vector<std::size_t> execution_context_idxs_;
     };
 }//namespace app
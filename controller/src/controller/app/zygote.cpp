@@ -0,0 +1,349 @@
+#include "zygote.hpp"
+#include "thread-controls.hpp"
+#include "process-reaper.hpp"
+#include "executor-cgroup.hpp"
+#include <boost/json.hpp>
+#include <csignal>
+#include <iostream>
+#include <charconv>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static bool write_all(int fd, const std::string& data){
+    std::size_t bytes_written = 0;
+    int len = 0;
+    do{
+        len = write(fd, data.data() + bytes_written, data.size() - bytes_written);
+        if(len < 0){
+            switch(errno)
+            {
+                case EINTR:
+                    break;
+                case EPIPE:
+                    return false;
+                default:
+                    std::cerr << "zygote.cpp:22:write() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        } else {
+            bytes_written += len;
+        }
+    }while(bytes_written < data.size());
+    return true;
+}
+
+static bool child_alive(pid_t pid){
+    return (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+// The FIFOs are opened without blocking, so that a child that dies before opening its ends can't hang the controller.
+static int open_fifo(const std::string& path, pid_t child, const std::chrono::steady_clock::time_point& deadline){
+    int fd = -1;
+    do{
+        fd = open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if(fd == -1){
+            switch(errno)
+            {
+                case EINTR:
+                    break;
+                case ENXIO:
+                    // The child hasn't opened the FIFO for reading yet.
+                    if(!child_alive(child) || std::chrono::steady_clock::now() > deadline){
+                        return -1;
+                    }
+                    usleep(1000);
+                    break;
+                default:
+                    std::cerr << "zygote.cpp:59:open(" << path << ") failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+    }while(fd == -1);
+    return fd;
+}
+
+// A FIFO that is opened for reading without blocking reads end of file until the child opens it for writing, so wait
+// until the child has written its ready handshake or closed the FIFO.
+static bool await_fifo(int fd, pid_t child, const std::chrono::steady_clock::time_point& deadline){
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int ready = 0;
+    do{
+        ready = poll(&pfd, 1, 10);
+        if(ready == -1){
+            switch(errno)
+            {
+                case EINTR:
+                    break;
+                default:
+                    std::cerr << "zygote.cpp:80:poll() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        } else if(ready == 0 && (!child_alive(child) || std::chrono::steady_clock::now() > deadline)){
+            return false;
+        }
+    }while(ready < 1);
+    return true;
+}
+
+static void set_blocking(int fd){
+    int flags = fcntl(fd, F_GETFL);
+    if(flags == -1 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) == -1){
+        std::cerr << "zygote.cpp:93:fcntl() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        throw "what?";
+    }
+    return;
+}
+
+namespace controller{
+namespace app{
+    /* Zygote Static Members */
+    std::mutex Zygote::mtx_;
+    pid_t Zygote::pid_ = 0;
+    std::array<int, 2> Zygote::pipe_ = {-1, -1};
+    std::size_t Zygote::counter_ = 0;
+
+    bool Zygote::enabled()
+    {
+        static const bool enabled = (getenv("__OW_ZYGOTE") != nullptr);
+        return enabled;
+    }
+
+    void Zygote::start()
+    {
+        Zygote::stop();
+        const char* __OW_ACTION_BIN = getenv("__OW_ACTION_BIN");
+        if ( __OW_ACTION_BIN == nullptr ){
+            std::cerr << "__OW_ACTION_BIN envvar is not set." << std::endl;
+            throw "__OW_ACTION_BIN environment variable not set.";
+        }
+        const char* __OW_ACTION_LAUNCHER = getenv("__OW_ACTION_LAUNCHER");
+        if ( __OW_ACTION_LAUNCHER == nullptr ){
+            std::cerr << "__OW_ACTION_LAUNCHER envvar is not set." << std::endl;
+            throw "__OW_ACTION_LAUNCHER environment varible not set.";
+        }
+        std::vector<const char*> argv{__OW_ACTION_BIN, __OW_ACTION_LAUNCHER, "--zygote", nullptr};
+        int downstream[2] = {};
+        int upstream[2] = {};
+        if (pipe2(downstream, O_CLOEXEC) == -1){
+            std::cerr << "zygote.cpp:82:pipe(downstream) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        if (pipe2(upstream, O_CLOEXEC) == -1){
+            std::cerr << "zygote.cpp:86:pipe(upstream) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+        pid_t pid = fork();
+        switch(pid)
+        {
+            case 0:
+            {
+                sigset_t sigmask = {};
+                sigemptyset(&sigmask);
+                sigaddset(&sigmask, SIGTERM);
+                sigprocmask(SIG_UNBLOCK, &sigmask, nullptr);
+                // The zygote leads its own process group so that it can be replaced without signalling the children it has forked.
+                setpgid(0,0);
+                // dup2 clears the close on exec flag on the duplicated descriptors.
+                if (dup2(downstream[0], STDIN_FILENO) == -1 || dup2(upstream[1], 3) == -1){
+                    exit(1);
+                }
+                execve(__OW_ACTION_BIN, const_cast<char* const*>(argv.data()), environ);
+                exit(1);
+            }
+            case -1:
+            {
+                std::cerr << "zygote.cpp:108:fork failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "This shouldn't happen.";
+            }
+            default:
+                break;
+        }
+        // Set the process group in the parent as well, so that the zygote can be signalled as soon as fork returns.
+        if(setpgid(pid, pid) == -1){
+            switch(errno)
+            {
+                case EACCES:
+                    // The zygote has already exec'd.
+                    break;
+                default:
+                    std::cerr << "zygote.cpp:121:setpgid() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+            }
+        }
+        if(close(downstream[0]) == -1){
+            std::cerr << "zygote.cpp:126:close(downstream[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "this shouldn't happen.";
+        }
+        if (close(upstream[1]) == -1){
+            std::cerr << "zygote.cpp:130:close(upstream[1]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "this shouldn't happen.";
+        }
+        ProcessReaper::track(pid);
+        std::unique_lock<std::mutex> lk(Zygote::mtx_);
+        Zygote::pid_ = pid;
+        Zygote::pipe_[0] = upstream[0];
+        Zygote::pipe_[1] = downstream[1];
+        // Wait for the zygote to finish preloading the action modules.
+        char ready[1] = {};
+        int len = 0;
+        do{
+            len = read(Zygote::pipe_[0], ready, 1);
+            if(len < 0){
+                switch(errno)
+                {
+                    case EINTR:
+                        break;
+                    default:
+                        std::cerr << "zygote.cpp:147:read(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            } else if(len == 0){
+                std::cerr << "zygote.cpp:151:zygote exited before it was ready, falling back to fork and exec." << std::endl;
+                Zygote::close_zygote();
+                return;
+            }
+        }while(len < 1);
+        return;
+    }
+
+    void Zygote::stop()
+    {
+        std::unique_lock<std::mutex> lk(Zygote::mtx_);
+        Zygote::close_zygote();
+        return;
+    }
+
+    void Zygote::close_zygote()
+    {
+        if(Zygote::pid_ > 0){
+            // The zygote only holds preloaded modules, so there is nothing to lose by killing it outright.
+            if(kill(-Zygote::pid_, SIGKILL) == -1){
+                switch(errno)
+                {
+                    case ESRCH:
+                        break;
+                    default:
+                        std::cerr << "zygote.cpp:175:kill() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            }
+            for(auto& fd: Zygote::pipe_){
+                if(fd != -1 && close(fd) == -1){
+                    std::cerr << "zygote.cpp:181:close(pipe) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                    throw "what?";
+                }
+                fd = -1;
+            }
+            Zygote::pid_ = 0;
+        }
+        return;
+    }
+
+    bool Zygote::spawn(const std::shared_ptr<Relation>& relation, const std::map<std::string, std::string>& env, pid_t& pid, std::array<int, 2>& pipe)
+    {
+        if(!Zygote::enabled()){
+            return false;
+        }
+        std::unique_lock<std::mutex> lk(Zygote::mtx_);
+        if(Zygote::pid_ == 0){
+            return false;
+        }
+        std::string fifo("/tmp/.ow-zygote-");
+        fifo.append(std::to_string(Zygote::pid_));
+        fifo.append("-");
+        fifo.append(std::to_string(Zygote::counter_++));
+        std::string in(fifo + ".in");
+        std::string out(fifo + ".out");
+        if(mkfifo(in.c_str(), 0600) == -1 || mkfifo(out.c_str(), 0600) == -1){
+            std::cerr << "zygote.cpp:207:mkfifo() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            unlink(in.c_str());
+            return false;
+        }
+        boost::json::object jenv;
+        for(auto& kvp: env){
+            jenv.emplace(kvp.first, kvp.second);
+        }
+        boost::json::object request;
+        request.emplace("file", relation->path().stem().string());
+        request.emplace("key", relation->key());
+        request.emplace("in", in);
+        request.emplace("out", out);
+        request.emplace("env", jenv);
+        request.emplace("persistent", LauncherPool::persistent());
+        if(ExecutorCgroup::enabled()){
+            request.emplace("cgroup", ExecutorCgroup::root());
+        }
+        std::string data(boost::json::serialize(request));
+        data.append("\n");
+
+        // Read the pid of the forked child back from the zygote.
+        std::string reply;
+        char c = 0;
+        int len = 0;
+        bool alive = write_all(Zygote::pipe_[1], data);
+        while(alive && c != '\n'){
+            len = read(Zygote::pipe_[0], &c, 1);
+            if(len < 0){
+                switch(errno)
+                {
+                    case EINTR:
+                        break;
+                    default:
+                        std::cerr << "zygote.cpp:236:read(pipe[0]) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            } else if(len == 0){
+                alive = false;
+            } else if(c != '\n'){
+                reply.push_back(c);
+            }
+        }
+        pid_t child = 0;
+        std::from_chars_result fcres = std::from_chars(reply.data(), reply.data()+reply.size(), child, 10);
+        if(!alive || fcres.ec != std::errc() || child <= 0){
+            std::cerr << "zygote.cpp:248:zygote failed to fork " << relation->key() << ", falling back to fork and exec." << std::endl;
+            Zygote::close_zygote();
+            unlink(in.c_str());
+            unlink(out.c_str());
+            return false;
+        }
+        lk.unlock();
+
+        // The child opens "in" before "out", so the FIFOs must be opened in the same order here.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        pipe = {-1, -1};
+        pipe[1] = open_fifo(in, child, deadline);
+        if(pipe[1] != -1){
+            pipe[0] = open(out.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if(pipe[0] == -1){
+                std::cerr << "zygote.cpp:318:open(" << out << ") failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+        }
+        unlink(in.c_str());
+        unlink(out.c_str());
+        if(pipe[0] == -1 || !await_fifo(pipe[0], child, deadline)){
+            std::cerr << "zygote.cpp:325:" << relation->key() << " never opened its FIFOs, falling back to fork and exec." << std::endl;
+            // The child leads its own process group, unless it died before it could set it.
+            if(kill(-child, SIGKILL) == -1){
+                kill(child, SIGKILL);
+            }
+            for(auto& fd: pipe){
+                if(fd != -1){
+                    close(fd);
+                }
+                fd = -1;
+            }
+            return false;
+        }
+        set_blocking(pipe[0]);
+        set_blocking(pipe[1]);
+        pid = child;
+        return true;
+    }
+    // End of Zygote Static Members
+}//namespace app
+}//namespace controller
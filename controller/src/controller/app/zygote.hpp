@@ -0,0 +1,36 @@
+#ifndef ZYGOTE_HPP
+#define ZYGOTE_HPP
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include "action-relation.hpp"
+
+namespace controller{
+namespace app{
+    /* A launcher process that has preloaded every module in the action manifest. */
+    // The zygote is started with `__OW_ACTION_BIN __OW_ACTION_LAUNCHER --zygote` after /init, and is asked to fork
+    // one child per relation instead of exec'ing a fresh interpreter. Requests are written to the zygote stdin as one
+    // JSON object per line: {"file":..., "key":..., "in":..., "out":..., "env":{...}, "persistent":..., "cgroup":...}, and the zygote responds on fd 3 with
+    // the pid of the child on a single line. The child moves itself into <cgroup>/<pid> before it runs any action code. The child process group reads its parameters from the "in" FIFO and writes
+    // the ready handshake and its results to the "out" FIFO, exactly like an exec'd launcher does with stdin and fd 3.
+    // The zygote is enabled by setting __OW_ZYGOTE.
+    class Zygote
+    {
+    public:
+        static bool enabled();
+        static void start();
+        static void stop();
+        static bool spawn(const std::shared_ptr<Relation>& relation, const std::map<std::string, std::string>& env, pid_t& pid, std::array<int, 2>& pipe);
+    private:
+        static void close_zygote();
+        static std::mutex mtx_;
+        static pid_t pid_;
+        static std::array<int, 2> pipe_;
+        static std::size_t counter_;
+    };
+}//namespace app
+}//namespace controller
+#endif
@@ -10,6 +10,23 @@
 
 namespace controller{
 namespace io{
+    /* IO Static Members */
+    std::mutex IO::shards_mtx_;
+    std::vector<IO*> IO::shards_;
+    std::size_t IO::next_shard_ = 0;
+
+    IO* IO::next_shard()
+    {
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        if(shards_.empty()){
+            return nullptr;
+        }
+        IO* shard = shards_[next_shard_ % shards_.size()];
+        ++next_shard_;
+        return shard;
+    }
+    // End of IO Static Members
+
     IO::IO(std::shared_ptr<MessageBox> mbox, const std::string& local_endpoint, boost::asio::io_context& ioc, int* num_running_multi_handles, std::shared_ptr<libcurl::CurlMultiHandle> cmhp)
       : mbox_ptr_(mbox),
         ioc_(ioc),
@@ -17,7 +34,8 @@ namespace io{
         us_(ioc, boost::asio::local::stream_protocol::endpoint(local_endpoint)),
         num_running_multi_handles_{num_running_multi_handles},
         cmhp_{cmhp},
-        stopped_{false}
+        stopped_{false},
+        shard_{0}
     { 
         /* Identify the local sctp server address. */
         // Start by hardcoding the local loop back network prefix.
@@ -65,6 +83,9 @@ namespace io{
             IPPROTO_SCTP,
             laddr
         };
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        shards_.push_back(this);
+        lk.unlock();
         try{
             std::thread io(
                 &IO::start, this
@@ -77,14 +98,15 @@ namespace io{
         }
     }
 
-    IO::IO(std::shared_ptr<MessageBox> mbox, const std::string& local_endpoint, boost::asio::io_context& ioc, std::uint16_t sport, int* num_running_multi_handles, std::shared_ptr<libcurl::CurlMultiHandle> cmhp)
+    IO::IO(std::shared_ptr<MessageBox> mbox, const std::string& local_endpoint, boost::asio::io_context& ioc, std::uint16_t sport, int* num_running_multi_handles, std::shared_ptr<libcurl::CurlMultiHandle> cmhp, std::size_t shard)
       : mbox_ptr_(mbox),
         ioc_(ioc),
-        ss_(ioc, transport::protocols::sctp::endpoint(transport::protocols::sctp::v4(), sport)),
-        us_(ioc, boost::asio::local::stream_protocol::endpoint(local_endpoint)),
+        ss_(ioc, transport::protocols::sctp::endpoint(transport::protocols::sctp::v4(), sport + shard)),
+        us_(ioc, boost::asio::local::stream_protocol::endpoint(local_endpoint), (shard == 0)),
         num_running_multi_handles_{num_running_multi_handles},
         cmhp_{cmhp},
-        stopped_{false}
+        stopped_{false},
+        shard_{shard}
     { 
         /* Identify the local sctp server address. */
         const char* network_prefix;
@@ -118,7 +140,7 @@ namespace io{
         }
         struct sockaddr_in laddr;
         laddr.sin_family = AF_INET;
-        laddr.sin_port = htons(sport);
+        laddr.sin_port = htons(sport + shard);
         for(struct ifaddrs* ifa = ifah; ifa != nullptr; ifa = ifa->ifa_next){
             if(ifa->ifa_addr->sa_family == AF_INET){
                 struct sockaddr_in* ifaddr_in = (struct sockaddr_in*)(ifa->ifa_addr);
@@ -138,6 +160,9 @@ namespace io{
             laddr
         };
 
+        std::unique_lock<std::mutex> lk(shards_mtx_);
+        shards_.push_back(this);
+        lk.unlock();
         try{
             std::thread io(
                 &IO::start, this
@@ -150,60 +175,80 @@ namespace io{
         }
     }
 
-    void IO::start(){
+    void IO::read(const std::shared_ptr<UnixServer::unix_session>& session){
         std::shared_ptr<MessageBox> mbox = mbox_ptr_;
         auto mtxp = mbox->sched_signal_mtx_ptr;
         auto cvp = mbox->sched_signal_cv_ptr;
         auto signalp = mbox->sched_signal_ptr;
-        us_.accept([&, mbox](const boost::system::error_code& ec, std::shared_ptr<UnixServer::unix_session> session){
-            if (!ec){
-                /* Callbacks are registered once with the session. The session will ensure that the callback is called everytime there is a read event
-                   on the socket until the transport session is ultimately closed. */
-                session->async_read([&, session, mbox, mtxp, cvp, signalp](boost::system::error_code ec, std::size_t length){
-                    if(!ec){
-                        // struct timespec ts[2] = {};
-                        // clock_gettime(CLOCK_REALTIME, &ts[0]);
-                        // std::cout << "controller-io.cpp:149:" << (ts[0].tv_sec*1000 + ts[0].tv_nsec/1000000) << ":us_.session->async_read() started." << std::endl;
-                        session->acquire_stream().write(session->buf().data(), length);
-                        session->release_stream();
-                        auto& mtx = *mtxp;
-                        std::unique_lock<std::mutex> lk(mtx);
-                        cvp->wait(lk, [&](){ return !mq_is_full(); });
-                        lk.unlock();
-                        mbox->msg_flag.store(true, std::memory_order::memory_order_relaxed);
-                        signalp->fetch_or(CTL_IO_READ_EVENT, std::memory_order::memory_order_relaxed);
-                        std::shared_ptr<MessageBox> msg = std::make_shared<MessageBox>();
-                        msg->session = session;
-                        mq_push(msg);
-                        mbox->sched_signal_cv_ptr->notify_one();
-                        // clock_gettime(CLOCK_REALTIME, &ts[1]);
-                        // std::cout << "controller-io.cpp:162:" << (ts[1].tv_sec*1000 + ts[1].tv_nsec/1000000) << ":us_.session->async_read() finished." << std::endl;
-                    } else {
-                        if(ec != boost::asio::error::eof){
-                            std::cerr << "Error in unix async read:" << ec.message() << std::endl;
-                        }
-                    }
-                });
+        /* Callbacks are registered once with the session. The session will ensure that the callback is called everytime there is a read event
+           on the socket until the transport session is ultimately closed. */
+        session->async_read([&, session, mbox, mtxp, cvp, signalp](boost::system::error_code ec, std::size_t length){
+            if(!ec){
+                // struct timespec ts[2] = {};
+                // clock_gettime(CLOCK_REALTIME, &ts[0]);
+                // std::cout << "controller-io.cpp:149:" << (ts[0].tv_sec*1000 + ts[0].tv_nsec/1000000) << ":us_.session->async_read() started." << std::endl;
+                // The receive buffer is moved onto the session stream instead of being copied.
+                session->commit_buf(length);
+                // Blocks on the queue eventfd while the ring is full.
+                mq_push(session);
+                mbox->msg_flag.store(true, std::memory_order::memory_order_relaxed);
+                signalp->fetch_or(CTL_IO_READ_EVENT, std::memory_order::memory_order_relaxed);
+                // The controller checks the queue under the scheduler mutex before it waits, so passing through
+                // the mutex here means that the notification can't be lost.
+                std::unique_lock<std::mutex> lk(*mtxp);
+                lk.unlock();
+                cvp->notify_one();
+                // clock_gettime(CLOCK_REALTIME, &ts[1]);
+                // std::cout << "controller-io.cpp:162:" << (ts[1].tv_sec*1000 + ts[1].tv_nsec/1000000) << ":us_.session->async_read() finished." << std::endl;
             } else {
-                std::cerr << "Error in the acceptor callback: " << ec.message() << std::endl;
+                if(ec != boost::asio::error::eof){
+                    std::cerr << "Error in unix async read:" << ec.message() << std::endl;
+                }
             }
         });
+        return;
+    }
+
+    void IO::start(){
+        std::shared_ptr<MessageBox> mbox = mbox_ptr_;
+        auto mtxp = mbox->sched_signal_mtx_ptr;
+        auto cvp = mbox->sched_signal_cv_ptr;
+        auto signalp = mbox->sched_signal_ptr;
+        if(shard_ == 0){
+            us_.accept_native([&](const boost::system::error_code& ec, int fd){
+                if (!ec){
+                    IO* shard = next_shard();
+                    if(shard == nullptr || shard == this){
+                        auto session = us_.adopt(fd);
+                        if(session){
+                            read(session);
+                        }
+                    } else {
+                        // The connection is passed to the io_context of the shard, so that all of its io runs on the shard's thread.
+                        boost::asio::post(shard->ioc_, [shard, fd](){
+                            auto session = shard->us_.adopt(fd);
+                            if(session){
+                                shard->read(session);
+                            }
+                        });
+                    }
+                } else {
+                    std::cerr << "Error in the acceptor callback: " << ec.message() << std::endl;
+                }
+            });
+        }
 
         ss_.init([&, mbox, mtxp, cvp, signalp](const boost::system::error_code& ec,  std::shared_ptr<sctp_transport::SctpSession> session){
             if(!ec){
                 // struct timespec ts[2] = {};
                 // clock_gettime(CLOCK_REALTIME, &ts[0]);
                 // std::cout << "controller-io.cpp:198:" << (ts[0].tv_sec*1000 + ts[0].tv_nsec/1000000) << ":ss_ callback started." << std::endl;
-                auto& mtx = *mtxp;
-                std::unique_lock<std::mutex> lk(mtx);
-                cvp->wait(lk, [&](){ return !mq_is_full(); });
-                lk.unlock();
+                mq_push(session);
                 mbox->msg_flag.store(true, std::memory_order::memory_order_relaxed);
                 signalp->fetch_or(CTL_IO_READ_EVENT, std::memory_order::memory_order_relaxed);
-                std::shared_ptr<MessageBox> msg = std::make_shared<MessageBox>();
-                msg->session = session;
-                mq_push(msg);
-                mbox->sched_signal_cv_ptr->notify_one();          
+                std::unique_lock<std::mutex> lk(*mtxp);
+                lk.unlock();
+                cvp->notify_one();
                 // clock_gettime(CLOCK_REALTIME, &ts[2]);
                 // std::cout << "controller-io.cpp:209:" << (ts[2].tv_sec*1000 + ts[2].tv_nsec/1000000) << ":ss_ callback started." << std::endl;
                 return;  
@@ -227,6 +272,12 @@ namespace io{
     }
 
     void IO::stop(){
+        std::unique_lock<std::mutex> slk(shards_mtx_);
+        auto it = std::find(shards_.begin(), shards_.end(), this);
+        if(it != shards_.end()){
+            shards_.erase(it);
+        }
+        slk.unlock();
         ioc_.stop();
         us_.clear();
         ss_.clear();
@@ -1,10 +1,10 @@
 #ifndef CONTROLLER_IO_HPP
 #define CONTROLLER_IO_HPP
 #include <memory>
-#include <deque>
 #include <transport-servers/sctp-server/sctp-server.hpp>
 #include <transport-servers/unix-server/unix-server.hpp>
 #include <sys/eventfd.h>
+#include "session-queue.hpp"
 /*Forward Declarations*/
 namespace boost{
 namespace asio{
@@ -46,8 +46,6 @@ namespace io{
         {}
     };
 
-    typedef std::deque<std::shared_ptr<MessageBox> > MessageQueue;
-
     // This class encapsulates all of the io operations we need for the 
     // controller
     class IO
@@ -67,24 +65,17 @@ namespace io{
             boost::asio::io_context& ioc, 
             std::uint16_t sport, 
             int* num_running_multi_handles, 
-            std::shared_ptr<libcurl::CurlMultiHandle> cmhp
+            std::shared_ptr<libcurl::CurlMultiHandle> cmhp,
+            std::size_t shard
         );
         void start();
         void stop();
 
-        bool mq_is_empty() { std::unique_lock<std::mutex> lk(mq_mtx_); return mq_.empty(); }
-        bool mq_is_full() { std::unique_lock<std::mutex> lk(mq_mtx_); return (mq_.size() >= MAX_QUEUE_LENGTH); }
-        std::shared_ptr<MessageBox> mq_pull(){ 
-            std::unique_lock<std::mutex> lk(mq_mtx_);
-            if(!mq_.empty()){
-                auto head = mq_.front();
-                mq_.pop_front();
-                return head;
-            } else {
-                return std::shared_ptr<MessageBox>();
-            }
-        }
-        void mq_push(const std::shared_ptr<MessageBox>& msg) { std::unique_lock<std::mutex> lk(mq_mtx_); mq_.push_back(msg); return; }
+        // The IO thread is the only producer, and the controller loop is the only consumer of the message queue.
+        bool mq_is_empty() const { return mq_.empty(); }
+        bool mq_pull(std::shared_ptr<server::Session>& session) { return mq_.pull(session); }
+        void mq_push(const std::shared_ptr<server::Session>& session) { mq_.push(session); return; }
+        const SessionQueue& mq() const { return mq_; }
 
         /* Async Connect routes the connection request based on the address information in server::Remote */
         void async_connect(server::Remote, std::function<void(const boost::system::error_code&, const std::shared_ptr<server::Session>&)>);
@@ -93,6 +84,16 @@ namespace io{
 
         ~IO();
     private:
+        /* Shards. */
+        // Every shard runs its own io_context. Only shard 0 binds the unix socket, and it hands accepted
+        // connections to the shards in turn. Every shard listens for SCTP peers on sport + shard.
+        static std::mutex shards_mtx_;
+        static std::vector<IO*> shards_;
+        static std::size_t next_shard_;
+        static IO* next_shard();
+        // Registers the read callback of a unix session that has been accepted by, or handed to, this shard.
+        void read(const std::shared_ptr<UnixServer::unix_session>& session);
+
         std::shared_ptr<MessageBox> mbox_ptr_;
         pthread_t io_;
         boost::asio::io_context& ioc_;
@@ -107,11 +108,11 @@ namespace io{
         std::shared_ptr<libcurl::CurlMultiHandle> cmhp_;
 
         std::atomic<bool> stopped_;
+        std::size_t shard_;
         std::mutex stop_;
         std::condition_variable stop_cv_;
 
-        std::mutex mq_mtx_;
-        MessageQueue mq_;
+        SessionQueue mq_{MAX_QUEUE_LENGTH};
     };
 }// namespace io
 }// namespace controller
@@ -0,0 +1,156 @@
+#include "session-queue.hpp"
+#include <iostream>
+#include <system_error>
+#include <cstdint>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace controller{
+namespace io{
+    SessionQueue::SessionQueue(std::size_t capacity)
+      : mask_{0},
+        head_{0},
+        tail_{0},
+        efd_{-1},
+        waiters_{0},
+        max_depth_{0},
+        pulled_{0},
+        wait_ns_{0},
+        full_waits_{0},
+        full_wait_ns_{0}
+    {
+        // The capacity is rounded up to a power of two so that cells are indexed with a mask.
+        std::size_t size = 1;
+        while(size < capacity){
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_ = std::make_unique<Cell[]>(size);
+        for(std::size_t i = 0; i < size; ++i){
+            cells_[i].sequence.store(i, std::memory_order::memory_order_relaxed);
+        }
+        efd_ = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+        if(efd_ == -1){
+            std::cerr << "session-queue.cpp:35:eventfd() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+            throw "what?";
+        }
+    }
+
+    bool SessionQueue::try_push(const std::shared_ptr<server::Session>& session)
+    {
+        std::size_t pos = head_.load(std::memory_order::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for(;;){
+            cell = &cells_[pos & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+            if(diff == 0){
+                if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order::memory_order_relaxed)){
+                    break;
+                }
+            } else if(diff < 0){
+                // The cell still holds a session from the previous lap, so the ring is full.
+                return false;
+            } else {
+                pos = head_.load(std::memory_order::memory_order_relaxed);
+            }
+        }
+        cell->session = session;
+        cell->pushed = std::chrono::steady_clock::now().time_since_epoch().count();
+        cell->sequence.store(pos + 1, std::memory_order::memory_order_release);
+
+        std::size_t depth = pos + 1 - tail_.load(std::memory_order::memory_order_relaxed);
+        std::size_t max_depth = max_depth_.load(std::memory_order::memory_order_relaxed);
+        while(depth > max_depth && !max_depth_.compare_exchange_weak(max_depth, depth, std::memory_order::memory_order_relaxed));
+        return true;
+    }
+
+    void SessionQueue::push(const std::shared_ptr<server::Session>& session)
+    {
+        if(try_push(session)){
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        waiters_.fetch_add(1, std::memory_order::memory_order_seq_cst);
+        // The push is retried after registering as a waiter, so that a cell freed before the registration isn't missed.
+        while(!try_push(session)){
+            struct pollfd pfd = {efd_, POLLIN, 0};
+            if(poll(&pfd, 1, -1) == -1){
+                switch(errno)
+                {
+                    case EINTR:
+                        continue;
+                    default:
+                        std::cerr << "session-queue.cpp:83:poll() failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            }
+            std::uint64_t notice = 0;
+            if(read(efd_, &notice, sizeof(notice)) == -1){
+                switch(errno)
+                {
+                    case EAGAIN:
+                    case EINTR:
+                        // Another producer took the free cell.
+                        break;
+                    default:
+                        std::cerr << "session-queue.cpp:95:read(efd_) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                        throw "what?";
+                }
+            }
+        }
+        waiters_.fetch_sub(1, std::memory_order::memory_order_relaxed);
+        full_waits_.fetch_add(1, std::memory_order::memory_order_relaxed);
+        full_wait_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order::memory_order_relaxed);
+        return;
+    }
+
+    bool SessionQueue::pull(std::shared_ptr<server::Session>& session)
+    {
+        std::size_t pos = tail_.load(std::memory_order::memory_order_relaxed);
+        Cell& cell = cells_[pos & mask_];
+        std::size_t sequence = cell.sequence.load(std::memory_order::memory_order_acquire);
+        if(static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1) < 0){
+            return false;
+        }
+        session = std::move(cell.session);
+        std::int64_t wait = std::chrono::steady_clock::now().time_since_epoch().count() - cell.pushed;
+        wait_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::duration(wait)).count(), std::memory_order::memory_order_relaxed);
+        pulled_.fetch_add(1, std::memory_order::memory_order_relaxed);
+        cell.sequence.store(pos + mask_ + 1, std::memory_order::memory_order_release);
+        tail_.store(pos + 1, std::memory_order::memory_order_seq_cst);
+        if(waiters_.load(std::memory_order::memory_order_seq_cst) > 0){
+            std::uint64_t notice = 1;
+            if(write(efd_, &notice, sizeof(notice)) == -1){
+                std::cerr << "session-queue.cpp:120:write(efd_) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+                throw "what?";
+            }
+        }
+        return true;
+    }
+
+    std::size_t SessionQueue::depth() const
+    {
+        std::size_t tail = tail_.load(std::memory_order::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order::memory_order_relaxed);
+        return (head > tail) ? head - tail : 0;
+    }
+
+    std::chrono::nanoseconds SessionQueue::mean_wait() const
+    {
+        std::size_t pulled = pulled_.load(std::memory_order::memory_order_relaxed);
+        if(pulled == 0){
+            return std::chrono::nanoseconds(0);
+        }
+        return std::chrono::nanoseconds(wait_ns_.load(std::memory_order::memory_order_relaxed) / static_cast<std::int64_t>(pulled));
+    }
+
+    SessionQueue::~SessionQueue()
+    {
+        if(efd_ != -1 && close(efd_) == -1){
+            std::cerr << "session-queue.cpp:146:close(efd_) failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
+        }
+    }
+}// namespace io
+}// namespace controller
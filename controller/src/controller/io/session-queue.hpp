@@ -0,0 +1,67 @@
+#ifndef SESSION_QUEUE_HPP
+#define SESSION_QUEUE_HPP
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/* Forward Declarations */
+namespace server{
+    class Session;
+}
+
+namespace controller{
+namespace io{
+    /* A bounded lock-free multi producer, single consumer ring of transport sessions. */
+    // Every cell carries a sequence number: a producer claims a cell by advancing the head when the sequence equals the
+    // head, and publishes it by storing head+1. The consumer takes the cell when its sequence is tail+1, and releases it
+    // to the next lap by storing tail+capacity. Cells are allocated once, so pushing a session only copies its pointer.
+    // Producers that find the ring full wait on a semaphore eventfd that the consumer posts to after freeing a cell.
+    class SessionQueue
+    {
+    public:
+        explicit SessionQueue(std::size_t capacity);
+        SessionQueue(const SessionQueue&) = delete;
+        SessionQueue& operator=(const SessionQueue&) = delete;
+        ~SessionQueue();
+
+        bool try_push(const std::shared_ptr<server::Session>& session);
+        // Blocks while the ring is full.
+        void push(const std::shared_ptr<server::Session>& session);
+        // Only the consumer thread may pull.
+        bool pull(std::shared_ptr<server::Session>& session);
+        bool empty() const { return depth() == 0; }
+        std::size_t depth() const;
+        std::size_t capacity() const { return mask_ + 1; }
+
+        // Queue statistics.
+        std::size_t max_depth() const { return max_depth_.load(std::memory_order::memory_order_relaxed); }
+        std::size_t pulled() const { return pulled_.load(std::memory_order::memory_order_relaxed); }
+        // The mean time that sessions waited in the ring before they were pulled.
+        std::chrono::nanoseconds mean_wait() const;
+        // The number of pushes that found the ring full, and the total time that they waited for a free cell.
+        std::size_t full_waits() const { return full_waits_.load(std::memory_order::memory_order_relaxed); }
+        std::chrono::nanoseconds full_wait_time() const { return std::chrono::nanoseconds(full_wait_ns_.load(std::memory_order::memory_order_relaxed)); }
+    private:
+        struct alignas(64) Cell
+        {
+            std::atomic<std::size_t> sequence;
+            std::shared_ptr<server::Session> session;
+            std::chrono::steady_clock::rep pushed;
+        };
+        std::unique_ptr<Cell[]> cells_;
+        std::size_t mask_;
+        alignas(64) std::atomic<std::size_t> head_;
+        alignas(64) std::atomic<std::size_t> tail_;
+        int efd_;
+        std::atomic<std::size_t> waiters_;
+
+        std::atomic<std::size_t> max_depth_;
+        std::atomic<std::size_t> pulled_;
+        std::atomic<std::int64_t> wait_ns_;
+        std::atomic<std::size_t> full_waits_;
+        std::atomic<std::int64_t> full_wait_ns_;
+    };
+}// namespace io
+}// namespace controller
+#endif
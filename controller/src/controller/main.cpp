@@ -61,8 +61,23 @@ int main(int argc, char* argv[])
     new_action.sa_flags=0;
     sigaction(SIGTERM, &new_action, NULL);
     
-    boost::asio::io_context ioc;
-    std::shared_ptr<controller::io::MessageBox> mbx = std::make_shared<controller::io::MessageBox>();
+    // The controller is split into __OW_SHARDS shards, that each run their own io_context.
+    std::size_t num_shards = 1;
+    const char* __OW_SHARDS = getenv("__OW_SHARDS");
+    if(__OW_SHARDS != nullptr){
+        std::string_view shards_str(__OW_SHARDS);
+        fcres = std::from_chars(shards_str.data(), shards_str.data()+shards_str.size(), num_shards, 10);
+        if(fcres.ec != std::errc() || num_shards == 0){
+            std::cerr << "main.cpp:71:__OW_SHARDS is not a positive integer, running one shard." << std::endl;
+            num_shards = 1;
+        }
+    }
+    std::vector<std::unique_ptr<boost::asio::io_context> > iocs;
+    std::vector<std::shared_ptr<controller::io::MessageBox> > mbxs;
+    for(std::size_t shard = 0; shard < num_shards; ++shard){
+        iocs.push_back(std::make_unique<boost::asio::io_context>());
+        mbxs.push_back(std::make_shared<controller::io::MessageBox>());
+    }
     sigset_t sigmask = {};
     int status = sigemptyset(&sigmask);
     if(status == -1){
@@ -84,12 +99,16 @@ int main(int argc, char* argv[])
         std::cerr << "controller-app.cpp:88:sigprocmask failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
         throw "what?";
     }
-    controller::app::Controller controller(
-        mbx,
-        ioc,
-        upath,
-        sport
-    );
+    std::vector<std::unique_ptr<controller::app::Controller> > controllers;
+    for(std::size_t shard = 0; shard < num_shards; ++shard){
+        controllers.push_back(std::make_unique<controller::app::Controller>(
+            mbxs[shard],
+            *iocs[shard],
+            upath,
+            sport,
+            shard
+        ));
+    }
     status = sigdelset(&sigmask, SIGCHLD);
      if(status == -1){
         std::cerr << "controller-app.cpp:88:sigprocmask failed:" << std::make_error_code(std::errc(errno)).message() << std::endl;
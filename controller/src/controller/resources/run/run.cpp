@@ -1,6 +1,7 @@
 #include "run.hpp"
 #include "../../app/action-relation.hpp"
 #include "../../app/execution-context.hpp"
+#include "../../app/context-registry.hpp"
 #include <csignal>
 #include <boost/asio.hpp>
 #include <poll.h>
@@ -57,16 +58,14 @@ namespace run{
         }
     }
 
-    std::shared_ptr<controller::app::ExecutionContext> handle(Request& req, std::vector<std::shared_ptr<controller::app::ExecutionContext> >& ctx_ptrs){
+    std::shared_ptr<controller::app::ExecutionContext> handle(Request& req, controller::app::ContextRegistry& ctx_ptrs){
         std::shared_ptr<controller::app::ExecutionContext> ctx_ptr;
         if(req.execution_context_id() != UUID::Uuid()){
-            auto it = std::find_if(ctx_ptrs.begin(), ctx_ptrs.end(), [&](auto ctx_ptr){
-                return (ctx_ptr->execution_context_id() == req.execution_context_id());
-            });
-            if( it != ctx_ptrs.end()){
-                (*it)->execution_context_idx_array().push_back(req.idx());
-                (*it)->push_execution_idx(req.idx());
-                return std::shared_ptr<controller::app::ExecutionContext>(*it);
+            std::shared_ptr<controller::app::ExecutionContext> existing = ctx_ptrs.find(req.execution_context_id());
+            if(existing){
+                existing->execution_context_idx_array().push_back(req.idx());
+                existing->push_execution_idx(req.idx());
+                return existing;
             }else{
                 ctx_ptr = std::make_shared<controller::app::ExecutionContext>(controller::app::ExecutionContext::run, req.execution_context_id(), req.idx(), req.peers(), req.env());
             }
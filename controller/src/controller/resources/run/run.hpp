@@ -17,6 +17,7 @@ namespace controller{
 namespace app{
     /*Forward Declarations*/
     class ExecutionContext;
+    class ContextRegistry;
 
 }// namespace app
 
@@ -37,7 +38,7 @@ namespace run{
         boost::json::object value_;
         std::map<std::string, std::string> env_;
     };
-    std::shared_ptr<controller::app::ExecutionContext> handle(Request& req, std::vector<std::shared_ptr<controller::app::ExecutionContext> >& ctx_ptrs);
+    std::shared_ptr<controller::app::ExecutionContext> handle(Request& req, controller::app::ContextRegistry& ctx_ptrs);
 }//namespace run
 }//namespace resources
 }//namespace controller
@@ -0,0 +1,71 @@
+#include "action-manifest-tests.hpp"
+#include "../../src/controller/app/action-relation.hpp"
+#include <algorithm>
+#include <random>
+
+namespace tests{
+    ActionManifestTests::ActionManifestTests(BenchNext, std::size_t num_relations)
+      : passed_{false},
+        calls_{0},
+        elapsed_{0}
+    {
+        using namespace controller::app;
+        std::mt19937 rng(42);
+        std::vector<std::shared_ptr<Relation> > relations;
+        relations.reserve(num_relations);
+        for(std::size_t i = 0; i < num_relations; ++i){
+            std::vector<std::shared_ptr<Relation> > dependencies;
+            for(int d = 0; d < 2 && i > 0; ++d){
+                auto& dependency = relations[rng() % i];
+                if(std::find(dependencies.begin(), dependencies.end(), dependency) == dependencies.end()){
+                    dependencies.push_back(dependency);
+                }
+            }
+            relations.push_back(std::make_shared<Relation>("fn_" + std::to_string(i), std::filesystem::path("fn.lua"), dependencies));
+        }
+        // Relations are compiled in the same (depth sorted) order as ActionManifest::build() leaves them.
+        std::sort(relations.begin(), relations.end(), [](const std::shared_ptr<Relation>& a, const std::shared_ptr<Relation>& b){
+            return a->depth() > b->depth();
+        });
+        ActionManifest manifest;
+        for(auto& relation: relations){
+            manifest.push_back(relation);
+        }
+        manifest.compile();
+        if(manifest.remaining_levels() != relations.front()->depth()){
+            // Every depth from 1 to the depth of the deepest relation is occupied.
+            return;
+        }
+        for(auto& relation: relations){
+            // Every dependency heads a longer chain of dependents than the relations that depend on it.
+            if(std::any_of(relation->begin(), relation->end(), [&](auto& dependency){ return manifest.height(dependency->position()) <= manifest.height(relation->position()); })){
+                return;
+            }
+        }
+
+        std::size_t pos = 0;
+        auto start = std::chrono::steady_clock::now();
+        while(true){
+            std::shared_ptr<Relation> relation = manifest.next(pos % num_relations, calls_++);
+            if(relation->key().empty()){
+                break;
+            }
+            if(relation->complete() || std::any_of(relation->begin(), relation->end(), [](auto& dependency){ return !dependency->complete(); })){
+                // next() must only return incomplete relations whose dependencies have completed.
+                return;
+            }
+            relation->acquire_value() = "{}";
+            relation->release_value();
+            pos = relation->position() + 1;
+        }
+        elapsed_ = std::chrono::steady_clock::now() - start;
+        if(calls_ != num_relations + 1){
+            return;
+        } else if(std::any_of(manifest.begin(), manifest.end(), [](auto& relation){ return !relation->complete(); })){
+            return;
+        } else if(manifest.remaining_levels() != 0){
+            return;
+        }
+        passed_ = true;
+    }
+}// namespace tests
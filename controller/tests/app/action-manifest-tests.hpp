@@ -0,0 +1,25 @@
+#ifndef ACTION_MANIFEST_TESTS_HPP
+#define ACTION_MANIFEST_TESTS_HPP
+#include "../../src/controller/app/action-manifest.hpp"
+#include <chrono>
+
+namespace tests{
+    class ActionManifestTests
+    {
+    public:
+        constexpr static struct BenchNext{} bench_next{};
+
+        // Runs the whole schedule of a synthetic manifest with num_relations relations, that each depend on up to two
+        // earlier relations. next() is called once per completion, starting after the relation that just completed.
+        explicit ActionManifestTests(BenchNext, std::size_t num_relations);
+
+        std::size_t calls() const { return calls_; }
+        std::chrono::nanoseconds elapsed() const { return elapsed_; }
+        operator bool(){ return passed_; }
+    private:
+        bool passed_;
+        std::size_t calls_;
+        std::chrono::nanoseconds elapsed_;
+    };
+}
+#endif
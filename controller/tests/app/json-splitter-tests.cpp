@@ -0,0 +1,119 @@
+#include "json-splitter-tests.hpp"
+
+namespace tests{
+    namespace {
+        std::string stream_of(const std::vector<std::string>& objects){
+            // Objects are separated the way a chunked /run body separates them.
+            std::string stream("[");
+            for(std::size_t i = 0; i < objects.size(); ++i){
+                if(i > 0){
+                    stream.append(", ");
+                }
+                stream.append(objects[i]);
+            }
+            stream.append("]\r\n");
+            return stream;
+        }
+
+        // Quotes a string value, escaping only quotes and backslashes.
+        std::string quoted(const std::string& value){
+            std::string literal("\"");
+            for(char c: value){
+                if(c == '"' || c == '\\'){
+                    literal.push_back('\\');
+                }
+                literal.push_back(c);
+            }
+            literal.push_back('"');
+            return literal;
+        }
+
+        std::vector<std::string> escaped_objects(){
+            // Every run of backslashes is quoted with an even length, followed by either an escaped quote or the
+            // closing quote of the string. The padding shifts each run across every offset of two 64 byte blocks.
+            std::vector<std::string> objects;
+            for(std::size_t pad = 0; pad < 128; ++pad){
+                for(std::size_t run = 1; run <= 4; ++run){
+                    std::string value = std::string(pad, 'x') + std::string(run, '\\');
+                    objects.push_back("{\"k\":" + quoted(value) + "}");
+                    objects.push_back("{\"k\":" + quoted(value + "\"}{[\"") + "}");
+                }
+            }
+            return objects;
+        }
+    }
+
+    std::vector<std::string> JsonSplitterTests::split(controller::app::JsonSplitter& splitter, const std::string& stream, std::size_t chunk_size)
+    {
+        std::vector<std::string> values;
+        for(std::size_t offset = 0; offset < stream.size(); offset += chunk_size){
+            splitter.feed(std::string_view(stream).substr(offset, chunk_size));
+            for(std::string_view value = splitter.next(); !value.empty(); value = splitter.next()){
+                values.emplace_back(value);
+            }
+        }
+        return values;
+    }
+
+    JsonSplitterTests::JsonSplitterTests(TestBraces)
+      : passed_{false}
+    {
+        std::vector<std::string> objects = {
+            "{\"a\":\"}\"}",
+            "{\"b\":\"{\",\"c\":\"{{\"}",
+            "{\"d\":\"]\",\"e\":\"[\"}",
+            "{\"f\":{\"g\":\"}}{\"},\"h\":[\"]\",[{}]]}"
+        };
+        controller::app::JsonSplitter splitter;
+        std::string stream = stream_of(objects);
+        std::vector<std::string> values = split(splitter, stream, stream.size());
+        objects.push_back("]");
+        if(values != objects || splitter.pending()){
+            return;
+        }
+        passed_ = true;
+    }
+
+    JsonSplitterTests::JsonSplitterTests(TestEscapes)
+      : passed_{false}
+    {
+        std::vector<std::string> objects = escaped_objects();
+        controller::app::JsonSplitter splitter;
+        std::string stream = stream_of(objects);
+        std::vector<std::string> values = split(splitter, stream, stream.size());
+        objects.push_back("]");
+        if(values != objects || splitter.pending()){
+            return;
+        }
+        passed_ = true;
+    }
+
+    JsonSplitterTests::JsonSplitterTests(TestChunks, std::size_t chunk_size)
+      : passed_{false}
+    {
+        std::vector<std::string> objects = escaped_objects();
+        objects.push_back("{\"f\":{\"g\":\"}}{\"},\"h\":[\"]\",[{}]]}");
+        controller::app::JsonSplitter splitter;
+        std::vector<std::string> values = split(splitter, stream_of(objects), chunk_size);
+        objects.push_back("]");
+        if(values != objects || splitter.pending()){
+            return;
+        }
+        passed_ = true;
+    }
+
+    JsonSplitterTests::JsonSplitterTests(TestClose)
+      : passed_{false}
+    {
+        controller::app::JsonSplitter splitter;
+        std::string stream("[{\"a\":[1,[2]]},{\"b\":\"]\"}]\r\n");
+        splitter.feed(stream);
+        if(splitter.next() != "{\"a\":[1,[2]]}" || splitter.next() != "{\"b\":\"]\"}"){
+            return;
+        }
+        if(splitter.next() != "]" || !splitter.next().empty() || splitter.pending()){
+            return;
+        }
+        passed_ = true;
+    }
+}// namespace tests
@@ -0,0 +1,38 @@
+#ifndef JSON_SPLITTER_TESTS_HPP
+#define JSON_SPLITTER_TESTS_HPP
+#include "../../src/controller/app/json-splitter.hpp"
+#include <string>
+#include <vector>
+
+namespace tests{
+    class JsonSplitterTests
+    {
+    public:
+        constexpr static struct TestBraces{} test_braces{};
+
+        // Braces and brackets inside string values, and arrays nested in objects, don't end an object or the array.
+        explicit JsonSplitterTests(TestBraces);
+
+        constexpr static struct TestEscapes{} test_escapes{};
+
+        // Escaped quotes and runs of backslashes, that are shifted across every offset of two 64 byte blocks.
+        explicit JsonSplitterTests(TestEscapes);
+
+        constexpr static struct TestChunks{} test_chunks{};
+
+        // The same stream, fed chunk_size bytes at a time, so that objects are split across calls to feed().
+        explicit JsonSplitterTests(TestChunks, std::size_t chunk_size);
+
+        constexpr static struct TestClose{} test_close{};
+
+        // The closing bracket of the array is returned once, after the last object, and nothing is returned after it.
+        explicit JsonSplitterTests(TestClose);
+
+        operator bool(){ return passed_; }
+    private:
+        // Splits the stream chunk_size bytes at a time, and collects every view that next() returns.
+        static std::vector<std::string> split(controller::app::JsonSplitter& splitter, const std::string& stream, std::size_t chunk_size);
+        bool passed_;
+    };
+}
+#endif
@@ -0,0 +1,90 @@
+#include "thread-controls-tests.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+namespace tests{
+    ThreadControlsTests::ThreadControlsTests(BenchSchedContention, std::size_t num_threads, std::size_t num_checks, std::size_t yield_every)
+      : passed_{false},
+        elapsed_{0}
+    {
+        using controller::app::ThreadControls;
+        std::atomic<bool> done{false};
+        std::atomic<std::size_t> completed{0};
+        std::thread waker([&](){
+            while(!done.load(std::memory_order::memory_order_relaxed)){
+                ThreadControls::thread_sched_yield(false);
+            }
+        });
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> initializers;
+        for(std::size_t i = 0; i < num_threads; ++i){
+            initializers.emplace_back([&](){
+                auto handle = ThreadControls::thread_sched_push();
+                ThreadControls::set_start_time();
+                std::chrono::nanoseconds slices{0};
+                for(std::size_t check = 1; check <= num_checks; ++check){
+                    // The time slice check that initializers make after every relation.
+                    slices += (std::chrono::steady_clock::now() - ThreadControls::get_start_time(handle)) - ThreadControls::thread_sched_time_slice();
+                    if(check % yield_every == 0){
+                        ThreadControls::thread_sched_yield(false, handle);
+                    }
+                }
+                ThreadControls::thread_sched_yield(true, handle);
+                if(slices.count() != 0){
+                    completed.fetch_add(1, std::memory_order::memory_order_relaxed);
+                }
+            });
+        }
+        for(auto& initializer: initializers){
+            initializer.join();
+        }
+        elapsed_ = std::chrono::steady_clock::now() - start;
+        done.store(true, std::memory_order::memory_order_relaxed);
+        waker.join();
+        if(completed.load(std::memory_order::memory_order_relaxed) != num_threads){
+            return;
+        } else if(ThreadControls::sched_size_.load(std::memory_order::memory_order_relaxed) != 0){
+            return;
+        }
+        passed_ = true;
+    }
+
+    ThreadControlsTests::ThreadControlsTests(BenchSpawn, std::size_t heap_mb, std::size_t num_spawns)
+      : passed_{false},
+        elapsed_{0}
+    {
+        using namespace controller::app;
+        if(setenv("__OW_ACTION_BIN", "/bin/true", 1) == -1 || setenv("__OW_ACTION_LAUNCHER", "launcher", 1) == -1){
+            return;
+        }
+        // The pages are written so that fork() has to copy their page table entries.
+        std::vector<char> heap(heap_mb << 20);
+        std::fill(heap.begin(), heap.end(), 1);
+        auto relation = std::make_shared<Relation>("main", std::filesystem::path("fn.lua"), std::vector<std::shared_ptr<Relation> >());
+        for(std::size_t i = 0; i < num_spawns; ++i){
+            ThreadControls thread_control;
+            thread_control.relation = relation;
+            auto start = std::chrono::steady_clock::now();
+            bool spawned = thread_control.thread_continue();
+            elapsed_ += std::chrono::steady_clock::now() - start;
+            if(!spawned){
+                return;
+            }
+            close(thread_control.params_fd());
+            close(thread_control.result_fd());
+            int status = 0;
+            if(waitpid(thread_control.pid(), &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+                return;
+            }
+        }
+        if(heap_mb > 0 && heap.back() != 1){
+            return;
+        }
+        passed_ = true;
+    }
+}// namespace tests
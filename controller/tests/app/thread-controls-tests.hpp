@@ -0,0 +1,29 @@
+#ifndef THREAD_CONTROLS_TESTS_HPP
+#define THREAD_CONTROLS_TESTS_HPP
+#include "../../src/controller/app/thread-controls.hpp"
+#include <chrono>
+
+namespace tests{
+    class ThreadControlsTests
+    {
+    public:
+        constexpr static struct BenchSchedContention{} bench_sched_contention{};
+
+        // num_threads initializer threads each make num_checks time slice checks, and yield every yield_every checks.
+        // A waker thread stands in for the executors, that yield to the initializers when they are notified.
+        explicit ThreadControlsTests(BenchSchedContention, std::size_t num_threads, std::size_t num_checks, std::size_t yield_every);
+
+        constexpr static struct BenchSpawn{} bench_spawn{};
+
+        // Spawns num_spawns executors with the backend selected by __OW_SPAWN_BACKEND, while heap_mb MiB of resident
+        // heap stand in for a busy controller. /bin/true stands in for the launcher, so only the spawn is measured.
+        explicit ThreadControlsTests(BenchSpawn, std::size_t heap_mb, std::size_t num_spawns);
+
+        std::chrono::nanoseconds elapsed() const { return elapsed_; }
+        operator bool(){ return passed_; }
+    private:
+        bool passed_;
+        std::chrono::nanoseconds elapsed_;
+    };
+}
+#endif
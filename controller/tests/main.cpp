@@ -0,0 +1,83 @@
+#include "app/thread-controls-tests.hpp"
+#include "app/action-manifest-tests.hpp"
+#include "app/json-splitter-tests.hpp"
+#include <iostream>
+#include <cstdlib>
+
+int main(int argc, char* argv[]){
+    {
+        // Scheduler contention benchmarks.
+        using namespace tests;
+        std::size_t test_num = 1;
+        for(std::size_t num_threads: {1, 4, 16}){
+            ThreadControlsTests bench_sched_contention(ThreadControlsTests::bench_sched_contention, num_threads, 1000000, 4096);
+            if(bench_sched_contention){
+                std::cout << "Thread controls benchmark " << test_num << " passed:threads=" << num_threads << ":yield every 4096 checks:" << std::chrono::duration_cast<std::chrono::milliseconds>(bench_sched_contention.elapsed()).count() << "ms" << std::endl;
+            } else {
+                std::cerr << "Thread controls benchmark " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+        {
+            ThreadControlsTests bench_sched_contention(ThreadControlsTests::bench_sched_contention, 16, 100000, 4);
+            if(bench_sched_contention){
+                std::cout << "Thread controls benchmark " << test_num << " passed:threads=16:yield every 4 checks:" << std::chrono::duration_cast<std::chrono::milliseconds>(bench_sched_contention.elapsed()).count() << "ms" << std::endl;
+            } else {
+                std::cerr << "Thread controls benchmark " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+        {
+            // Compare the spawn backends by running the tests once for each __OW_SPAWN_BACKEND.
+            const char* backend = getenv("__OW_SPAWN_BACKEND");
+            ThreadControlsTests bench_spawn(ThreadControlsTests::bench_spawn, 512, 200);
+            if(bench_spawn){
+                std::cout << "Thread controls benchmark " << test_num << " passed:backend=" << ((backend == nullptr) ? "fork" : backend) << ":heap=512MiB:" << std::chrono::duration_cast<std::chrono::microseconds>(bench_spawn.elapsed()).count()/200 << "us/spawn" << std::endl;
+            } else {
+                std::cerr << "Thread controls benchmark " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    {
+        // ActionManifest::next() benchmarks.
+        using namespace tests;
+        std::size_t test_num = 1;
+        for(std::size_t num_relations: {10, 100, 1000, 10000}){
+            ActionManifestTests bench_next(ActionManifestTests::bench_next, num_relations);
+            if(bench_next){
+                std::cout << "Action manifest benchmark " << test_num << " passed:relations=" << num_relations << ":" << std::chrono::duration<double, std::micro>(bench_next.elapsed()).count()/bench_next.calls() << "us/call" << std::endl;
+            } else {
+                std::cerr << "Action manifest benchmark " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    {
+        // JsonSplitter regression tests.
+        using namespace tests;
+        std::size_t test_num = 1;
+        for(auto passed: {
+            bool(JsonSplitterTests(JsonSplitterTests::test_braces)),
+            bool(JsonSplitterTests(JsonSplitterTests::test_escapes)),
+            bool(JsonSplitterTests(JsonSplitterTests::test_close))
+        }){
+            if(passed){
+                std::cout << "JSON splitter test " << test_num << " passed." << std::endl;
+            } else {
+                std::cerr << "JSON splitter test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+        for(std::size_t chunk_size: {1, 7, 63, 64, 65, 4096}){
+            JsonSplitterTests test_chunks(JsonSplitterTests::test_chunks, chunk_size);
+            if(test_chunks){
+                std::cout << "JSON splitter test " << test_num << " passed:chunk size=" << chunk_size << std::endl;
+            } else {
+                std::cerr << "JSON splitter test " << test_num << " failed." << std::endl;
+            }
+            ++test_num;
+        }
+    }
+    return 0;
+}